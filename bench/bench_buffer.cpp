@@ -0,0 +1,91 @@
+// Buffer：追加、从 fd 读入，以及 makeSpace 的两条路径（前移已读空间 / 扩容）
+
+#include "buffer/buffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// 典型的响应头和小响应体，来回追加再取走，容量稳定后不再触发 makeSpace
+void BM_BufferAppend(benchmark::State &state) {
+    const std::string chunk(static_cast<size_t>(state.range(0)), 'x');
+    zener::Buffer buff;
+    for (auto _ : state) {
+        buff.Append(chunk);
+        benchmark::DoNotOptimize(buff.Peek());
+        buff.RetrieveAll();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(BM_BufferAppend)->Arg(64)->Arg(512)->Arg(4096)->Arg(64 << 10);
+
+// 前面留着已读空间、后面可写空间不够：makeSpace 把未读数据前移而不扩容
+void BM_BufferCompact(benchmark::State &state) {
+    const std::string chunk(768, 'x');
+    zener::Buffer buff(1024);
+    for (auto _ : state) {
+        buff.Append(chunk);
+        buff.Retrieve(chunk.size() - 16); // 留一点未读数据，前移时需要拷贝
+        buff.Append(chunk);
+        benchmark::DoNotOptimize(buff.Peek());
+        buff.RetrieveAll();
+    }
+}
+BENCHMARK(BM_BufferCompact);
+
+// 从空缓冲区开始追加到 range(0) 字节：makeSpace 反复扩容
+void BM_BufferGrow(benchmark::State &state) {
+    const std::string chunk(1024, 'x');
+    const auto total = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        zener::Buffer buff;
+        for (size_t n = 0; n < total; n += chunk.size()) {
+            buff.Append(chunk);
+        }
+        benchmark::DoNotOptimize(buff.Peek());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(BM_BufferGrow)->Arg(16 << 10)->Arg(1 << 20);
+
+// 每次往管道里写 range(0) 字节，再像 Conn::Read 一样循环 ReadFd 直到读完：
+// 单次只读可写空间加栈上 4KB，大包会分多次读并触发扩容
+void BM_BufferReadFd(benchmark::State &state) {
+    int fds[2];
+    if (pipe(fds) < 0) {
+        state.SkipWithError("pipe failed");
+        return;
+    }
+    const std::string payload(static_cast<size_t>(state.range(0)), 'x');
+    zener::Buffer buff;
+    int err = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if (write(fds[1], payload.data(), payload.size()) !=
+            static_cast<ssize_t>(payload.size())) {
+            state.SkipWithError("write failed");
+            break;
+        }
+        state.ResumeTiming();
+        while (buff.ReadableBytes() < payload.size()) {
+            if (buff.ReadFd(fds[0], &err) <= 0) {
+                state.SkipWithError("read failed");
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(buff.Peek());
+        buff.RetrieveAll();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+    close(fds[0]);
+    close(fds[1]);
+}
+BENCHMARK(BM_BufferReadFd)->Arg(512)->Arg(8 << 10)->Arg(60 << 10);
+
+} // namespace
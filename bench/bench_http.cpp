@@ -0,0 +1,177 @@
+// HTTP 热路径：请求解析与分帧、路由分发、响应头生成、静态文件映射缓存
+
+#include "buffer/buffer.h"
+#include "http/context.h"
+#include "http/file_cache.h"
+#include "http/request.h"
+#include "http/response.h"
+#include "http/router.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// 浏览器发出的典型 GET：十来个首部，约 600 字节
+const std::string BROWSER_GET =
+    "GET /static/js/app.3f9a1c.js?v=20240601 HTTP/1.1\r\n"
+    "Host: zener.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, "
+    "like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Accept: */*\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Referer: https://zener.example.com/index.html\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9,zh-CN;q=0.8\r\n"
+    "Cookie: session=7f3c2a9b1e; theme=dark\r\n"
+    "\r\n";
+
+// 压测工具和 API 客户端发出的最小 GET
+const std::string MINIMAL_GET =
+    "GET / HTTP/1.1\r\nHost: 127.0.0.1:1316\r\nConnection: keep-alive\r\n\r\n";
+
+// 带 urlencoded 正文的表单提交
+const std::string FORM_POST =
+    "POST /api/items HTTP/1.1\r\n"
+    "Host: zener.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Content-Length: 52\r\n"
+    "Origin: https://zener.example.com\r\n"
+    "\r\n"
+    "name=zener+server&count=42&tags=http%2Cepoll&note=ok";
+
+void BM_RequestParse(benchmark::State &state, const std::string &raw) {
+    zener::Buffer buff;
+    zener::http::Request request;
+    for (auto _ : state) {
+        buff.Append(raw);
+        request.Init();
+        if (!request.parse(buff)) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+        benchmark::DoNotOptimize(request.Path());
+        buff.RetrieveAll();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(raw.size()));
+}
+BENCHMARK_CAPTURE(BM_RequestParse, browser_get, BROWSER_GET);
+BENCHMARK_CAPTURE(BM_RequestParse, minimal_get, MINIMAL_GET);
+BENCHMARK_CAPTURE(BM_RequestParse, form_post, FORM_POST);
+
+// 每次收到数据都要做的分帧检查（不消费数据）
+void BM_RequestFrame(benchmark::State &state, const std::string &raw) {
+    size_t bodyBytes = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            zener::http::Request::Frame(raw.data(), raw.size(), bodyBytes));
+    }
+}
+BENCHMARK_CAPTURE(BM_RequestFrame, browser_get, BROWSER_GET);
+BENCHMARK_CAPTURE(BM_RequestFrame, form_post, FORM_POST);
+
+// range(0) 条精确路由和一个静态目录挂载；命中、未命中和静态文件三种情形
+void BM_RouterDispatch(benchmark::State &state, const char *target) {
+    zener::http::Router router;
+    const int routes = static_cast<int>(state.range(0));
+    for (int i = 0; i < routes; ++i) {
+        router.Add("GET", "/api/v1/resource" + std::to_string(i),
+                   [](zener::http::Context &ctx) {
+                       benchmark::DoNotOptimize(&ctx);
+                   });
+    }
+    router.Static("/static", "./static");
+    zener::Buffer buff;
+    buff.Append(std::string("GET ") + target + " HTTP/1.1\r\nHost: x\r\n\r\n");
+    zener::http::Request request;
+    request.Init();
+    if (!request.parse(buff)) {
+        state.SkipWithError("parse failed");
+        return;
+    }
+    zener::http::Response response;
+    zener::Buffer out;
+    zener::http::Context ctx(request, response, out);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(router.Dispatch(ctx));
+    }
+}
+BENCHMARK_CAPTURE(BM_RouterDispatch, hit, "/api/v1/resource7")
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_RouterDispatch, miss, "/no/such/route")
+    ->Arg(10)->Arg(1000);
+BENCHMARK_CAPTURE(BM_RouterDispatch, static_file, "/static/app.js")->Arg(100);
+
+// 测试用的静态文件目录，进程退出时删除
+class StaticDir {
+  public:
+    StaticDir() {
+        char tmpl[] = "/tmp/zener_bench_XXXXXX";
+        if (mkdtemp(tmpl) != nullptr) {
+            _dir = tmpl;
+            std::ofstream(_dir + "/index.html") << std::string(3148, 'a');
+        }
+    }
+    ~StaticDir() {
+        if (!_dir.empty()) {
+            unlink((_dir + "/index.html").c_str());
+            rmdir(_dir.c_str());
+        }
+    }
+    [[nodiscard]] const std::string &Path() const { return _dir; }
+    [[nodiscard]] std::string File() const { return _dir + "/index.html"; }
+
+  private:
+    std::string _dir;
+};
+
+const StaticDir &staticDir() {
+    static StaticDir dir;
+    return dir;
+}
+
+// 状态行、首部和静态文件映射（映射缓存命中）
+void BM_ResponseMakeResponse(benchmark::State &state) {
+    zener::http::Response response;
+    zener::Buffer buff;
+    for (auto _ : state) {
+        response.Init(staticDir().Path(), "/index.html", true, 200);
+        response.MakeResponse(buff);
+        benchmark::DoNotOptimize(response.File());
+        buff.RetrieveAll();
+    }
+    response.UnmapFile();
+}
+BENCHMARK(BM_ResponseMakeResponse);
+
+// 多线程同时取、放同一个文件的映射：共享锁和引用计数上的竞争
+void BM_FileCacheGetMapping(benchmark::State &state) {
+    const std::string path = staticDir().File();
+    struct stat st{};
+    if (stat(path.c_str(), &st) < 0) {
+        state.SkipWithError("stat failed");
+        return;
+    }
+    auto &cache = zener::http::FileCache::GetInstance();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.GetFileMapping(path, st));
+        cache.ReleaseFileMapping(path);
+    }
+}
+BENCHMARK(BM_FileCacheGetMapping)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
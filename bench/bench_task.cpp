@@ -0,0 +1,120 @@
+// 计时器（小顶堆与红黑树两种实现）的调度/取消/到期，线程池的投递吞吐
+
+#include "task/threadpool_1.h"
+#include "task/timer/heaptimer.h"
+#include "task/timer/maptimer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// 每个连接一个以 fd 为键的超时计时器，每次事件都重新计时（ScheduleWithKey
+// 先取消旧的）；range(0) 为同时存在的计时器数
+template <typename Manager>
+void BM_TimerReschedule(benchmark::State &state) {
+    auto &timers = Manager::GetInstance();
+    const int keys = static_cast<int>(state.range(0));
+    for (int key = 0; key < keys; ++key) {
+        timers.ScheduleWithKey(key, 60000, 0, [] {});
+    }
+    int key = 0;
+    for (auto _ : state) {
+        timers.ScheduleWithKey(key, 60000, 0, [] {});
+        key = key + 1 == keys ? 0 : key + 1;
+    }
+    for (int k = 0; k < keys; ++k) {
+        timers.CancelByKey(k);
+    }
+}
+BENCHMARK_TEMPLATE(BM_TimerReschedule, zener::v0::TimerManager)
+    ->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_TimerReschedule, zener::rbtimer::TimerManager)
+    ->Arg(1000)->Arg(100000);
+
+// 连接关闭时取消计时器
+template <typename Manager>
+void BM_TimerCancel(benchmark::State &state) {
+    auto &timers = Manager::GetInstance();
+    int key = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        timers.ScheduleWithKey(key, 60000, 0, [] {});
+        state.ResumeTiming();
+        timers.CancelByKey(key);
+        ++key;
+    }
+}
+BENCHMARK_TEMPLATE(BM_TimerCancel, zener::v0::TimerManager);
+BENCHMARK_TEMPLATE(BM_TimerCancel, zener::rbtimer::TimerManager);
+
+// range(0) 个计时器同时到期，反复 Update 直到回调全部执行。红黑树实现单次
+// Update 最多处理 100 个，且带 key 的 repeat=0 计时器不会触发，这里用 repeat=1
+template <typename Manager>
+void BM_TimerExpire(benchmark::State &state) {
+    auto &timers = Manager::GetInstance();
+    const int batch = static_cast<int>(state.range(0));
+    int fired = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int key = 0; key < batch; ++key) {
+            timers.ScheduleWithKey(key, 1, 1, [&fired] { ++fired; });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        fired = 0;
+        state.ResumeTiming();
+        while (fired < batch) {
+            timers.Update();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch);
+}
+BENCHMARK_TEMPLATE(BM_TimerExpire, zener::v0::TimerManager)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_TimerExpire, zener::rbtimer::TimerManager)->Arg(1000);
+
+// 外部线程（如 reactor）向 range(0) 个工作线程投递一批空任务，直到全部执行完
+void BM_ThreadPoolAddTask(benchmark::State &state) {
+    constexpr int BATCH = 10000;
+    zener::v0::ThreadPool pool(static_cast<size_t>(state.range(0)),
+                               zener::v0::ThreadPoolLanes{.blockingThreads = 0});
+    std::atomic<int> done{0};
+    for (auto _ : state) {
+        done.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < BATCH; ++i) {
+            pool.AddTask(
+                [&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (done.load(std::memory_order_acquire) < BATCH) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * BATCH);
+}
+BENCHMARK(BM_ThreadPoolAddTask)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+// 工作线程里派生子任务（进本地双端队列，可被其他线程窃取）
+void BM_ThreadPoolAddTaskFromWorker(benchmark::State &state) {
+    constexpr int BATCH = 10000;
+    zener::v0::ThreadPool pool(static_cast<size_t>(state.range(0)),
+                               zener::v0::ThreadPoolLanes{.blockingThreads = 0});
+    std::atomic<int> done{0};
+    for (auto _ : state) {
+        done.store(0, std::memory_order_relaxed);
+        pool.AddTask([&pool, &done] {
+            for (int i = 0; i < BATCH; ++i) {
+                pool.AddTask(
+                    [&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+        while (done.load(std::memory_order_acquire) < BATCH) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * BATCH);
+}
+BENCHMARK(BM_ThreadPoolAddTaskFromWorker)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,17 @@
+// 微基准入口：关掉日志，避免 LOG_* 的格式化和 I/O 混进测量结果
+// 用法见 docs/压力测试.md
+
+#include "utils/log/logger.h"
+
+#include <benchmark/benchmark.h>
+
+int main(int argc, char **argv) {
+    zener::Logger::SetLevel(spdlog::level::off);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
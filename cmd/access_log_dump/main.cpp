@@ -0,0 +1,129 @@
+// 把二进制访问日志转换为文本或 JSON Lines
+// 用法: access_log_dump [--json] <access_xxx.bin>...
+
+#include "utils/log/access_log_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+void printJsonString(const std::string_view str) {
+    std::putchar('"');
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            std::fputs("\\\"", stdout);
+            break;
+        case '\\':
+            std::fputs("\\\\", stdout);
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::printf("\\u%04x", c);
+            } else {
+                std::putchar(c);
+            }
+        }
+    }
+    std::putchar('"');
+}
+
+void printRecord(const zener::AccessRecord &record, const std::string_view path,
+                 const bool json) {
+    const auto method = zener::AccessMethodName(record.method);
+    if (json) {
+        std::printf("{\"time_ns\":%lld,\"conn\":%llu,\"method\":\"%.*s\","
+                    "\"path\":",
+                    static_cast<long long>(record.timeNs),
+                    static_cast<unsigned long long>(record.connId),
+                    static_cast<int>(method.size()), method.data());
+        printJsonString(path);
+        std::printf(",\"status\":%u,\"bytes\":%u,\"latency_us\":%u}\n",
+                    record.status, record.bytes, record.latencyUs);
+        return;
+    }
+    const std::time_t sec = record.timeNs / 1000000000;
+    const auto us = (record.timeNs % 1000000000) / 1000;
+    char time[32];
+    std::strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S",
+                  std::localtime(&sec));
+    std::printf("%s.%06lld conn=%llu %.*s %.*s %u %uB %uus\n", time,
+                static_cast<long long>(us),
+                static_cast<unsigned long long>(record.connId),
+                static_cast<int>(method.size()), method.data(),
+                static_cast<int>(path.size()), path.data(), record.status,
+                record.bytes, record.latencyUs);
+}
+
+bool dump(const char *fileName, const bool json) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << fileName << std::endl;
+        return false;
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+    zener::AccessLogFileHeader header{};
+    if (data.size() < sizeof(header)) {
+        std::cerr << fileName << ": file too short" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, zener::ACCESS_LOG_MAGIC,
+                    sizeof(header.magic)) != 0 ||
+        header.version != zener::ACCESS_LOG_VERSION ||
+        header.recordSize < sizeof(zener::AccessRecord)) {
+        std::cerr << fileName << ": not an access log (or unsupported version)"
+                  << std::endl;
+        return false;
+    }
+    size_t pos = sizeof(header);
+    while (pos + header.recordSize <= data.size()) {
+        zener::AccessRecord record{};
+        std::memcpy(&record, data.data() + pos, sizeof(record));
+        pos += header.recordSize;
+        if (pos + record.pathLen > data.size()) {
+            break;
+        }
+        printRecord(record, std::string_view(data.data() + pos, record.pathLen),
+                    json);
+        pos += record.pathLen;
+    }
+    if (pos != data.size()) {
+        std::cerr << fileName << ": truncated record at offset " << pos
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(const int argc, char *argv[]) {
+    bool json = false;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--json] <access_log.bin>..."
+                  << std::endl;
+        return 1;
+    }
+    bool ok = true;
+    for (const char *file : files) {
+        ok &= dump(file, json);
+    }
+    return ok ? 0 : 1;
+}
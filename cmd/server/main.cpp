@@ -1,5 +1,17 @@
 #include "core/server.h"
+#include "http/async.h"
 #include "http/request.h"
+#include "http/response_stream.h"
+#include "http/websocket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 int main() {
     zener::Logger::Init();
@@ -15,7 +27,7 @@ int main() {
         } else {
             ctx.Redirect("/error.html");
         }
-    });
+    }, /*blocking=*/true);
 
     // Register: POST /register.html  { username, password }
     server->POST("/register.html", [](zener::http::Context& ctx) {
@@ -26,6 +38,116 @@ int main() {
         } else {
             ctx.Redirect("/error.html");
         }
+    }, /*blocking=*/true);
+
+    // Status as plain JSON for pollers; the response is cached for a second,
+    // so a burst of identical polls runs the handler once.
+    server->GET("/status", [](zener::http::Context& ctx) {
+        ctx.Json("{\"connections\":" +
+                 std::to_string(zener::http::Conn::userCount.load()) +
+                 ",\"websockets\":" +
+                 std::to_string(zener::http::ws::Hub::sessionCount.load()) + "}");
+    });
+    server->Cache("GET", "/status",
+                  {.ttlMs = 1000, .vary = {}, .maxEntryBytes = 256 * 1024});
+
+    // Dashboard: browsers subscribe to /ws/status instead of polling /status;
+    // one frame per second is encoded once and shared by every subscriber.
+    server->WebSocket("/ws/status", {
+        .onOpen = [](zener::http::ws::Session& ws) { ws.Subscribe("status"); },
+        .onMessage = [](zener::http::ws::Session& ws, std::string_view msg,
+                        bool binary) { ws.Send(msg, binary); }, // echo
+        .onClose = nullptr,
+    });
+
+    // The same feed as Server-Sent Events for clients without WebSocket.
+    std::mutex feedMutex;
+    std::vector<std::shared_ptr<zener::http::ResponseStream>> feeds;
+    server->GET("/events", [&](zener::http::Context& ctx) {
+        auto stream = ctx.SSE();
+        stream->Comment("status feed");
+        std::lock_guard lk(feedMutex);
+        feeds.push_back(std::move(stream));
+    });
+
+    // A large CSV generated batch by batch: the next batch is produced only
+    // after the previous one is in the socket, so memory stays flat.
+    server->GET("/report.csv", [](zener::http::Context& ctx) {
+        auto stream = ctx.Stream("text/csv");
+        stream->Write("id,square\n");
+        stream->OnWritable([row = 0](zener::http::ResponseStream& s) mutable {
+            constexpr int rows = 1000000;
+            std::string batch;
+            for (const int end = std::min(row + 4096, rows); row < end; ++row) {
+                batch += std::to_string(row) + ',' +
+                         std::to_string(static_cast<long long>(row) * row) + '\n';
+            }
+            s.Write(batch);
+            if (row == rows) {
+                s.End();
+            }
+        });
+    });
+
+    // Coroutine handlers: every co_await hands the worker back to the pool.
+    server->Async("GET", "/async/sleep",
+                  [](zener::http::Context& ctx) -> zener::Task<void> {
+        co_await zener::http::Sleep(200);
+        ctx.Json("{\"slept_ms\":200}");
+    });
+    server->Async("GET", "/async/users",
+                  [](zener::http::Context& ctx) -> zener::Task<void> {
+        const auto result =
+            co_await zener::http::Query("SELECT username FROM user LIMIT 10");
+        if (!result.ok) {
+            ctx.Status(503).Json("{\"error\":\"database unavailable\"}");
+            co_return;
+        }
+        std::string json = "[";
+        for (const auto& row : result.rows) {
+            json += (json.size() > 1 ? ",\"" : "\"") + row[0] + '"';
+        }
+        ctx.Json(json + "]");
+    });
+    // The CSV report again, written as a loop: each batch waits until the
+    // previous one is in the socket.
+    server->Async("GET", "/async/report.csv",
+                  [](zener::http::Context& ctx) -> zener::Task<void> {
+        auto stream = ctx.Stream("text/csv");
+        stream->Write("id,square\n");
+        constexpr int rows = 1000000;
+        for (int row = 0; row < rows;) {
+            std::string batch;
+            for (const int end = std::min(row + 4096, rows); row < end; ++row) {
+                batch += std::to_string(row) + ',' +
+                         std::to_string(static_cast<long long>(row) * row) + '\n';
+            }
+            stream->Write(batch);
+            if (!co_await zener::http::Drained(*stream)) {
+                co_return; // client went away
+            }
+        }
+        stream->End();
+    });
+
+    std::atomic<bool> stopTicker{false};
+    std::thread ticker([&] {
+        auto& hub = zener::http::ws::Hub::GetInstance();
+        while (!stopTicker.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            const std::string status =
+                "{\"connections\":" +
+                std::to_string(zener::http::Conn::userCount.load()) +
+                ",\"websockets\":" +
+                std::to_string(zener::http::ws::Hub::sessionCount.load()) + "}";
+            if (hub.Subscribers("status") > 0) {
+                hub.Broadcast("status", status);
+            }
+            std::lock_guard lk(feedMutex);
+            std::erase_if(feeds, [&status](const auto& feed) {
+                return !feed->Event(status, "status") && feed->Closed();
+            });
+        }
     });
 
     try {
@@ -33,6 +155,8 @@ int main() {
     } catch (const std::exception &) {
         //
     }
+    stopTicker.store(true, std::memory_order_relaxed);
+    ticker.join();
 
     return 0;
 }
@@ -0,0 +1,820 @@
+// HTTP/1.1 压测工具：每个线程一个 epoll 循环驱动若干条非阻塞连接
+// - 闭环（默认）：每条连接保持 --pipeline 个请求在途，收到一个响应就补发一个
+// - 开环（--rate）：按固定总速率排定每个请求的发出时间，延迟从排定时间算起，
+//   服务器变慢时排队的时间也计入延迟，不会因协调遗漏（coordinated omission）而偏乐观
+// 延迟记在对数线性直方图里（相对误差 < 1%），结果输出为文本或 JSON
+// 用法见 usage()
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <string_view>
+#include <strings.h> // strncasecmp
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 对数线性直方图（HdrHistogram 的简化版）：小于 128 的值精确记录，
+// 之后每个 2 的幂区间分成 64 份，单位为纳秒
+class Histogram {
+  public:
+    static constexpr int SUB_BITS = 7;
+    static constexpr uint64_t SUB = 1ULL << SUB_BITS;
+    static constexpr uint64_t HALF = SUB / 2;
+    static constexpr size_t BUCKETS = SUB + (64 - SUB_BITS) * HALF;
+
+    Histogram() : _counts(BUCKETS, 0) {}
+
+    void Record(const int64_t value) {
+        const auto v = static_cast<uint64_t>(std::max<int64_t>(value, 0));
+        ++_counts[indexOf(v)];
+        ++_total;
+        _sum += static_cast<double>(v);
+        _min = std::min(_min, v);
+        _max = std::max(_max, v);
+    }
+
+    void Merge(const Histogram &other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            _counts[i] += other._counts[i];
+        }
+        _total += other._total;
+        _sum += other._sum;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+
+    [[nodiscard]] uint64_t Count() const { return _total; }
+    [[nodiscard]] uint64_t Max() const { return _total ? _max : 0; }
+    [[nodiscard]] uint64_t Min() const { return _total ? _min : 0; }
+    [[nodiscard]] double Mean() const {
+        return _total ? _sum / static_cast<double>(_total) : 0;
+    }
+
+    // 不小于 p% 的样本所在区间的上界
+    [[nodiscard]] uint64_t Percentile(const double p) const {
+        if (_total == 0) {
+            return 0;
+        }
+        const auto rank = static_cast<uint64_t>(
+            std::ceil(p / 100.0 * static_cast<double>(_total)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += _counts[i];
+            if (seen >= std::max<uint64_t>(rank, 1)) {
+                return std::min(upperOf(i), _max);
+            }
+        }
+        return _max;
+    }
+
+  private:
+    static size_t indexOf(const uint64_t v) {
+        if (v < SUB) {
+            return v;
+        }
+        const int shift = 63 - __builtin_clzll(v) - (SUB_BITS - 1);
+        return SUB + (shift - 1) * HALF + ((v >> shift) - HALF);
+    }
+    static uint64_t upperOf(const size_t index) {
+        if (index < SUB) {
+            return index;
+        }
+        const size_t k = index - SUB;
+        const size_t shift = k / HALF + 1;
+        const uint64_t sub = k % HALF + HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> _counts;
+    uint64_t _total{0};
+    double _sum{0};
+    uint64_t _min{UINT64_MAX};
+    uint64_t _max{0};
+};
+
+struct Options {
+    std::string host{"127.0.0.1"};
+    std::string port{"1316"};
+    std::string path{"/"};
+    std::string method{"GET"};
+    std::string body;
+    std::vector<std::string> headers;
+    int connections{64};
+    int threads{4};
+    double duration{10}; // 秒
+    double warmup{0};    // 秒，这段时间内排定的请求不计入结果
+    double rate{0};      // 总请求数/秒，0 表示闭环
+    int pipeline{1};     // 每条连接在途的请求数上限
+    bool keepAlive{true};
+    bool json{false};
+};
+
+struct Stats {
+    Histogram latency;
+    uint64_t requests{0}; // 计入结果的响应数
+    uint64_t status[6]{}; // 按状态码首位分类，0 为无法解析
+    uint64_t bytes{0};
+    uint64_t connectErrors{0};
+    uint64_t readErrors{0};
+    uint64_t writeErrors{0};
+    uint64_t reconnects{0};
+    uint64_t pending{0}; // 结束时还没收到响应（含开环下还没发出）的请求
+
+    void Merge(const Stats &other) {
+        latency.Merge(other.latency);
+        requests += other.requests;
+        for (int i = 0; i < 6; ++i) {
+            status[i] += other.status[i];
+        }
+        bytes += other.bytes;
+        connectErrors += other.connectErrors;
+        readErrors += other.readErrors;
+        writeErrors += other.writeErrors;
+        reconnects += other.reconnects;
+        pending += other.pending;
+    }
+};
+
+// 增量解析 HTTP/1.1 响应：Content-Length、chunked 或读到连接关闭为止
+class ResponseParser {
+  public:
+    struct Response {
+        int status;
+        bool close; // 服务器要求关闭连接
+    };
+
+    void Reset(const bool headRequest) {
+        _in.clear();
+        _pos = 0;
+        _state = State::HEAD;
+        _head = headRequest;
+    }
+
+    void Feed(const char *data, const size_t len) { _in.append(data, len); }
+
+    // 取出一个完整的响应，不完整返回 false；出错时 error 为 true
+    bool Next(Response &out, bool &error) {
+        error = false;
+        while (true) {
+            switch (_state) {
+            case State::HEAD: {
+                const size_t end = _in.find("\r\n\r\n", _pos);
+                if (end == std::string::npos) {
+                    compact();
+                    return false;
+                }
+                if (!parseHead(std::string_view(_in).substr(_pos, end - _pos))) {
+                    error = true;
+                    return false;
+                }
+                _pos = end + 4;
+                if (_head || _current.status == 204 || _current.status == 304 ||
+                    _current.status / 100 == 1) {
+                    _remaining = 0;
+                    _state = State::LENGTH;
+                } else if (_chunked) {
+                    _state = State::CHUNK_SIZE;
+                } else if (_length >= 0) {
+                    _remaining = static_cast<size_t>(_length);
+                    _state = State::LENGTH;
+                } else {
+                    _state = State::UNTIL_EOF;
+                }
+                break;
+            }
+            case State::LENGTH: {
+                const size_t take = std::min(_remaining, _in.size() - _pos);
+                _pos += take;
+                _remaining -= take;
+                if (_remaining > 0) {
+                    compact();
+                    return false;
+                }
+                _state = State::HEAD;
+                if (_current.status / 100 == 1) {
+                    continue; // 100 Continue 之后才是真正的响应
+                }
+                out = _current;
+                return true;
+            }
+            case State::CHUNK_SIZE: {
+                const size_t eol = _in.find("\r\n", _pos);
+                if (eol == std::string::npos) {
+                    compact();
+                    return false;
+                }
+                const size_t size = strtoull(_in.c_str() + _pos, nullptr, 16);
+                _pos = eol + 2;
+                if (size == 0) {
+                    _state = State::TRAILER;
+                } else {
+                    _remaining = size + 2; // 数据之后的 CRLF
+                    _state = State::CHUNK_DATA;
+                }
+                break;
+            }
+            case State::CHUNK_DATA: {
+                const size_t take = std::min(_remaining, _in.size() - _pos);
+                _pos += take;
+                _remaining -= take;
+                if (_remaining > 0) {
+                    compact();
+                    return false;
+                }
+                _state = State::CHUNK_SIZE;
+                break;
+            }
+            case State::TRAILER: {
+                const size_t eol = _in.find("\r\n", _pos);
+                if (eol == std::string::npos) {
+                    compact();
+                    return false;
+                }
+                const bool last = eol == _pos;
+                _pos = eol + 2;
+                if (last) {
+                    _state = State::HEAD;
+                    out = _current;
+                    return true;
+                }
+                break;
+            }
+            case State::UNTIL_EOF:
+                _pos = _in.size();
+                compact();
+                return false;
+            }
+        }
+    }
+
+    // 连接关闭：没有长度的响应到此结束
+    bool Finish(Response &out) {
+        if (_state != State::UNTIL_EOF) {
+            return false;
+        }
+        _state = State::HEAD;
+        out = _current;
+        out.close = true;
+        return true;
+    }
+
+  private:
+    enum class State { HEAD, LENGTH, CHUNK_SIZE, CHUNK_DATA, TRAILER, UNTIL_EOF };
+
+    bool parseHead(const std::string_view head) {
+        if (head.size() < 12 || head.substr(0, 5) != "HTTP/") {
+            return false;
+        }
+        _current.status = atoi(std::string(head.substr(9, 3)).c_str());
+        _current.close = head.substr(5, 3) == "1.0";
+        _length = -1;
+        _chunked = false;
+        size_t pos = head.find("\r\n");
+        while (pos != std::string_view::npos) {
+            pos += 2;
+            const size_t eol = head.find("\r\n", pos);
+            const std::string_view line = head.substr(pos, eol - pos);
+            const auto is = [&line](const std::string_view name) {
+                return line.size() > name.size() &&
+                       strncasecmp(line.data(), name.data(), name.size()) == 0;
+            };
+            const auto value = [&line](const size_t skip) {
+                std::string_view v = line.substr(skip);
+                while (!v.empty() && v.front() == ' ') {
+                    v.remove_prefix(1);
+                }
+                return v;
+            };
+            if (is("Content-Length:")) {
+                _length = atoll(std::string(value(15)).c_str());
+            } else if (is("Transfer-Encoding:")) {
+                _chunked = value(18).find("chunked") != std::string_view::npos;
+            } else if (is("Connection:")) {
+                const std::string_view v = value(11);
+                _current.close = v.size() >= 5 &&
+                                 strncasecmp(v.data(), "close", 5) == 0;
+            }
+            pos = eol;
+        }
+        return _current.status >= 100 && _current.status < 600;
+    }
+
+    void compact() {
+        _in.erase(0, _pos);
+        _pos = 0;
+    }
+
+    std::string _in;
+    size_t _pos{0};
+    State _state{State::HEAD};
+    bool _head{false};
+    Response _current{};
+    int64_t _length{-1};
+    bool _chunked{false};
+    size_t _remaining{0};
+};
+
+struct Connection {
+    int fd{-1};
+    bool connected{false};
+    std::string out; // 待写出的请求
+    size_t outPos{0};
+    std::deque<int64_t> inflight; // 已发出请求的排定时间
+    std::deque<int64_t> backlog;  // 已排定、还没发出的请求
+    ResponseParser parser;
+};
+
+class Worker {
+  public:
+    Worker(const Options &opts, const addrinfo *addr, const int connections,
+           const int index)
+        : _opts(opts), _addr(addr), _conns(connections) {
+        _request = opts.method + " " + opts.path + " HTTP/1.1\r\nHost: " +
+                   opts.host + ":" + opts.port + "\r\n" +
+                   (opts.keepAlive ? "Connection: keep-alive\r\n"
+                                   : "Connection: close\r\n");
+        for (const auto &header : opts.headers) {
+            _request += header + "\r\n";
+        }
+        if (!opts.body.empty() || opts.method == "POST" || opts.method == "PUT") {
+            _request += "Content-Length: " + std::to_string(opts.body.size()) +
+                        "\r\n";
+        }
+        _request += "\r\n" + opts.body;
+        _depth = opts.keepAlive ? std::max(opts.pipeline, 1) : 1;
+        if (opts.rate > 0) {
+            // 各线程平分总速率，起始时间错开，合起来是均匀的请求流
+            const double perThread = opts.rate / opts.threads;
+            _interval = static_cast<int64_t>(1e9 / perThread);
+            _nextSend = _interval * index / opts.threads;
+        }
+    }
+
+    void Run(const int64_t start, const int64_t measureFrom, const int64_t end) {
+        _measureFrom = measureFrom;
+        _epfd = epoll_create1(EPOLL_CLOEXEC);
+        _nextSend += start;
+        for (auto &conn : _conns) {
+            if (_opts.rate <= 0) {
+                conn.backlog.assign(_depth, start);
+            }
+            open(conn);
+        }
+        epoll_event events[256];
+        size_t rr = 0;
+        while (true) {
+            int64_t now = nowNs();
+            if (now >= end) {
+                break;
+            }
+            // 开环：把到期的请求按轮转分给各连接，连接的流水线满了就在 backlog 里排队
+            while (_opts.rate > 0 && _nextSend <= now) {
+                Connection &conn = _conns[rr++ % _conns.size()];
+                conn.backlog.push_back(_nextSend);
+                _nextSend += _interval;
+                send(conn);
+            }
+            int64_t wait = end - now;
+            if (_opts.rate > 0) {
+                wait = std::min(wait, _nextSend - now);
+            }
+            const int n = epoll_wait(_epfd, events, 256,
+                                     static_cast<int>((wait + 999999) / 1000000));
+            for (int i = 0; i < n; ++i) {
+                Connection &conn = _conns[events[i].data.u32];
+                if (!conn.connected && !finishConnect(conn)) {
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    flush(conn);
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    read(conn);
+                }
+            }
+        }
+        for (auto &conn : _conns) {
+            _stats.pending += conn.inflight.size() + conn.backlog.size();
+            if (conn.fd >= 0) {
+                close(conn.fd);
+            }
+        }
+        close(_epfd);
+    }
+
+    [[nodiscard]] const Stats &GetStats() const { return _stats; }
+
+  private:
+    void open(Connection &conn) {
+        conn.fd = socket(_addr->ai_family,
+                         SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (conn.fd < 0) {
+            ++_stats.connectErrors;
+            return;
+        }
+        constexpr int one = 1;
+        setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        conn.connected = false;
+        conn.out.clear();
+        conn.outPos = 0;
+        conn.parser.Reset(_opts.method == "HEAD");
+        if (connect(conn.fd, _addr->ai_addr, _addr->ai_addrlen) < 0 &&
+            errno != EINPROGRESS) {
+            ++_stats.connectErrors;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u32 = static_cast<uint32_t>(&conn - _conns.data());
+        epoll_ctl(_epfd, EPOLL_CTL_ADD, conn.fd, &ev);
+    }
+
+    bool finishConnect(Connection &conn) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            ++_stats.connectErrors;
+            reopen(conn);
+            return false;
+        }
+        conn.connected = true;
+        send(conn);
+        return true;
+    }
+
+    // 关闭后重连；没收到响应的请求回到 backlog 最前面，保留原来的排定时间
+    void reopen(Connection &conn) {
+        epoll_ctl(_epfd, EPOLL_CTL_DEL, conn.fd, nullptr);
+        close(conn.fd);
+        conn.backlog.insert(conn.backlog.begin(), conn.inflight.begin(),
+                            conn.inflight.end());
+        conn.inflight.clear();
+        ++_stats.reconnects;
+        open(conn);
+    }
+
+    void send(Connection &conn) {
+        if (!conn.connected) {
+            return;
+        }
+        bool queued = false;
+        while (!conn.backlog.empty() &&
+               conn.inflight.size() < static_cast<size_t>(_depth)) {
+            conn.inflight.push_back(conn.backlog.front());
+            conn.backlog.pop_front();
+            conn.out += _request;
+            queued = true;
+        }
+        if (queued) {
+            flush(conn);
+        }
+    }
+
+    void flush(Connection &conn) {
+        while (conn.outPos < conn.out.size()) {
+            const ssize_t n = ::send(conn.fd, conn.out.data() + conn.outPos,
+                                     conn.out.size() - conn.outPos,
+                                     MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return; // 等可写边缘
+                }
+                ++_stats.writeErrors;
+                reopen(conn);
+                return;
+            }
+            conn.outPos += static_cast<size_t>(n);
+        }
+        conn.out.clear();
+        conn.outPos = 0;
+    }
+
+    void read(Connection &conn) {
+        char buf[64 * 1024];
+        while (true) {
+            const ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                _stats.bytes += static_cast<uint64_t>(n);
+                conn.parser.Feed(buf, static_cast<size_t>(n));
+                if (!drain(conn)) {
+                    return; // 已重连
+                }
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            // 对端关闭或出错
+            ResponseParser::Response response{};
+            if (n == 0 && conn.parser.Finish(response)) {
+                complete(conn, response);
+            } else if (!conn.inflight.empty()) {
+                ++_stats.readErrors;
+            }
+            reopen(conn);
+            return;
+        }
+    }
+
+    // 取出所有完整的响应，返回 false 表示连接已重连
+    bool drain(Connection &conn) {
+        ResponseParser::Response response{};
+        bool error = false;
+        while (conn.parser.Next(response, error)) {
+            if (!complete(conn, response)) {
+                reopen(conn);
+                return false;
+            }
+        }
+        if (error) {
+            ++_stats.readErrors;
+            reopen(conn);
+            return false;
+        }
+        return true;
+    }
+
+    // 记录一个响应，返回 false 表示应关闭连接
+    bool complete(Connection &conn, const ResponseParser::Response &response) {
+        if (conn.inflight.empty()) {
+            ++_stats.readErrors; // 多出来的响应
+            return false;
+        }
+        const int64_t scheduled = conn.inflight.front();
+        conn.inflight.pop_front();
+        if (scheduled >= _measureFrom) {
+            _stats.latency.Record(nowNs() - scheduled);
+            ++_stats.requests;
+            ++_stats.status[response.status >= 100 && response.status < 600
+                                ? response.status / 100
+                                : 0];
+        }
+        if (_opts.rate <= 0) {
+            conn.backlog.push_back(nowNs()); // 闭环：补发一个
+        }
+        if (response.close || !_opts.keepAlive) {
+            return false;
+        }
+        send(conn);
+        return true;
+    }
+
+    const Options &_opts;
+    const addrinfo *_addr;
+    std::vector<Connection> _conns;
+    std::string _request;
+    int _depth{1};
+    int64_t _interval{0};
+    int64_t _nextSend{0};
+    int64_t _measureFrom{0};
+    int _epfd{-1};
+    Stats _stats;
+};
+
+void usage(const char *prog) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [options] <http://host:port/path>\n"
+        "  -c, --connections N  open connections in total (default 64)\n"
+        "  -t, --threads N      worker threads, one epoll loop each (default 4)\n"
+        "  -d, --duration S     test duration in seconds (default 10)\n"
+        "  -w, --warmup S       leading seconds left out of the results (default 0)\n"
+        "  -R, --rate N         open loop at N requests/s in total; latency is\n"
+        "                       measured from the scheduled send time (default: closed loop)\n"
+        "  -p, --pipeline N     requests in flight per connection (default 1)\n"
+        "  -k, --no-keepalive   one request per connection (Connection: close)\n"
+        "  -m, --method M       request method (default GET)\n"
+        "  -b, --body DATA      request body\n"
+        "  -H, --header H       extra request header, repeatable\n"
+        "      --json           print the result as one JSON object\n",
+        prog);
+}
+
+bool parseUrl(const std::string &url, Options &opts) {
+    std::string_view rest(url);
+    if (rest.substr(0, 7) == "http://") {
+        rest.remove_prefix(7);
+    } else if (rest.find("://") != std::string_view::npos) {
+        return false; // 只支持明文 HTTP/1.1
+    }
+    const size_t slash = rest.find('/');
+    const std::string_view authority = rest.substr(0, slash);
+    opts.path = slash == std::string_view::npos ? "/" : std::string(rest.substr(slash));
+    const size_t colon = authority.rfind(':');
+    if (colon == std::string_view::npos) {
+        opts.host = std::string(authority);
+        opts.port = "80";
+    } else {
+        opts.host = std::string(authority.substr(0, colon));
+        opts.port = std::string(authority.substr(colon + 1));
+    }
+    return !opts.host.empty();
+}
+
+bool parseArgs(const int argc, char *argv[], Options &opts) {
+    bool haveUrl = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        const auto next = [&]() -> const char * {
+            return i + 1 < argc ? argv[++i] : nullptr;
+        };
+        const auto is = [&arg](const char *s, const char *l) {
+            return arg == s || arg == l;
+        };
+        const char *value = nullptr;
+        if (arg == "--json") {
+            opts.json = true;
+        } else if (is("-k", "--no-keepalive")) {
+            opts.keepAlive = false;
+        } else if (is("-h", "--help")) {
+            return false;
+        } else if (arg.front() != '-') {
+            if (!parseUrl(argv[i], opts)) {
+                return false;
+            }
+            haveUrl = true;
+        } else if ((value = next()) == nullptr) {
+            return false;
+        } else if (is("-c", "--connections")) {
+            opts.connections = atoi(value);
+        } else if (is("-t", "--threads")) {
+            opts.threads = atoi(value);
+        } else if (is("-d", "--duration")) {
+            opts.duration = atof(value);
+        } else if (is("-w", "--warmup")) {
+            opts.warmup = atof(value);
+        } else if (is("-R", "--rate")) {
+            opts.rate = atof(value);
+        } else if (is("-p", "--pipeline")) {
+            opts.pipeline = atoi(value);
+        } else if (is("-m", "--method")) {
+            opts.method = value;
+        } else if (is("-b", "--body")) {
+            opts.body = value;
+        } else if (is("-H", "--header")) {
+            opts.headers.emplace_back(value);
+        } else {
+            return false;
+        }
+    }
+    if (!haveUrl || opts.connections < 1 || opts.threads < 1 ||
+        opts.duration <= 0 || opts.warmup < 0 || opts.warmup >= opts.duration ||
+        opts.pipeline < 1 || opts.rate < 0) {
+        return false;
+    }
+    opts.threads = std::min(opts.threads, opts.connections);
+    return true;
+}
+
+constexpr double PERCENTILES[] = {50, 75, 90, 99, 99.9, 99.99};
+
+void printText(const Options &opts, const Stats &stats, const double seconds) {
+    const auto ms = [](const uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+    std::printf("%s http://%s:%s%s\n", opts.method.c_str(), opts.host.c_str(),
+                opts.port.c_str(), opts.path.c_str());
+    std::printf("  %d threads, %d connections, pipeline %d, %s, ", opts.threads,
+                opts.connections, opts.keepAlive ? opts.pipeline : 1,
+                opts.keepAlive ? "keep-alive" : "close");
+    if (opts.rate > 0) {
+        std::printf("open loop at %.0f req/s, ", opts.rate);
+    } else {
+        std::printf("closed loop, ");
+    }
+    std::printf("%.1fs measured\n", seconds);
+    std::printf("  requests   %llu (%.1f req/s), %.2f MiB/s received\n",
+                static_cast<unsigned long long>(stats.requests),
+                static_cast<double>(stats.requests) / seconds,
+                static_cast<double>(stats.bytes) / seconds / (1 << 20));
+    std::printf("  status     1xx %llu  2xx %llu  3xx %llu  4xx %llu  5xx %llu\n",
+                static_cast<unsigned long long>(stats.status[1]),
+                static_cast<unsigned long long>(stats.status[2]),
+                static_cast<unsigned long long>(stats.status[3]),
+                static_cast<unsigned long long>(stats.status[4]),
+                static_cast<unsigned long long>(stats.status[5]));
+    std::printf("  errors     connect %llu  read %llu  write %llu  "
+                "(reconnects %llu, pending at end %llu)\n",
+                static_cast<unsigned long long>(stats.connectErrors),
+                static_cast<unsigned long long>(stats.readErrors),
+                static_cast<unsigned long long>(stats.writeErrors),
+                static_cast<unsigned long long>(stats.reconnects),
+                static_cast<unsigned long long>(stats.pending));
+    std::printf("  latency    min %.3fms  mean %.3fms  max %.3fms\n",
+                ms(stats.latency.Min()), stats.latency.Mean() / 1e6,
+                ms(stats.latency.Max()));
+    for (const double p : PERCENTILES) {
+        std::printf("    p%-7g %.3fms\n", p, ms(stats.latency.Percentile(p)));
+    }
+}
+
+void printJson(const Options &opts, const Stats &stats, const double seconds) {
+    const auto us = [](const uint64_t ns) { return static_cast<double>(ns) / 1e3; };
+    std::printf("{\"url\":\"http://%s:%s%s\",\"method\":\"%s\",\"threads\":%d,"
+                "\"connections\":%d,\"pipeline\":%d,\"keep_alive\":%s,"
+                "\"rate\":%.0f,\"duration_s\":%.3f,",
+                opts.host.c_str(), opts.port.c_str(), opts.path.c_str(),
+                opts.method.c_str(), opts.threads, opts.connections,
+                opts.keepAlive ? opts.pipeline : 1,
+                opts.keepAlive ? "true" : "false", opts.rate, seconds);
+    std::printf("\"requests\":%llu,\"rps\":%.1f,\"bytes\":%llu,",
+                static_cast<unsigned long long>(stats.requests),
+                static_cast<double>(stats.requests) / seconds,
+                static_cast<unsigned long long>(stats.bytes));
+    std::printf("\"status\":{\"1xx\":%llu,\"2xx\":%llu,\"3xx\":%llu,"
+                "\"4xx\":%llu,\"5xx\":%llu},",
+                static_cast<unsigned long long>(stats.status[1]),
+                static_cast<unsigned long long>(stats.status[2]),
+                static_cast<unsigned long long>(stats.status[3]),
+                static_cast<unsigned long long>(stats.status[4]),
+                static_cast<unsigned long long>(stats.status[5]));
+    std::printf("\"errors\":{\"connect\":%llu,\"read\":%llu,\"write\":%llu},"
+                "\"reconnects\":%llu,\"pending\":%llu,",
+                static_cast<unsigned long long>(stats.connectErrors),
+                static_cast<unsigned long long>(stats.readErrors),
+                static_cast<unsigned long long>(stats.writeErrors),
+                static_cast<unsigned long long>(stats.reconnects),
+                static_cast<unsigned long long>(stats.pending));
+    std::printf("\"latency_us\":{\"min\":%.1f,\"mean\":%.1f,\"max\":%.1f",
+                us(stats.latency.Min()), stats.latency.Mean() / 1e3,
+                us(stats.latency.Max()));
+    for (const double p : PERCENTILES) {
+        std::printf(",\"p%g\":%.1f", p, us(stats.latency.Percentile(p)));
+    }
+    std::printf("}}\n");
+}
+
+} // namespace
+
+int main(const int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addr = nullptr;
+    if (const int err =
+            getaddrinfo(opts.host.c_str(), opts.port.c_str(), &hints, &addr);
+        err != 0) {
+        std::fprintf(stderr, "Cannot resolve %s: %s\n", opts.host.c_str(),
+                     gai_strerror(err));
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < opts.threads; ++i) {
+        const int conns = opts.connections / opts.threads +
+                          (i < opts.connections % opts.threads ? 1 : 0);
+        workers.push_back(std::make_unique<Worker>(opts, addr, conns, i));
+    }
+    const int64_t start = nowNs();
+    const auto measureFrom = start + static_cast<int64_t>(opts.warmup * 1e9);
+    const auto end = start + static_cast<int64_t>(opts.duration * 1e9);
+    std::vector<std::thread> threads;
+    for (auto &worker : workers) {
+        threads.emplace_back(
+            [&worker, start, measureFrom, end] { worker->Run(start, measureFrom, end); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    freeaddrinfo(addr);
+
+    Stats total;
+    for (const auto &worker : workers) {
+        total.Merge(worker->GetStats());
+    }
+    const double seconds = static_cast<double>(end - measureFrom) / 1e9;
+    if (opts.json) {
+        printJson(opts, total, seconds);
+    } else {
+        printText(opts, total, seconds);
+    }
+    return total.requests > 0 ? 0 : 1;
+}
@@ -35,6 +35,11 @@ namespace zener {
 static constexpr size_t INIT_BUFFER_SIZE = 1024;
 // static constexpr size_t INIT_PREPEND_SIZE = 8;
 
+/*
+    底层存储延迟到第一次写入时才分配（first-touch）：
+    Conn 由 reactor 线程创建，但缓冲区只在工作线程里读写，
+    这样内存页落在实际处理连接的线程所在的 NUMA 节点上，空闲连接也不占内存
+*/
 class Buffer {
   public:
     explicit Buffer(size_t size = INIT_BUFFER_SIZE);
@@ -103,12 +108,13 @@ class Buffer {
     ssize_t WriteFd(int fd, int* saveErrno);
 
   private:
-    _ZENER_SHORT_FUNC char* beginPtr() { return &*_buffer.begin(); }
-    _ZENER_SHORT_FUNC const char* beginPtr() const { return &*_buffer.begin(); }
+    _ZENER_SHORT_FUNC char* beginPtr() { return _buffer.data(); }
+    _ZENER_SHORT_FUNC const char* beginPtr() const { return _buffer.data(); }
 
     void makeSpace(size_t len);
 
     std::vector<char> _buffer;
+    size_t _initSize; // 首次分配的大小
 
     // std::atomic<size_t> _prePos; // 预置数据的末尾
     std::atomic<size_t> _readPos;
@@ -31,6 +31,10 @@ struct Config {
     static void Print();
 
     static const std::string &GetConfig(const std::string &key);
+    // 可选配置项用，不存在时不打印警告
+    _ZENER_SHORT_FUNC static bool Has(const std::string &key) {
+        return Initialized() && _configMap.contains(key);
+    }
     // 加锁的版本，多线程用
     const std::string &GetConfigSafe(const std::string &key) const;
 
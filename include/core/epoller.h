@@ -1,36 +1,36 @@
 #ifndef ZENER_EPOLLER_H
 #define ZENER_EPOLLER_H
 
+#include "core/event_backend.h"
+
 #include <cstdint>
 #include <sys/epoll.h>
 #include <vector>
 
 namespace zener {
 
-constexpr int N_MAX_EVENT = 1024;
-
-class Epoller {
+class Epoller final : public EventBackend {
   public:
-    explicit Epoller(int maxEvent = N_MAX_EVENT,
-                     bool isET = true); // 比起原方案，添加一个 isET
+    explicit Epoller(int maxEvent = N_MAX_EVENT);
 
-    ~Epoller();
+    ~Epoller() override;
 
     // 向 epoll 事件表注册事件
-    [[nodiscard]] bool AddFd(int fd, uint32_t events) const;
+    [[nodiscard]] bool AddFd(int fd, uint32_t events) override;
     // 修改已经注册的fd的监听事件
-    [[nodiscard]] bool ModFd(int fd, uint32_t events) const;
+    [[nodiscard]] bool ModFd(int fd, uint32_t events) override;
     // 从epoll事件表中删除一个fd
-    [[nodiscard]] bool DelFd(int fd) const;
+    [[nodiscard]] bool DelFd(int fd) override;
     // 等待epoll上监听的fd产生事件，超时时间timeout，产生的事件需要使用GetEvents获得
-    [[nodiscard]] int Wait(int timeoutMs = -1);
+    [[nodiscard]] int Wait(int timeoutMs = -1) override;
     // 获取产生的事件的来源fd（应在wait之后调用）
-    [[nodiscard]] int GetEventFd(int i) const;
+    [[nodiscard]] int GetEventFd(int i) const override;
     // 获取产生的事件（应在wait之后调用）
-    [[nodiscard]] uint32_t GetEvents(int i) const;
+    [[nodiscard]] uint32_t GetEvents(int i) const override;
+
+    [[nodiscard]] const char *Name() const override { return "epoll"; }
 
   private:
-    bool _isET;                              // 是否开启ET模式
     int _epollFd;                            // epoll事件表
     std::vector<struct epoll_event> _events; // 存储epoll上监听的fd产生的事件
 };
@@ -0,0 +1,85 @@
+#ifndef ZENER_EVENT_BACKEND_H
+#define ZENER_EVENT_BACKEND_H
+
+/*
+    事件后端接口：Server 只依赖这里的就绪通知语义（与 epoll 相同）
+    - 事件掩码使用 EPOLLIN/EPOLLOUT/EPOLLRDHUP/EPOLLET/EPOLLONESHOT 等常量
+    - AddFd/ModFd/DelFd 可在任意线程调用，Wait/GetEventFd/GetEvents 只在 reactor 线程调用
+    目前有 epoll（Epoller）和 io_uring（UringPoller）两种实现
+    完成式 IO（CompletionIo 为 true，目前只有 io_uring）：accept、收和发由后端完成，
+    Server 不再在就绪后自己调用 accept4/read/writev，见 AddListener/AddConn/Send
+*/
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace zener {
+
+constexpr int N_MAX_EVENT = 1024;
+
+class EventBackend {
+  public:
+    virtual ~EventBackend() = default;
+
+    // 注册 fd
+    [[nodiscard]] virtual bool AddFd(int fd, uint32_t events) = 0;
+    // 修改已经注册的 fd 的监听事件（ONESHOT 触发后用于重新激活）
+    [[nodiscard]] virtual bool ModFd(int fd, uint32_t events) = 0;
+    // 注销 fd，须在 close(fd) 之前调用
+    [[nodiscard]] virtual bool DelFd(int fd) = 0;
+    // 等待事件，返回就绪事件数，出错返回 -1
+    [[nodiscard]] virtual int Wait(int timeoutMs = -1) = 0;
+    // 第 i 个就绪事件的 fd（应在 Wait 之后调用）
+    [[nodiscard]] virtual int GetEventFd(int i) const = 0;
+    // 第 i 个就绪事件的掩码（应在 Wait 之后调用）
+    [[nodiscard]] virtual uint32_t GetEvents(int i) const = 0;
+
+    [[nodiscard]] virtual const char *Name() const = 0;
+
+    // 以下在不支持完成式 IO 时退化为就绪通知
+    [[nodiscard]] virtual bool CompletionIo() const { return false; }
+    // 注册监听 socket：完成式下后端代为 accept，新连接由 GetAccepted 取得；
+    // ModFd 去掉 EPOLLIN 暂停 accept，已经 accept 的连接照常交付，加回恢复
+    [[nodiscard]] virtual bool AddListener(const int fd, const uint32_t events) {
+        return AddFd(fd, events);
+    }
+    // 注册连接：完成式下后端持续接收，EPOLLIN 事件的数据由 GetData 取得，
+    // EPOLLRDHUP/EPOLLERR 表示对端关闭或出错；ModFd 去掉 EPOLLIN 暂停接收，加回恢复
+    [[nodiscard]] virtual bool AddConn(const int fd, const uint32_t events) {
+        return AddFd(fd, events);
+    }
+    // 第 i 个事件是监听 socket 时：已接受的连接 fd，失败为 -errno
+    [[nodiscard]] virtual int GetAccepted(int /*i*/) const { return -EAGAIN; }
+    // 第 i 个事件收到的数据，在下一次 Wait 之前有效
+    [[nodiscard]] virtual std::string_view GetData(int /*i*/) const {
+        return {};
+    }
+    // 任意线程调用，同一连接同时只能有一个调用方：数据拷进后端后按序发出，
+    // 返回接受的字节数（可能少于 iov 的总长）；上一次的数据还没发完时返回 -1、
+    // errno 为 EAGAIN，发完后报告一次 EPOLLOUT。发送失败报告 EPOLLERR
+    [[nodiscard]] virtual ssize_t Send(int /*fd*/, const iovec * /*iov*/,
+                                       int /*iovCnt*/) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+};
+
+struct EventBackendOptions {
+    std::string kind{"epoll"}; // "epoll" 或 "io_uring"
+    int maxEvents{N_MAX_EVENT};
+    unsigned uringEntries{4096}; // io_uring 提交队列长度
+    bool uringSqpoll{false};     // 内核线程轮询提交队列，提交不再需要系统调用
+    bool uringCompletion{true};  // 由 io_uring 完成 accept/收/发，false 时只做就绪通知
+};
+
+// 按配置创建后端，io_uring 不可用时退回 epoll
+std::unique_ptr<EventBackend> NewEventBackend(const EventBackendOptions &opts);
+
+} // namespace zener
+
+#endif // !ZENER_EVENT_BACKEND_H
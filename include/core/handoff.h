@@ -0,0 +1,31 @@
+#ifndef ZENER_HANDOFF_H
+#define ZENER_HANDOFF_H
+
+/*
+    热重启：新旧进程之间通过 Unix 域 socket 传递监听 fd（SCM_RIGHTS）
+    1. 旧进程在 [upgrade] socket 指定的路径上 Listen
+    2. 新进程启动时先 Receive：连得上说明有旧进程，取到监听 fd 后直接使用，
+       不再 bind/listen，内核中的 accept 队列不会丢失
+    3. 旧进程发出 fd 后停止 accept 并排空连接，新进程重新占用该路径
+    SpawnSelf 用于 SIGUSR2：以相同参数启动一个新的自己
+*/
+
+#include <string>
+
+namespace zener::handoff {
+
+// 在 path 上监听（先删除残留文件），失败返回 -1
+int Listen(const std::string &path);
+
+// 向前任请求监听 fd：没有前任时返回 -1
+int Receive(const std::string &path);
+
+// 把 fd 通过已连接的 Unix socket 发出去
+bool Send(int sock, int fd);
+
+// 以当前进程的可执行文件和命令行参数启动新进程，返回子进程 pid，失败返回 -1
+int SpawnSelf();
+
+} // namespace zener::handoff
+
+#endif // !ZENER_HANDOFF_H
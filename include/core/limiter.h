@@ -0,0 +1,80 @@
+#ifndef ZENER_LIMITER_H
+#define ZENER_LIMITER_H
+
+/*
+    按源 IP 的连接数上限和请求速率限制（[limit]）
+    - 每个 IP 占表中的一个槽：同时打开的连接数 + 令牌桶
+    - 表按 IP 的哈希分片，片内开放寻址；槽的分配、连接数的增减和回收只在
+      循环线程（accept、removeConn）上进行，工作线程只对持有连接的
+      令牌桶做 CAS，全程无锁
+    - 连接持有槽的下标，连接数不为 0 的槽不会被回收；accept 时顺带调用 Sweep，
+      每 SWEEP_INTERVAL_MS 回收一个分片里没有连接、令牌桶也已补满的槽（即闲置的 IP）
+    - 表满时新 IP 不受限（fail open），只记日志
+    超限的连接在 accept 后直接 RST 关闭，不创建 Conn；超速的请求回 429 后关闭。
+    令牌经 Conn::admit 按请求扣除：HTTP/2 每个流、WebSocket 每条消息各算一个请求
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace zener {
+
+struct LimiterOptions {
+    uint32_t maxConnsPerIp{0}; // 0 表示不限
+    uint32_t rate{0};          // 每秒补充的令牌（请求）数，0 表示不限
+    uint32_t burst{0};         // 令牌桶容量，0 表示与 rate 相同
+    uint32_t tableSize{65536}; // 记录的 IP 数上限，向上取整到分片数的倍数
+};
+
+class ClientLimiter {
+  public:
+    static constexpr int UNTRACKED = -1; // 未启用或表已满，不受限
+
+    explicit ClientLimiter(const LimiterOptions &opts);
+
+    [[nodiscard]] bool Enabled() const {
+        return _maxConns > 0 || _rate > 0;
+    }
+    [[nodiscard]] bool RateLimited() const { return _rate > 0; }
+
+    // 循环线程：新连接到来，超过上限返回 false；否则 slot 为要交给 Release 的槽
+    [[nodiscard]] bool Admit(uint32_t ip, int &slot);
+    // 循环线程：连接关闭
+    void Release(int slot);
+    // 持有连接的线程：开始处理一个请求，令牌用完返回 false
+    [[nodiscard]] bool Acquire(int slot);
+    // 循环线程：距上次超过 SWEEP_INTERVAL_MS 时回收一个分片里的闲置槽，分片轮流进行
+    void Sweep();
+
+    static constexpr int SHARDS = 64;
+    static constexpr uint32_t SWEEP_INTERVAL_MS = 250;
+    static constexpr int MAX_PROBES = 16; // 片内最多探测的槽数
+
+  private:
+    struct Slot {
+        std::atomic<uint32_t> ip{0}; // 0 表示空槽（0.0.0.0 不会是对端地址）
+        std::atomic<uint32_t> conns{0};
+        // 高 32 位：上次补充的时间（毫秒），低 32 位：剩余的千分之一令牌数
+        std::atomic<uint64_t> bucket{0};
+    };
+
+    [[nodiscard]] uint32_t nowMs() const;
+    [[nodiscard]] uint64_t fullBucket(uint32_t now) const;
+    [[nodiscard]] bool idle(const Slot &slot, uint32_t now) const;
+
+    const uint32_t _maxConns;
+    const uint32_t _rate;  // 千分之一令牌/毫秒，数值上等于令牌/秒
+    const uint64_t _burst; // 千分之一令牌
+    const uint32_t _shardSize;
+    std::unique_ptr<Slot[]> _slots;
+    int _nextSweep{0};
+    uint32_t _lastSweep{0};
+    bool _fullLogged{false};
+    const std::chrono::steady_clock::time_point _epoch;
+};
+
+} // namespace zener
+
+#endif // !ZENER_LIMITER_H
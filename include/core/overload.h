@@ -0,0 +1,87 @@
+#ifndef ZENER_OVERLOAD_H
+#define ZENER_OVERLOAD_H
+
+/*
+    过载保护：按事件循环的滞后和工作线程队列的排队时间做准入控制（[overload]）
+    - 循环滞后：每轮从 Wait 返回到处理完所有事件的耗时，取指数滑动平均
+    - 队列年龄：每个采样周期向线程池投递一个探测任务，记录它从投递到开始执行的时间；
+      探测还没执行时按它已经等待的时间算，队列卡死也能立刻看出来
+    - 任一项超过阈值即为过载：Server 暂停 accept（监听 fd 移出 epoll，新连接留在
+      内核的监听队列里），响应不再保持长连接（HTTP/2 发 GOAWAY）；新请求按拒绝比例
+      直接回 503，HTTP/2 的新流、WebSocket 的消息经 Conn::admit 按同一比例拒绝
+    - 拒绝比例加性增、乘性减：过载的每个采样周期增加 shedStep，恢复后每周期减为 3/4，
+      宁可拒绝一小部分请求，也不要让所有请求都超时
+    采样、状态切换只在循环线程上进行，工作线程只读拒绝比例
+*/
+
+#include <atomic>
+#include <cstdint>
+
+namespace zener {
+
+struct OverloadOptions {
+    uint32_t loopLagMs{0};    // 循环滞后阈值，0 表示不检查
+    uint32_t queueDelayMs{0}; // 队列年龄阈值，0 表示不检查
+    uint32_t shedStep{50};    // 过载时每个采样周期增加的拒绝比例（千分比）
+    bool closeKeepAlive{true}; // 过载期间的响应带 Connection: close
+};
+
+class OverloadGuard {
+  public:
+    static constexpr int SAMPLE_MS = 100;
+
+    explicit OverloadGuard(const OverloadOptions &opts);
+
+    [[nodiscard]] bool Enabled() const {
+        return _loopLagUs > 0 || _queueDelayUs > 0;
+    }
+    [[nodiscard]] bool CloseKeepAlive() const { return _closeKeepAlive; }
+
+    // 循环线程：一轮事件处理完后调用，busyUs 为本轮的耗时；
+    // 到了采样时刻完成一次采样并返回 true
+    bool Tick(int64_t busyUs);
+    // 循环线程：最近一次采样是否过载
+    [[nodiscard]] bool Overloaded() const { return _overloaded; }
+    // 循环线程：还在过载或拒绝比例还没降到 0，事件循环需要定期醒来采样
+    [[nodiscard]] bool Active() const {
+        return _overloaded || _shed.load(std::memory_order_relaxed) > 0;
+    }
+    // 循环线程：需要投递新的队列探测时返回投递时间戳，否则返回 0
+    [[nodiscard]] int64_t StartProbe();
+    // 工作线程：探测任务开始执行
+    void FinishProbe(int64_t stamp);
+
+    // 任意线程：按当前拒绝比例决定是否拒绝一个新请求
+    [[nodiscard]] bool Shed() const;
+
+    // 监控用
+    [[nodiscard]] uint32_t ShedPermille() const {
+        return _shed.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] int64_t LoopLagUs() const {
+        return _lagUs.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] int64_t QueueAgeUs() const {
+        return _ageUs.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static int64_t NowUs();
+
+  private:
+    const int64_t _loopLagUs;
+    const int64_t _queueDelayUs;
+    const uint32_t _shedStep;
+    const bool _closeKeepAlive;
+
+    bool _overloaded{false};
+    int64_t _lastSample{0};
+    std::atomic<int64_t> _lagUs{0};     // 循环滞后的滑动平均
+    std::atomic<int64_t> _ageUs{0};     // 最近一次采样的队列年龄
+    std::atomic<int64_t> _probeSent{0}; // 未完成的探测的投递时间，0 表示没有
+    std::atomic<int64_t> _probeAgeUs{0}; // 最近完成的探测的排队时间
+    std::atomic<uint32_t> _shed{0};     // 拒绝比例（千分比）
+};
+
+} // namespace zener
+
+#endif // !ZENER_OVERLOAD_H
@@ -8,17 +8,24 @@
         res.SetStatus(200).SetBody("OK");
     });
 */
-#include "core/epoller.h"
+#include "core/event_backend.h"
+#include "core/limiter.h"
+#include "core/overload.h"
 #include "http/conn.h"
 #include "http/router.h"
 #include "task/threadpool_1.h"
+#include "utils/mpsc_queue.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <csignal>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <netinet/in.h>
 #include <shared_mutex>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 
 namespace zener {
@@ -36,25 +43,50 @@ class Server {
     ~Server();
 
     void Run();
+    // 任意线程调用：通过 eventfd 唤醒事件循环，使其立即退出
     void Stop();
+    // 任意线程调用：优雅退出，停止 accept 并等连接处理完（SIGTERM/SIGINT 同此）
+    // SIGUSR2 启动新进程并把监听 socket 交给它（需配置 [upgrade] socket）
+    void Drain();
+    // 任意线程调用：把一个已连接的 socket 交给事件循环接管（如热升级时转交的连接）
+    void Adopt(int fd, const sockaddr_in &addr);
 
     // ---- Routing API ----
-    void GET(const std::string& path, http::HandlerFunc handler) {
-        _router.Add("GET", path, std::move(handler));
+    // blocking = true 的路由（数据库、文件系统等）在线程池的 BLOCKING 通道执行
+    void GET(const std::string& path, http::HandlerFunc handler,
+             bool blocking = false) {
+        _router.Add("GET", path, std::move(handler), blocking);
     }
-    void POST(const std::string& path, http::HandlerFunc handler) {
-        _router.Add("POST", path, std::move(handler));
+    void POST(const std::string& path, http::HandlerFunc handler,
+             bool blocking = false) {
+        _router.Add("POST", path, std::move(handler), blocking);
     }
-    void PUT(const std::string& path, http::HandlerFunc handler) {
-        _router.Add("PUT", path, std::move(handler));
+    void PUT(const std::string& path, http::HandlerFunc handler,
+             bool blocking = false) {
+        _router.Add("PUT", path, std::move(handler), blocking);
     }
-    void DELETE(const std::string& path, http::HandlerFunc handler) {
-        _router.Add("DELETE", path, std::move(handler));
+    void DELETE(const std::string& path, http::HandlerFunc handler,
+             bool blocking = false) {
+        _router.Add("DELETE", path, std::move(handler), blocking);
+    }
+    // 协程处理函数：co_await http::Sleep/Query/Drained 时不占用工作线程（只支持 HTTP/1.1）
+    void Async(const std::string& method, const std::string& path,
+               http::AsyncHandlerFunc handler) {
+        _router.AddAsync(method, path, std::move(handler));
+    }
+    // 缓存已注册路由的响应（TTL 内直接回放，并发的未命中只执行一次处理函数）
+    void Cache(const std::string& method, const std::string& path,
+               http::CachePolicy policy) {
+        _router.Cache(method, path, std::move(policy));
     }
     // Serve files from fsRoot under urlPrefix, e.g. Static("/", "./static")
     void Static(const std::string& urlPrefix, const std::string& fsRoot) {
         _router.Static(urlPrefix, fsRoot);
     }
+    // WebSocket 路由；其他线程用 http::ws::Hub::GetInstance().Broadcast 推送
+    void WebSocket(const std::string& path, http::ws::Handlers handlers) {
+        _router.WebSocket(path, std::move(handlers));
+    }
 
     _ZENER_SHORT_FUNC bool IsClosed() const {
         return _isClose.load(std::memory_order_relaxed);
@@ -101,28 +133,105 @@ class Server {
         }
     };
 
+    /*
+        跨线程发给事件循环的命令，由循环线程每轮批量处理
+        事件循环状态（_users 的增删、后端注册）只由循环线程修改
+    */
+    struct LoopCommand {
+        enum class Kind {
+            ARM_WRITE, // 连接有了待发数据（非持有线程产生），关心可写并派发
+            RESUME_READ, // 完成式 IO：收件箱已被取走，恢复暂停的接收
+            CLOSE,     // 关闭连接
+            TIMEOUT,   // 空闲超时：WebSocket 先探测一次，其余同 CLOSE
+            ADOPT,     // 接管一个已连接的 fd
+            DRAIN,     // 开始排空
+            SHUTDOWN,  // 退出事件循环
+        };
+        Kind kind;
+        int fd;
+        uint64_t connId;
+        bool owned;       // CLOSE：发起方是否持有该连接
+        sockaddr_in addr; // ADOPT
+    };
+
     bool initSocket();
+    bool initWakeup(); // 创建 eventfd 并注册到事件后端
+    bool initListenEvent();
+    bool initUpgrade();
+
+    void startDrain();
+    void closeIdleConns(); // 排空期间关闭空闲的连接
+    void handleSignal(int sig);
+    void dealUpgrade(); // 把监听 fd 交给继任进程，然后开始排空
+    void applyListenOptions(); // [tcp] 中的 TCP_DEFER_ACCEPT / TCP_FASTOPEN
     void initEventMode(int trigMode);
-    void addClient(int fd, const sockaddr_in &addr);
+    void initMetrics(); // 注册回调指标和 /metrics 路由
+    void addClient(int fd, const sockaddr_in &addr,
+                   int limiterSlot = ClientLimiter::UNTRACKED);
 
     void dealListen();
-    void dealRead(http::Conn *client);
-    void dealWrite(http::Conn *client);
+    void dealAccepted(int fd); // 完成式 IO：后端 accept 好的连接，或 -errno
+    void acceptConn(int fd, const sockaddr_in &addr); // 新连接的准入，通过后 addClient
+    void dropPendingConn(); // EMFILE：用预留 fd 接下一个排队的连接并关闭
+    // reactor 线程：把就绪事件（完成式下还有收到的数据）记到连接上，连接空闲时派发 onEvent
+    void dealEvent(int fd, uint32_t events, std::string_view data);
+    void schedule(http::Conn *client); // 取得所有权后把 onEvent 投给线程池
 
     static void sendError(int fd, const char *info);
+    static void resetConn(int fd); // 以 RST 关闭，不进入 TIME_WAIT、不发送任何数据
     void extentTime(http::Conn *client); // 刷新连接的超时时间
 
-    void closeConn(http::Conn *client); // 正常工作线程中的关闭逻辑
+    // 持有连接的线程调用：交给事件循环关闭，调用后不能再使用 client
+    void closeConn(http::Conn *client);
+    // 循环线程：从后端注销并从 _users 删除（析构时关闭 fd）
+    void removeConn(http::Conn *client);
+    void post(const LoopCommand &cmd); // 入队并在队列由空变非空时唤醒循环
+    void wakeup() const;
+    void drainCommands(); // 循环线程：处理积压的命令
+    [[nodiscard]] bool inLoop() const {
+        return std::this_thread::get_id() == _loopThread;
+    }
     void closeConnAsync(int fd, const std::function<void()> &callback =
                                     nullptr); // 异步关闭连接（非阻塞）
     void _closeConnInternal(
         http::Conn &&client) const; // 实际关闭逻辑（意图与原有 closeConn
                                     // 逻辑解耦）但实际上原本实现里没用上
 
+    void onEvent(http::Conn *client); // 按记录的就绪事件驱动连接
     void onRead(http::Conn *client);
+    void onAccept(http::Conn *client); // 首个请求已到达的新连接：已注册，不等通知直接读
+    void afterRead(http::Conn *client, ssize_t ret, int readErrno);
     void handleReadError(http::Conn *client, int err);
     void onWrite(http::Conn *client);
     void onProcess(http::Conn *client);
+    // 有处理函数的路由按是否阻塞转交 NORMAL/BLOCKING 通道，
+    // 静态文件、HTTP/2 帧和 WebSocket 消息在当前工作线程直接处理
+    void dispatchProcess(http::Conn *client);
+    // 带上通道的排队截止时间投递 task，积压到上限时返回 false（task、onShed 都不执行）。
+    // dispatchProcess 和 http::Conn::offload（HTTP/2 的流）共用
+    bool enqueue(http::Conn::Lane route, std::function<void()> task,
+                 std::function<void()> onShed);
+    void rejectBusy(http::Conn *client, int code = 503); // 回 503/429 并关闭连接
+    // 按源 IP 的令牌桶和过载丢弃比例准入一个请求（HTTP/1.1 请求、HTTP/2 流、
+    // WebSocket 消息），返回 0 或拒绝的状态码（429/503），即 http::Conn::admit
+    int admitRequest(int limiterSlot);
+    // 本轮处理结束：交还连接，期间又有就绪事件则重新投递 onEvent
+    void finishIo(http::Conn *client);
+
+    static ThreadPoolLanes lanesFromConfig(); // 读取 [thread] 中的通道配额
+    static ThreadPoolSizing sizingFromConfig(); // 读取 [thread] 中的线程数上下限
+    static ThreadPoolAffinity affinityFromConfig(); // 读取 [cpu] 中的绑核配置
+    static EventBackendOptions backendFromConfig(); // 读取 [app] backend 与 [uring]
+    static LimiterOptions limiterFromConfig(); // 读取 [limit]
+    static OverloadOptions overloadFromConfig(); // 读取 [overload]
+    static void logLevelsFromConfig(int logLevel); // 读取 [log] 中的全局和按模块级别
+    void loopFromConfig(); // 读取 [app] 排空与 accept 预算、[thread] 排队截止时间、reactor 绑核
+    static void httpFromConfig(); // 读取 [http]、[http2]、[cache]，设置连接与请求的上限
+    // 循环线程：一轮事件处理完后采样，过载状态变化时暂停/恢复 accept
+    void checkOverload(int64_t busyUs);
+    void pauseAccept(bool pause);
+    // 连接最近一次收包所在 CPU 的 NUMA 节点，未知时为 -1
+    static int incomingNode(int fd);
 
     /// @intro 校验 conn 的 fd 和 connId 的一致性
     /// @thread 安全
@@ -145,28 +254,46 @@ class Server {
     /*
         设置 TCP_NODELAY，禁用Nagle算法，减少小数据包（如请求头、ACK）延迟
         大文件传输或批量数据场景可保留 Nagle 算法以提升吞吐量
-        任何影响数据传输行为的选项都应该在客户端套接字上设置，而不是监听套接字
+        设在监听套接字上，由 accept 出来的连接继承
     */
     static int setNoDelay(int fd);
 
     int _port; // 服务器监听的端口
     bool _openLinger;
     int _timeoutMS; // @
+    int _normalDeadlineMS{0};   // NORMAL 任务的排队截止时间，0 表示不限
+    int _blockingDeadlineMS{0}; // BLOCKING 任务的排队截止时间，0 表示不限
+    std::vector<int> _reactorCpus; // reactor 线程绑定的 CPU，空表示不绑定
     // @改为原子. reactor主线程为单线程，但可能会使用safeguard
     std::atomic<bool> _isClose;
 
     int _listenFd{};
+    int _reserveFd{-1};        // 预留的 fd，见 dropPendingConn
+    int _acceptBudget{64};     // 每轮 dealListen 最多 accept 的连接数
+    bool _acceptPending{false}; // 上一轮预算用完，监听队列里可能还有连接
+    bool _readOnAccept{false}; // 开启了 DEFER_ACCEPT，accept 后直接读
+    bool _draining{false};     // 只由循环线程读写
+    bool _acceptPaused{false}; // 过载时监听 fd 已移出 epoll
+    int _drainTimeoutMS{10000};
+    std::chrono::steady_clock::time_point _drainDeadline{};
+    std::string _upgradePath{}; // 热重启用的 Unix socket 路径，空表示关闭
+    int _upgradeFd{-1};
+    bool _handedOff{false}; // 监听 socket 已交给继任进程
+    uint64_t _acceptDropped{0}; // 上次日志以来因 EMFILE 丢弃的连接数
+    std::chrono::steady_clock::time_point _lastDropLog{};
     std::string _cwd{};       // 工作目录
     std::string _staticDir{}; // 静态资源目录
     std::string _logDir{};
 
     uint32_t _listenEvent{};
-    uint32_t _connEvent{};
+    uint32_t _connEvent{}; // 连接只在 accept 时注册一次
 
     // webserver 11 此处存储 unique_ptr<HeapTimer>, 但我计时器是单例
     std::unique_ptr<ThreadPool> _threadpool;
-    std::unique_ptr<Epoller> _epoller;
+    std::unique_ptr<EventBackend> _epoller; // epoll 或 io_uring，见 [app] backend
     http::Router _router;
+    ClientLimiter _limiter; // 按源 IP 的连接数和请求速率限制，只在循环线程上分配/回收槽
+    OverloadGuard _overload; // 按循环滞后和队列年龄暂停 accept、拒绝请求
     /*
         旧版本: mutable std::unordered_map<int, http::Conn> _users;
         新版本: 使用ConnInfo结构体存储连接信息
@@ -183,7 +310,9 @@ class Server {
     /*
         通过 eventfd 创建，用于唤醒。防止退出的时候阻塞在 epoll_wait
      */
-    int _wakeupFd{};
+    int _wakeupFd{-1};
+    MpscQueue<LoopCommand> _commands;
+    std::thread::id _loopThread; // Run 所在线程
     mutable std::shared_mutex _connMutex;
 };
 
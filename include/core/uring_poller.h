@@ -0,0 +1,184 @@
+#ifndef ZENER_URING_POLLER_H
+#define ZENER_URING_POLLER_H
+
+/*
+    基于 io_uring 的事件后端（直接使用系统调用，不依赖 liburing）
+    就绪通知（AddFd，wakeup/upgrade 等 fd，以及完成式不可用时的全部 fd）：
+    - 每个 fd 对应一个 IORING_OP_POLL_ADD 请求，完成事件（CQE）的 res 就是就绪掩码，
+      与 epoll 的 EPOLLIN/EPOLLOUT 等位定义一致
+    - EPOLLONESHOT：单次 poll，触发后需 ModFd 重新激活
+    - EPOLLET（非 ONESHOT）：多次触发 poll（IORING_POLL_ADD_MULTI），内核终止时自动重提
+    - 水平触发：每次触发后在下一轮 Wait 自动重提单次 poll，仍就绪会立刻再次完成
+    完成式 IO（AddListener/AddConn/Send）：
+    - 监听 socket 挂一个多次触发的 IORING_OP_ACCEPT，每个完成事件就是一个新连接
+    - 连接挂一个多次触发的 IORING_OP_RECV，内核从注册的缓冲区环（provided buffer
+      ring）里取缓冲区收数据，Wait 返回的事件直接带着数据，下一次 Wait 时归还缓冲区；
+      EPOLLONESHOT 的连接改用单次 recv，收到数据后需 ModFd 重新激活
+    - Send 把数据拷进后端自己的缓冲区，以 IORING_OP_SEND 发出并链接一个
+      IORING_OP_LINK_TIMEOUT；每个 fd 同时只有一个发送在途以保证顺序。
+      连接关闭后在途的发送照常完成但不再续发，不读数据的对端由超时回收
+    - 需要 Linux 6.0+（多次触发的 recv），注册缓冲区环失败或 [uring] completion = false
+      时退化为就绪通知
+    user_data 最高字节是请求类型，其余为代数（generation）和 fd，ModFd/DelFd 后
+    旧请求的完成事件被丢弃；发送的 user_data 是在途发送表的键。
+    reactor 线程内的提交只写入提交队列，由下一次 Wait 的 io_uring_enter 批量提交；
+    其他线程的提交立即提交（开启 SQPOLL 时只需写队列，不再进入内核）
+    需要 IORING_FEAT_EXT_ARG（Linux 5.11+）以支持带超时的等待，否则初始化失败
+*/
+
+#include "core/event_backend.h"
+
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace zener {
+
+class UringPoller final : public EventBackend {
+  public:
+    UringPoller(int maxEvent, unsigned entries, bool sqpoll, bool completion);
+    ~UringPoller() override;
+
+    UringPoller(const UringPoller &) = delete;
+    UringPoller &operator=(const UringPoller &) = delete;
+
+    // 初始化是否成功，失败时应退回 epoll
+    [[nodiscard]] bool Ok() const { return _ringFd >= 0; }
+
+    [[nodiscard]] bool AddFd(int fd, uint32_t events) override;
+    [[nodiscard]] bool ModFd(int fd, uint32_t events) override;
+    [[nodiscard]] bool DelFd(int fd) override;
+    [[nodiscard]] int Wait(int timeoutMs = -1) override;
+    [[nodiscard]] int GetEventFd(int i) const override;
+    [[nodiscard]] uint32_t GetEvents(int i) const override;
+
+    [[nodiscard]] bool CompletionIo() const override {
+        return _bufRing != nullptr;
+    }
+    [[nodiscard]] bool AddListener(int fd, uint32_t events) override;
+    [[nodiscard]] bool AddConn(int fd, uint32_t events) override;
+    [[nodiscard]] int GetAccepted(int i) const override;
+    [[nodiscard]] std::string_view GetData(int i) const override;
+    [[nodiscard]] ssize_t Send(int fd, const iovec *iov, int iovCnt) override;
+
+    [[nodiscard]] const char *Name() const override;
+
+  private:
+    static constexpr int MAX_FD = 65536;
+    // 取消请求、链接超时自身的完成事件使用该 user_data，直接忽略
+    static constexpr uint64_t IGNORE_TAG = ~0ULL;
+    static constexpr uint32_t GEN_MASK = 0xffffff; // user_data 中代数占 24 位
+    // 缓冲区环：RECV_BUFS 个 RECV_BUF_SIZE 字节的缓冲区，一轮 Wait 用完时多次触发的
+    // recv 以 ENOBUFS 结束，下一轮归还缓冲区后重提
+    static constexpr unsigned RECV_BUFS = 1024;
+    static constexpr unsigned RECV_BUF_SIZE = 16 * 1024;
+    static constexpr uint16_t RECV_GROUP = 0;
+    // 单次 Send 最多接受的字节数，超出部分等这次发完（EPOLLOUT）后再交
+    static constexpr size_t SEND_CHUNK = 256 * 1024;
+    // 一次发送（含等待对端读取）的最长时间，超时按出错关闭
+    static constexpr int SEND_TIMEOUT_S = 60;
+
+    // 请求类型（user_data 最高字节），也是 fd 的注册方式
+    enum Op : uint8_t { OP_POLL, OP_ACCEPT, OP_RECV, OP_SEND };
+
+    struct FdState {
+        uint32_t gen{0};
+        uint32_t events{0}; // 0 表示未注册
+        Op op{OP_POLL};     // 注册方式，也是挂在内核里的请求类型
+        bool armed{false};  // 内核中是否有该 fd 的 poll/accept/recv 请求
+        bool sending{false}; // 有在途的发送
+        bool blocked{false}; // Send 因在途发送被拒绝过，发完后报告 EPOLLOUT
+    };
+
+    // 在途的发送，数据由后端持有直到完成
+    struct SendOp {
+        int fd;
+        uint32_t gen;
+        std::vector<char> data;
+        size_t off{0}; // 已发出的字节数，短写时从这里接着发
+    };
+
+    struct Event {
+        int fd;
+        uint32_t events;
+        int accepted{-1};           // 监听 socket：新连接或 -errno
+        const char *data{nullptr}; // 连接：收到的数据（在缓冲区环里）
+        uint32_t len{0};
+    };
+
+    bool setup(unsigned entries);
+    // 注册缓冲区环并确认内核支持多次触发的 recv，失败时只做就绪通知
+    bool setupBufRing();
+    // 以下调用者须持有 _sqMtx
+    // 取一个提交项，保证队列里还有 need 个空位（满了先交给内核）；写好后 publish
+    io_uring_sqe *getSqe(unsigned need = 1);
+    void publish() const;
+    // 注册或替换 fd 的请求：旧请求取消、代数加一
+    bool arm(int fd, uint32_t events, Op op);
+    // 按注册方式挂上 poll/accept/recv
+    void prepArm(int fd, FdState &st);
+    void prepCancel(uint64_t userData);
+    void prepSend(uint64_t key, const SendOp &op);
+    // 发送完成：仍是同一个连接时短写接着发，否则丢弃并交还 fd 的发送权
+    void onSent(uint64_t key, int res);
+    // 把上一轮事件用过的缓冲区还给内核
+    void recycle();
+    // 把已写入的提交项交给内核：reactor 线程延迟到 Wait，其他线程立即提交
+    void flush();
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+              const void *arg, size_t argSize) const;
+
+    static uint64_t pack(const int fd, const uint32_t gen, const Op op) {
+        return static_cast<uint64_t>(op) << 56 |
+               static_cast<uint64_t>(gen & GEN_MASK) << 32 |
+               static_cast<uint32_t>(fd);
+    }
+
+    int _ringFd{-1};
+    bool _sqpoll;
+    unsigned _sqEntries{0};
+
+    // 映射的环形队列
+    void *_sqRing{nullptr};
+    void *_cqRing{nullptr};
+    size_t _sqRingSize{0};
+    size_t _cqRingSize{0};
+    io_uring_sqe *_sqes{nullptr};
+    size_t _sqesSize{0};
+
+    // 与内核共享的计数器，通过 std::atomic_ref 访问
+    unsigned *_sqHead{nullptr};
+    unsigned *_sqTail{nullptr};
+    unsigned *_sqFlags{nullptr};
+    unsigned _sqMask{0};
+    unsigned *_cqHead{nullptr};
+    unsigned *_cqTail{nullptr};
+    unsigned _cqMask{0};
+    io_uring_cqe *_cqes{nullptr};
+
+    // 缓冲区环，为空表示完成式 IO 不可用；只由 reactor 线程归还缓冲区
+    io_uring_buf_ring *_bufRing{nullptr};
+    char *_bufs{nullptr};
+    uint16_t _bufTail{0};
+    std::vector<uint16_t> _recycle; // 本轮事件占用、下一轮 Wait 归还的缓冲区
+
+    std::mutex _sqMtx; // 保护提交队列、_fds 和 _sends
+    unsigned _sqLocalTail{0};
+    std::vector<FdState> _fds;
+    std::vector<int> _relevel; // 需在下一轮重提的 fd（水平触发、多次触发请求结束）
+    std::thread::id _reactor;  // 调用 Wait 的线程
+    std::unordered_map<uint64_t, std::unique_ptr<SendOp>> _sends;
+    uint64_t _nextSend{0};
+    const __kernel_timespec _sendTimeout{SEND_TIMEOUT_S, 0};
+
+    std::vector<Event> _events;
+};
+
+} // namespace zener
+
+#endif // !ZENER_URING_POLLER_H
@@ -22,6 +22,8 @@
 #include <mutex>
 #include <mysql/mysql.h>
 #include <queue>
+#include <string>
+#include <vector>
 // #include <semaphore.h>
 // #include <boost/lockfree/queue.hpp>
 
@@ -29,6 +31,14 @@ namespace zener::db {
 
 static constexpr int SQL_CONN_SIZE = 8;
 
+// 一次查询的结果，NULL 值读作空串
+struct QueryResult {
+    bool ok{false};
+    std::string error;
+    std::vector<std::string> fields;
+    std::vector<std::vector<std::string>> rows;
+};
+
 class SqlConnector {
   public:
     [[nodiscard]] static SqlConnector& GetInstance();
@@ -48,6 +58,10 @@ class SqlConnector {
 
     size_t GetFreeConnCount() const;
 
+    // 取一个连接执行 SQL 并取回全部结果；会阻塞，只在 BLOCKING 通道上调用
+    // （协程处理函数里用 co_await http::Query(sql)）
+    QueryResult Query(const std::string& sql);
+
     static int GetPoolSize() { return _maxConnSize; }
 
   private:
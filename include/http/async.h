@@ -0,0 +1,141 @@
+#ifndef ZENER_HTTP_ASYNC_H
+#define ZENER_HTTP_ASYNC_H
+
+/*
+    协程处理函数：Task<void>(Context&)
+    - Conn 为每个请求创建一个 AsyncCall，持有 Context 和根任务，
+      在持有连接的工作线程上运行到第一次挂起；挂起期间连接照常交还，工作线程去处理别的连接
+    - 被等待的操作完成后（计时器在循环线程、数据库在 BLOCKING 通道）调用 Complete，
+      经事件循环派发连接，由持有连接的工作线程在 Process 里恢复协程
+    - 挂起前已写入的响应先发出；流式响应（ctx.Stream/SSE）配合 co_await Drained 做背压
+    - 挂起期间连接关闭：Detach 之后由完成的操作销毁协程帧
+    请求体在分发前已由 Request::parse 完整读入，直接用 ctx.Body()
+*/
+
+#include "database/sql_connector.h"
+#include "http/context.h"
+#include "http/response_stream.h"
+#include "http/router.h"
+#include "task/coro.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace zener::http {
+
+class AsyncCall final : public coro::Driver {
+  public:
+    struct Hooks {
+        // 操作完成：把 (fd, connId) 交给事件循环派发
+        std::function<void(int fd, uint64_t connId)> wake;
+        // ms 毫秒后在循环线程的计时器上回调
+        std::function<void(int ms, std::function<void()> fn)> after;
+        // 阻塞调用交给 BLOCKING 通道；队列满返回 false，排队超过期限被丢弃时调用 shed
+        std::function<bool(std::function<void()> run, std::function<void()> shed)>
+            offload;
+    };
+    // 由 Server 设置
+    static void SetHooks(Hooks h) { hooks = std::move(h); }
+    static const Hooks &GetHooks() { return hooks; }
+
+    AsyncCall(Request &req, Response &res, Buffer &out, int fd, uint64_t connId)
+        : _ctx(req, res, out), _fd(fd), _connId(connId) {}
+
+    // 以下由持有连接的工作线程调用
+    // 调用处理函数并运行到第一次挂起或结束
+    void Start(const AsyncHandlerFunc &handler);
+    // 挂起的操作已完成，等待恢复
+    [[nodiscard]] bool Ready() const;
+    void Resume();
+    [[nodiscard]] bool Done() const;
+    // 处理函数抛出了异常
+    [[nodiscard]] bool Failed() const { return _failed; }
+
+    // 连接关闭时循环线程调用，此时没有线程在执行协程
+    void Detach();
+
+    void Suspended(std::coroutine_handle<> handle) override;
+    void Complete() override;
+
+  private:
+    enum class State { RUNNING, SUSPENDED, READY, DONE };
+
+    // 执行协程直到下一次挂起，调用方不持有 _mtx
+    void run(std::coroutine_handle<> handle);
+
+    static Hooks hooks;
+
+    Context _ctx;
+    Task<void> _task;
+    const int _fd;
+    const uint64_t _connId;
+
+    mutable std::mutex _mtx;
+    State _state{State::RUNNING};
+    std::coroutine_handle<> _suspended; // 最内层的挂起点
+    bool _detached{false};
+    bool _failed{false};
+};
+
+// co_await Sleep(ms)：事件循环的计时器到期后恢复
+class Sleep {
+  public:
+    explicit Sleep(const int ms) : _ms(ms) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return _ms <= 0; }
+    template <typename P>
+    void await_suspend(const std::coroutine_handle<P> handle) const {
+        start(handle.promise().driver, handle);
+    }
+    void await_resume() const noexcept {}
+
+  private:
+    void start(coro::Driver *driver, std::coroutine_handle<> handle) const;
+
+    int _ms;
+};
+
+// co_await Query(sql)：在 BLOCKING 通道上执行，返回 db::QueryResult
+class Query {
+  public:
+    explicit Query(std::string sql) : _sql(std::move(sql)) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    template <typename P>
+    void await_suspend(const std::coroutine_handle<P> handle) {
+        start(handle.promise().driver, handle);
+    }
+    db::QueryResult await_resume() { return std::move(_result); }
+
+  private:
+    void start(coro::Driver *driver, std::coroutine_handle<> handle);
+
+    std::string _sql;
+    db::QueryResult _result;
+};
+
+// co_await Drained(stream)：流的缓冲区全部写进 socket（或连接关闭）后恢复，
+// 返回 false 表示连接已关闭
+class Drained {
+  public:
+    explicit Drained(ResponseStream &stream) : _stream(stream) {}
+
+    [[nodiscard]] bool await_ready() const { return _stream.Closed(); }
+    template <typename P>
+    void await_suspend(const std::coroutine_handle<P> handle) const {
+        start(handle.promise().driver, handle);
+    }
+    [[nodiscard]] bool await_resume() const { return !_stream.Closed(); }
+
+  private:
+    void start(coro::Driver *driver, std::coroutine_handle<> handle) const;
+
+    ResponseStream &_stream;
+};
+
+} // namespace zener::http
+
+#endif // !ZENER_HTTP_ASYNC_H
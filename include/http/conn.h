@@ -15,11 +15,26 @@
 #include "http/router.h"
 
 #include <arpa/inet.h> // sockaddr_in
-#include <cstdint>     // uint64_t
+#include <atomic>
+#include <chrono>
+#include <cstdint> // uint64_t
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <utility>
 
 namespace zener::http {
 
+class AsyncCall;
+class H2Session;
+namespace ws {
+class Outbox;
+class Session;
+} // namespace ws
+
 // TODO:
 // 现在的 Conn 存储 request 和 response , 感觉有点占空间
 // 可以修改为指针或者句柄
@@ -34,6 +49,25 @@ class Conn {
         ERROR           // 严重错误（需关闭连接）
     };
 
+    // 请求在线程池的哪条通道上处理，与 ThreadPool::Lane 对应
+    enum class Lane {
+        IO,      // 静态文件等，就在当前的 IO 工作线程里处理
+        NORMAL,  // 普通路由处理函数
+        BLOCKING // 标记为阻塞的路由
+    };
+
+    /*
+        连接的就绪/所有权状态（_ioState 的位）
+        fd 以 EPOLLIN|EPOLLOUT|EPOLLET|EPOLLRDHUP 只注册一次，之后不再 ModFd：
+        reactor 把就绪事件记到这里，只有把连接从空闲变为 IO_OWNED 的那次才派发任务；
+        持有连接的工作线程处理完后 Release，期间到达的事件由它自己接着处理
+    */
+    static constexpr uint32_t IO_READ = 1U;        // 可读（边缘）
+    static constexpr uint32_t IO_WRITE = 1U << 1;  // 可写（边缘）
+    static constexpr uint32_t IO_HUP = 1U << 2;    // 对端关闭或出错
+    static constexpr uint32_t IO_OWNED = 1U << 3;  // 有工作线程持有该连接
+    static constexpr uint32_t IO_WANT_WRITE = 1U << 4; // 有待发数据，关心可写
+
     Conn();
     ~Conn();
     Conn(const Conn &) = delete;
@@ -47,16 +81,114 @@ class Conn {
     void SetConnId(const uint64_t id) { _connId = id; }
     _ZENER_SHORT_FUNC uint64_t GetConnId() const { return _connId; }
 
+    // 网卡队列所在的 NUMA 节点（SO_INCOMING_CPU），-1 表示未知
+    void SetNode(const int node) { _node = node; }
+    _ZENER_SHORT_FUNC int GetNode() const { return _node; }
+
+    // 源 IP 在 ClientLimiter 表中的槽，-1 表示不受限
+    void SetLimiterSlot(const int slot) { _limiterSlot = slot; }
+    _ZENER_SHORT_FUNC int GetLimiterSlot() const { return _limiterSlot; }
+    // 关闭时交还，只交还一次
+    [[nodiscard]] int TakeLimiterSlot() { return std::exchange(_limiterSlot, -1); }
+
     void Close();
 
+    // reactor 调用：记录就绪事件，返回 true 表示取得所有权、需要派发任务
+    // 未关心可写时 IO_WRITE 被忽略（ET 下每次可读都会带上 EPOLLOUT）
+    [[nodiscard]] bool Notify(uint32_t ready);
+    // 以下由持有连接的工作线程调用
+    // 取走并清除已记录的就绪事件
+    [[nodiscard]] uint32_t TakeReady();
+    // 自己补记就绪事件（单次读写达到上限、socket 中可能还有数据时）
+    void MarkReady(const uint32_t ready) {
+        _ioState.fetch_or(ready, std::memory_order_acq_rel);
+    }
+    // 处理完毕：没有新的就绪事件则交还所有权并返回 true，否则调用方应继续处理
+    [[nodiscard]] bool Release();
+    // 须在写之前打开，否则 EAGAIN 之后到来的可写边缘可能被 Notify 丢弃
+    void WantWrite(const bool on) {
+        if (on) {
+            _ioState.fetch_or(IO_WANT_WRITE, std::memory_order_seq_cst);
+        } else {
+            _ioState.fetch_and(~IO_WANT_WRITE, std::memory_order_release);
+        }
+    }
+    // 循环线程调用：连接完全空闲（无人持有、无待发数据）时取得所有权
+    [[nodiscard]] bool TryAcquireIdle() {
+        uint32_t idle = 0;
+        return _ioState.compare_exchange_strong(idle, IO_OWNED,
+                                                std::memory_order_acq_rel);
+    }
+    // 至少完成过一次响应、且没有收到一半的请求：可以安全关闭的长连接
+    _ZENER_SHORT_FUNC bool BetweenRequests() const {
+        return _served > 0 && _readBuff.ReadableBytes() == 0 && !InFlight();
+    }
+    // 其他线程投递、还没取走的 WebSocket 帧、流式响应数据，
+    // 协程处理函数等待的操作已完成，或等待的缓存填充已完成（持有线程调用）
+    [[nodiscard]] bool HasQueued() const;
+    // 处理函数还没结束：流式响应未 End，协程处理函数挂起中，或在等缓存填充
+    _ZENER_SHORT_FUNC bool InFlight() const {
+        return _stream || _async || _flight;
+    }
+    // 循环线程调用：空闲超时时 WebSocket 连接先发一次 ping（放进发件箱），
+    // 返回 true 表示应再等一个超时周期；已探测过仍无数据则返回 false，按超时关闭
+    [[nodiscard]] bool ProbeIdle();
+    // 响应未写完时到来的可读事件先记下，写完后再读
+    void DeferRead() { _readDeferred = true; }
+    [[nodiscard]] bool TakeDeferredRead() {
+        return std::exchange(_readDeferred, false);
+    }
+
     _ZENER_SHORT_FUNC bool IsClosed() const { return _isClose; }
 
+    // 读写进度的截止时间（steady_clock 毫秒，0 表示没有），到期按超时关闭：
+    // 首部须在 headerTimeoutMS 内收全，正文和写出的速度不得低于 minBodyRate、
+    // minWriteRate 字节/秒（前 rateGraceMS 不计），写出也不能停顿超过 rateGraceMS。
+    // 由持有线程设置，循环线程读取
+    _ZENER_SHORT_FUNC int64_t Deadline() const {
+        return _deadline.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] static int64_t NowMs();
+    // 是否开启了任何一种截止时间
+    [[nodiscard]] static bool Deadlines() {
+        return headerTimeoutMS > 0 || minBodyRate > 0 || minWriteRate > 0;
+    }
+
     [[nodiscard]] ssize_t Read(int *saveErrno);
 
+    // 完成式 IO：循环线程把后端收到的数据、对端关闭放进收件箱，持有线程 Read 时取走。
+    // 返回 true 表示收件箱超过 INBOX_MAX，循环线程应暂停接收
+    [[nodiscard]] bool Deliver(std::string_view data, bool closed);
+    // 持有线程在 Read 之后调用：接收被暂停过，应请循环线程恢复
+    [[nodiscard]] bool RecvPaused();
+    // 循环线程调用：收件箱已被取走，清除暂停标记，返回 true 表示应恢复接收
+    [[nodiscard]] bool ResumeRecv();
+
     [[nodiscard]] ssize_t Write(int *saveErrno);
 
     [[nodiscard]] ProcessResult Process();
 
+    // 读缓冲区里有待处理的 HTTP/1.1 请求（不是 HTTP/2 帧、WebSocket 消息，
+    // 也不是上一个请求的处理函数还没结束）
+    _ZENER_SHORT_FUNC bool HasRequest() const {
+        return !_h2 && !_ws && !InFlight() && _readBuff.ReadableBytes() > 0;
+    }
+
+    // 只看读缓冲区中的请求行，判断该请求应在哪条通道上处理（不消费数据）
+    [[nodiscard]] Lane PickLane() const;
+    // 按路由判断请求的通道，path 须已规范化（HTTP/2 的流也用它）
+    [[nodiscard]] static Lane LaneOf(const std::string &method,
+                                     const std::string &path);
+
+    // 阻塞通道繁忙（503）或客户端超过请求速率（429）时直接回错误，并且不再复用连接
+    void RejectBusy(int code = 503);
+
+    // 按路由生成 HTTP/1.1 格式的响应：首部和处理函数的输出写入 buff，
+    // 静态文件留在 response 的映射里。HTTP/1.1 和 HTTP/2 的流共用
+    // 返回 false 表示没有产生响应，应断开（或重置流）
+    [[nodiscard]] static bool Render(Request &request, Response &response,
+                                     Buffer &buff, bool keepAlive);
+
     // 需要写出的字节数
     _ZENER_SHORT_FUNC size_t ToWriteBytes() const {
         return _iov[0].iov_len + _iov[1].iov_len;
@@ -72,16 +204,70 @@ class Conn {
 
     _ZENER_SHORT_FUNC sockaddr_in GetAddr() const { return _addr; }
 
-    _ZENER_SHORT_FUNC bool IsKeepAlive() const {
-        return _request.IsKeepAlive();
-    }
+    // 排空（draining）和过载（shedding）期间一律不再复用连接，响应带 Connection: close
+    // HTTP/2 连接在发出 GOAWAY、在途的流都完成后才关闭，WebSocket 在发出关闭帧后关闭
+    [[nodiscard]] bool IsKeepAlive() const;
 
     static bool isET;             // 是否为边缘触发
     static const char *staticDir; // 请求文件对应的根目录
     static std::atomic<int> userCount;
+    static std::atomic<bool> draining; // 服务器正在排空连接
+    static std::atomic<bool> shedding; // 服务器过载，响应不再保持长连接
     static const Router* router;  // optional; set by Server to enable routing
+    static bool enableH2c;        // 是否接受明文 HTTP/2（prior knowledge 与 Upgrade: h2c）
+    static int headerTimeoutMS;   // 收全请求首部的时限，0 表示不限
+    static int minBodyRate;       // 正文的最低接收速度（字节/秒），0 表示不限
+    static int minWriteRate;      // 响应的最低写出速度（字节/秒），0 表示不限
+    static int rateGraceMS;       // 速度检查前的宽限时间，也是写出无进展时最长的等待
+    // 请求准入，由 Server 设置：参数为连接的限速槽，返回 0 放行，否则为拒绝的状态码。
+    // HTTP/1.1 请求由 Server 在派发前检查；HTTP/2 的每个新流、WebSocket 的每条消息
+    // 由持有连接的线程在交给处理函数前检查
+    static std::function<int(int limiterSlot)> admit;
+    // 完成式 IO 的发送，由 Server 设置为事件后端的 Send；非空时 Write 交给它发送，
+    // Read 从收件箱取数据，为空时直接 readv/writev
+    static std::function<ssize_t(int fd, const iovec *iov, int iovCnt)> sender;
+    // 把 HTTP/2 流的处理函数交给 NORMAL/BLOCKING 通道，由 Server 设置。
+    // run 或 shed（排队超过截止时间）执行后唤醒连接 (fd, connId)；
+    // 通道积压到上限时返回 false，两者都不会执行
+    static std::function<bool(Lane lane, int fd, uint64_t connId,
+                              std::function<void()> run,
+                              std::function<void()> shed)>
+        offload;
 
   private:
+    ProcessResult process();
+    // 完成式 IO 的 Read：把收件箱整个搬进读缓冲区
+    ssize_t readInbox(int *saveErrno);
+    // 跳过请求之间多余的空行，检查开头的请求是否已收全并更新截止时间
+    Request::Framing frame();
+    // 首部或正文超过上限：回 431/413 并关闭连接
+    ProcessResult rejectTooLarge(Request::Framing framing);
+    // 进入新的阶段时记下开始时间
+    void enterPhase(uint8_t phase);
+    void setDeadline(int64_t deadline) {
+        _deadline.store(deadline, std::memory_order_relaxed);
+    }
+    ProcessResult processH2();
+    ProcessResult processWs();
+    ProcessResult processStream();
+    // 协程处理函数：运行到第一次挂起，之后每次等待的操作完成时恢复
+    ProcessResult startAsync(const AsyncHandlerFunc &handler);
+    ProcessResult processAsync();
+    // 开启了缓存的路由：命中直接回放，未命中时领头执行处理函数或登记等待
+    ProcessResult renderCached(const CachePolicy &policy);
+    ProcessResult processCacheWait();
+    // 接管处理函数开启的流式响应（HEAD 请求直接丢弃）
+    void adoptStream();
+    // 把流中缓冲的数据编成一个 chunk 追加到写缓冲区，流结束时连同结束块一起
+    void takeChunk();
+    // RFC 6455 握手：回 101 并把连接交给 ws::Session
+    ProcessResult upgradeWebSocket(const ws::Handlers &handlers);
+    // 把 _writeBuff 和静态文件映射（或命中的缓存响应）设置为待写出的分散写区域
+    void setIov();
+    // 从待写出的状态行取出状态码，响应写完后记录访问日志；流式响应在结束块写完后记录
+    void noteResponse();
+    void recordAccess();
+
     int _fd;
     struct sockaddr_in _addr{};
     uint64_t _connId{
@@ -91,6 +277,11 @@ class Conn {
         不仅代表是否关闭，也代表是否完成 init
     */
     bool _isClose{}; //
+    int _node{-1};
+    int _limiterSlot{-1};
+    std::atomic<uint32_t> _ioState{0};
+    bool _readDeferred{false}; // 只由持有连接的工作线程读写
+    uint32_t _served{0};       // 已完成的响应数
 
     int _iovCnt{}; // TODO 检查赋值，是否用到？
     struct iovec _iov[2]{};
@@ -98,8 +289,38 @@ class Conn {
     Buffer _readBuff;  // 读缓冲区
     Buffer _writeBuff; // 写缓冲区
 
+    // 完成式 IO 的收件箱：收件箱超过上限时暂停接收，相当于 socket 接收缓冲区满了
+    static constexpr size_t INBOX_MAX = 256 * 1024;
+    std::mutex _inboxMtx;
+    Buffer _inbox;
+    bool _inboxClosed{false}; // 对端已关闭或出错，收件箱取空后 Read 返回 0
+    bool _recvPaused{false};
+
     Request _request;
     Response _response;
+    std::unique_ptr<H2Session> _h2; // 升级为 HTTP/2 后非空
+    std::unique_ptr<ws::Session> _ws; // 升级为 WebSocket 后非空
+    // 与 _ws 的发件箱相同，供循环线程在不碰 _ws 的情况下投递（只在循环线程上重置）
+    std::atomic<ws::Outbox *> _outbox{nullptr};
+    std::shared_ptr<ResponseStream> _stream; // 流式响应未结束时非空
+    std::shared_ptr<AsyncCall> _async;       // 协程处理函数未结束时非空
+    std::shared_ptr<CacheFlight> _flight;    // 等待其他请求填充缓存时非空
+    std::shared_ptr<const CachedResponse> _cached; // 正在写出的缓存响应
+
+    // 截止时间所属的阶段，见 Deadline
+    static constexpr uint8_t PHASE_NONE = 0;
+    static constexpr uint8_t PHASE_HEAD = 1;
+    static constexpr uint8_t PHASE_BODY = 2;
+    static constexpr uint8_t PHASE_WRITE = 3;
+    std::atomic<int64_t> _deadline{0};
+    uint8_t _phase{PHASE_NONE};
+    int64_t _phaseStart{0};  // 阶段开始的时间（毫秒）
+    size_t _phaseBytes{0};   // 写阶段已写出的字节数
+
+    // 访问日志：本次请求的开始时间、状态码和响应大小，_status 为 0 表示无待记录请求
+    std::chrono::steady_clock::time_point _reqStart{};
+    int _status{0};
+    size_t _respBytes{0};
 };
 
 } // namespace zener::http
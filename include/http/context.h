@@ -4,8 +4,10 @@
 #include "buffer/buffer.h"
 #include "request.h"
 #include "response.h"
+#include "response_stream.h"
 
 #include <any>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -21,6 +23,7 @@ class Context {
     const std::string& Path() const { return _req.Path(); }
     std::string Method() const { return _req.Method(); }
     std::string GetPost(const std::string& key) const { return _req.GetPost(key); }
+    const std::string& Body() const { return _req.Body(); }
 
     // ---- Typed key-value store ----
     template <typename T>
@@ -53,6 +56,18 @@ class Context {
         _res.Json(_writeBuff, json);
     }
 
+    // Chunked response: headers go out now, the body is written through the
+    // stream (from any thread) after the handler returns. Call End() to finish.
+    std::shared_ptr<ResponseStream> Stream(
+        const std::string& contentType = "text/plain") {
+        return _res.BeginStream(_writeBuff, contentType, false);
+    }
+
+    // Server-Sent Events (text/event-stream) over a chunked stream
+    std::shared_ptr<ResponseStream> SSE() {
+        return _res.BeginStream(_writeBuff, "text/event-stream", true);
+    }
+
     void Redirect(const std::string& location) {
         _res.Status(302);
         _res.Send(_writeBuff, "");  // empty body; Location header added below
@@ -0,0 +1,167 @@
+#ifndef ZENER_HTTP_H2_SESSION_H
+#define ZENER_HTTP_H2_SESSION_H
+
+/*
+    明文 HTTP/2（h2c，RFC 9113）会话，挂在 Conn 上，由持有连接的工作线程驱动
+    - 两种进入方式：连接以前言 "PRI * HTTP/2.0..." 开头（prior knowledge），
+      或 HTTP/1.1 请求带 Upgrade: h2c，回 101 后原请求作为流 1
+    - Feed 从读缓冲区按帧消费，流的请求收全（END_STREAM）后交给 Router，
+      处理函数仍写 HTTP/1.1 格式的响应，这里再转成 HEADERS/DATA 帧
+    - 静态文件在当前工作线程处理；有处理函数的流与 HTTP/1.1 一样按路由交给
+      NORMAL/BLOCKING 通道（Conn::offload），不阻塞连接上的其他流，
+      处理完唤醒连接，由下一次 Feed 发出响应；通道积压时以 REFUSED_STREAM 重置
+    - 发送方向遵守连接级和流级窗口；窗口不够的 DATA 留在流里，
+      收到 WINDOW_UPDATE 或写完一批后再发
+    - 多个流同时有数据时按优先级发送：先看 priority 首部的 urgency（RFC 9218），
+      再看 PRIORITY 帧/HEADERS 里的权重，最后按流 ID
+    - 每个新流在交给 Router 前经 Conn::admit 准入（与 HTTP/1.1 请求共用源 IP 的
+      令牌桶和过载丢弃），超速时在该流上回 429，过载丢弃时以 REFUSED_STREAM 重置
+    - 首部和正文沿用 HTTP/1.1 的上限（Request::maxHeaderBytes 等），
+      超过时在该流上回 431/413，不影响连接上的其他流
+    不支持服务端推送；依赖树（RFC 7540 已废弃）只取权重；
+    协程处理函数和流式响应（ResponseStream）在 HTTP/2 上回 501
+*/
+
+#include "buffer/buffer.h"
+#include "http/hpack.h"
+#include "http/request.h"
+#include "http/response.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zener::http {
+
+class H2Session {
+  public:
+    // 错误码（RFC 9113 第 7 节）
+    enum ErrorCode : uint32_t {
+        NO_ERROR = 0x0,
+        PROTOCOL_ERROR = 0x1,
+        INTERNAL_ERROR = 0x2,
+        FLOW_CONTROL_ERROR = 0x3,
+        STREAM_CLOSED = 0x5,
+        FRAME_SIZE_ERROR = 0x6,
+        REFUSED_STREAM = 0x7,
+        COMPRESSION_ERROR = 0x9,
+        ENHANCE_YOUR_CALM = 0xb,
+    };
+
+    enum class Preface { MATCH, PARTIAL, MISMATCH };
+
+    static constexpr std::string_view PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+    // 只看读缓冲区开头，不消费数据
+    [[nodiscard]] static Preface CheckPreface(const Buffer &buff);
+
+    // limiterSlot 为连接在 ClientLimiter 中的槽，交给 Conn::admit；
+    // fd 和 connId 用于流在其他线程处理完后唤醒连接
+    H2Session(int fd, uint64_t connId, int limiterSlot);
+
+    // prior knowledge：发出服务端 SETTINGS，前言由 Feed 消费
+    void Start(Buffer &out);
+    // Upgrade: h2c：HTTP2-Settings 不合法时返回 false 且不写任何数据，按 HTTP/1.1 处理
+    // 成功则写出 101、服务端 SETTINGS 和流 1 的响应
+    [[nodiscard]] bool Upgrade(const std::string &settings, Request &req,
+                               Buffer &out);
+    // 消费 in 中所有完整的帧，发出已处理完的流的响应，产生的帧追加到 out
+    void Feed(Buffer &in, Buffer &out);
+    // 有流在通道里处理完、等待 Feed 发出响应（持有线程调用）
+    [[nodiscard]] bool HasDone() const;
+    // 不再接受新流，已经在处理的流继续完成
+    void GoAway(Buffer &out, uint32_t code = NO_ERROR);
+
+    // 连接级错误，或任一方已 GOAWAY 且没有未完成的流
+    [[nodiscard]] bool Closing() const {
+        return _closed || ((_goAwaySent || _goAwayRecv) && _streams.empty());
+    }
+
+    static uint32_t maxStreams; // 通告的 SETTINGS_MAX_CONCURRENT_STREAMS
+
+  private:
+    struct Job; // 交给通道处理的请求及其结果
+
+    struct Stream {
+        bool endRemote{false}; // 对端已 END_STREAM，请求收全
+        int64_t sendWindow{0};
+        int64_t recvWindow{0};
+        uint8_t urgency{3}; // RFC 9218，0 最高
+        uint16_t weight{16};
+        std::vector<hpack::HeaderField> headers;
+        std::string body;  // 请求体
+        std::string out;   // 待发送的响应体
+        size_t sent{0};
+        bool responding{false}; // HEADERS 已发出
+        std::shared_ptr<Job> job; // 非空表示处理函数在通道里执行，尚未取回
+    };
+
+    void onFrame(uint8_t type, uint8_t flags, uint32_t streamId,
+                 const uint8_t *payload, size_t len, Buffer &out);
+    void onHeaders(uint8_t flags, uint32_t streamId, const uint8_t *payload,
+                   size_t len, Buffer &out);
+    void onHeaderBlock(Buffer &out);
+    void onData(uint8_t flags, uint32_t streamId, const uint8_t *payload,
+                size_t len, Buffer &out);
+    void onSettings(uint8_t flags, uint32_t streamId, const uint8_t *payload,
+                    size_t len, Buffer &out);
+    void onWindowUpdate(uint32_t streamId, const uint8_t *payload, size_t len,
+                        Buffer &out);
+    // 返回错误码，0 表示成功
+    uint32_t applySettings(const uint8_t *payload, size_t len);
+
+    // 请求收全：组装 Request 交给 Router，有处理函数的交给通道
+    void dispatch(uint32_t streamId, Buffer &out);
+    // 在当前线程生成响应并发出 HEADERS
+    void respond(uint32_t streamId, Stream &stream, Request &req, Buffer &out);
+    // 把已生成的 HTTP/1.1 格式响应转成 HEADERS，响应体留给 flush
+    void reply(uint32_t streamId, Stream &stream, const Request &req,
+               Response &response, Buffer &head,
+               std::chrono::steady_clock::time_point start, Buffer &out);
+    // 发出通道里已处理完的流的响应
+    void collect(Buffer &out);
+    // 按优先级和窗口发送待发的 DATA
+    void flush(Buffer &out);
+
+    // 不经过路由直接回一个没有正文的响应（413/429/431），流随之关闭
+    void reject(uint32_t streamId, int status, Buffer &out);
+    void connError(uint32_t code, Buffer &out);
+    void streamError(uint32_t streamId, uint32_t code, Buffer &out);
+
+    int _fd;
+    uint64_t _connId;
+    int _limiterSlot;
+    bool _prefaceDone{false};
+    bool _settingsSeen{false};
+    bool _closed{false};
+    bool _goAwaySent{false};
+    bool _goAwayRecv{false};
+
+    uint32_t _lastStreamId{0};
+    std::map<uint32_t, Stream> _streams;
+
+    // 对端的设置
+    int64_t _peerInitialWindow{65535};
+    uint32_t _peerMaxFrame{16384};
+
+    int64_t _connSendWindow{65535};
+    int64_t _connRecvWindow{65535};
+    size_t _recvConsumed{0}; // 本轮收到、待通过 WINDOW_UPDATE 归还的字节
+
+    // 未结束的首部块（HEADERS + CONTINUATION）
+    uint32_t _headerStream{0};
+    uint8_t _headerFlags{0};
+    uint16_t _headerWeight{0}; // 0 表示 HEADERS 未带优先级
+    std::string _headerBlock;
+
+    hpack::Decoder _decoder;
+    hpack::Encoder _encoder;
+};
+
+} // namespace zener::http
+
+#endif // !ZENER_HTTP_H2_SESSION_H
@@ -0,0 +1,94 @@
+#ifndef ZENER_HTTP_HPACK_H
+#define ZENER_HTTP_HPACK_H
+
+/*
+    HPACK（RFC 7541）首部压缩
+    - 静态表 61 项 + 每条连接各自的动态表（编码、解码方向各一张，互不影响）
+    - 解码：索引、带/不带索引的字面量、动态表大小更新，字符串支持 Huffman
+    - 编码：完全命中静态/动态表时只发索引；其余按名字索引发字面量，
+      短小且会重复出现的值加入动态表，content-length 这类每次都变的值不入表
+    编码输出不做 Huffman 压缩（响应首部以短值为主，收益有限）
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace zener::http::hpack {
+
+struct HeaderField {
+    std::string name;
+    std::string value;
+};
+
+// 动态表：新条目在队首，索引从静态表之后（62）开始
+class DynamicTable {
+  public:
+    explicit DynamicTable(size_t maxSize = DEFAULT_TABLE_SIZE)
+        : _maxSize(maxSize) {}
+
+    void Add(HeaderField field);
+    void SetMaxSize(size_t maxSize);
+    // index 为 HPACK 全局索引（1 起），越界返回 nullptr
+    [[nodiscard]] const HeaderField *Get(size_t index) const;
+    // 返回完全匹配的全局索引，只匹配名字时写入 nameIndex，找不到返回 0
+    [[nodiscard]] size_t Find(const std::string &name,
+                              const std::string &value,
+                              size_t *nameIndex) const;
+
+    [[nodiscard]] size_t MaxSize() const { return _maxSize; }
+
+    static constexpr size_t DEFAULT_TABLE_SIZE = 4096;
+
+  private:
+    void evict(size_t need);
+
+    std::deque<HeaderField> _entries;
+    size_t _size{0}; // 按 RFC 计算：name + value + 32
+    size_t _maxSize;
+};
+
+class Decoder {
+  public:
+    enum class Result {
+        OK,
+        TOO_LARGE, // 超过 maxListSize：整块仍已解码（动态表保持同步），out 为空
+        ERROR,     // COMPRESSION_ERROR，连接不可再用
+    };
+
+    // 解码一个完整的首部块，首部列表按 HTTP/1.1 首部行（name: value\r\n）计算大小
+    [[nodiscard]] Result Decode(const uint8_t *data, size_t len,
+                                std::vector<HeaderField> &out,
+                                size_t maxListSize);
+    // 本端通告的 SETTINGS_HEADER_TABLE_SIZE，对端的大小更新不得超过它
+    void SetMaxTableSize(const size_t size) { _limit = size; }
+
+  private:
+    DynamicTable _table;
+    size_t _limit{DynamicTable::DEFAULT_TABLE_SIZE};
+};
+
+class Encoder {
+  public:
+    void Encode(const std::vector<HeaderField> &fields, std::string &out);
+    // 对端通告的 SETTINGS_HEADER_TABLE_SIZE，下一个首部块开头发出大小更新
+    void SetMaxTableSize(size_t size);
+
+  private:
+    DynamicTable _table;
+    bool _sizeUpdate{false};
+};
+
+// 以下供帧层复用
+void EncodeInt(uint64_t value, int prefixBits, uint8_t firstByte,
+               std::string &out);
+[[nodiscard]] bool DecodeInt(const uint8_t *&p, const uint8_t *end,
+                             int prefixBits, uint64_t &value);
+[[nodiscard]] bool HuffmanDecode(const uint8_t *data, size_t len,
+                                 std::string &out);
+
+} // namespace zener::http::hpack
+
+#endif // !ZENER_HTTP_HPACK_H
@@ -37,6 +37,15 @@ class Request {
         CLOSED_CONNECTION,
     };
 
+    // 读缓冲区开头的请求收到了多少，见 Frame
+    enum class Framing {
+        PARTIAL_HEAD,   // 首部还没收全
+        PARTIAL_BODY,   // 首部已收全，正文不足 Content-Length
+        COMPLETE,       // 首部和正文都已收全，可以 parse
+        HEAD_TOO_LARGE, // 首部超过 maxHeaderBytes 或首部行数超过 maxHeaders（431）
+        BODY_TOO_LARGE, // Content-Length 超过 maxBodyBytes（413）
+    };
+
     // 初始化无所谓，在Init中
     Request() : _state(REQUEST_LINE) { Init(); }
     ~Request() = default;
@@ -47,8 +56,18 @@ class Request {
     Request& operator=(Request&&) = default;
 
     void Init();
+    // 调用方须先用 Frame 确认请求已完整：正文按 Content-Length 截取，
+    // 之后的字节留在 buff 里，属于流水线上的下一个请求
     [[nodiscard]] bool parse(Buffer& buff);
 
+    // 不消费数据，只看 data 开头的一个请求；PARTIAL_BODY 时 bodyBytes 为已收到的正文字节数
+    [[nodiscard]] static Framing Frame(const char* data, size_t len,
+                                       size_t& bodyBytes);
+
+    static size_t maxHeaderBytes; // 请求行加首部的字节数上限
+    static size_t maxHeaders;     // 首部行数上限
+    static size_t maxBodyBytes;   // Content-Length 上限
+
     _ZENER_SHORT_FUNC std::string Path() const { return _path; }
     _ZENER_SHORT_FUNC std::string& Path() { return _path; }
 
@@ -56,15 +75,26 @@ class Request {
     std::string Version() const;
     std::string GetPost(const std::string& key) const;
     std::string GetPost(const char* key) const;
+    // 按首部名原样查找（HTTP/2 的首部已转换为 Content-Type 这种写法），不存在返回空串
+    std::string GetHeader(const std::string& key) const;
+    _ZENER_SHORT_FUNC const std::string& Body() const { return _body; }
+
+    // HTTP/2 流：由解码后的首部直接组装请求，不经过文本解析
+    void Assign(std::string method, std::string path,
+                std::unordered_map<std::string, std::string> header,
+                std::string body);
 
     [[nodiscard]] bool IsKeepAlive() const;
 
     static bool UserVerify(const std::string& name, const std::string& pwd,
                            bool isLogin);
 
+    // 与 parsePath 相同的路径映射（"/" → "/index.html"，"/login" → "/login.html"）
+    static std::string CanonicalPath(std::string path);
+
   private:
     bool parseRequestLine(const std::string& line);
-    void parseHeader(const std::string& line);
+    [[nodiscard]] bool parseHeader(const std::string& line);
     void parseBody(const std::string& line);
 
     void parsePath();
@@ -72,6 +102,7 @@ class Request {
     void parseFromUrlencoded();
 
     PARSE_STATE _state;
+    size_t _contentLength{0};
     std::string _method, _path, _version, _body;
     std::unordered_map<std::string, std::string> _header;
     std::unordered_map<std::string, std::string> _post;
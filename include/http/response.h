@@ -3,12 +3,15 @@
 
 #include "buffer/buffer.h"
 
+#include <memory>
 #include <string>
 #include <sys/stat.h>
 #include <unordered_map>
 
 namespace zener::http {
 
+class ResponseStream;
+
 class Response {
   public:
     Response();
@@ -39,6 +42,13 @@ class Response {
     // Write JSON body and finalize
     void Json(Buffer& buff, const std::string& json);
 
+    // Write status line and chunked headers; the body follows through the
+    // returned stream, which the connection picks up after the handler returns
+    std::shared_ptr<ResponseStream> BeginStream(Buffer& buff,
+                                                const std::string& contentType,
+                                                bool eventStream);
+    std::shared_ptr<ResponseStream> TakeStream() { return std::move(_stream); }
+
   private:
     void addStateLine(Buffer& buff);
     void addHeader(Buffer& buff) const;
@@ -51,6 +61,7 @@ class Response {
     int _code;
     bool _isKeepAlive;
     bool _handled{false}; // set to true when a route handler writes the response
+    std::shared_ptr<ResponseStream> _stream; // set by BeginStream until taken
 
     std::string _path;
     std::string _staticDir;
@@ -0,0 +1,108 @@
+#ifndef ZENER_HTTP_RESPONSE_CACHE_H
+#define ZENER_HTTP_RESPONSE_CACHE_H
+
+/*
+    路由级响应缓存（按路由开启，见 Router::Cache）
+    - 键：方法 + 路径 + 策略里列出的请求头 + 是否长连接（两者的 Connection 首部不同）
+    - 值：处理函数写出的完整 HTTP/1.1 响应（状态行、首部和正文），
+      命中时 Conn 把它直接挂到分散写的第二段，不拷贝进写缓冲区
+    - 单飞：同一个键未命中时只有第一个请求执行处理函数，其余请求登记在
+      CacheFlight 上后交还连接，不占工作线程；结果出来后经事件循环唤醒
+    - 条目到 TTL 过期，总大小超过上限时按最近最少使用淘汰
+    只缓存处理函数返回的 200 非流式响应；HTTP/2 的流不查缓存
+*/
+
+#include "http/request.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace zener::http {
+
+struct CachePolicy {
+    int ttlMs{1000};
+    std::vector<std::string> vary; // 参与缓存键的请求头，如 Accept-Encoding
+    size_t maxEntryBytes{256 * 1024}; // 更大的响应不缓存
+};
+
+struct CachedResponse {
+    std::string data; // 完整的响应报文
+    std::chrono::steady_clock::time_point expires;
+};
+
+// 一次未命中的填充：等待者持有它，done 之后读取 result
+struct CacheFlight {
+    std::atomic<bool> done{false};
+    // 为空表示领头请求没有产生可缓存的响应，等待者自己执行处理函数
+    std::shared_ptr<const CachedResponse> result;
+    std::vector<std::pair<int, uint64_t>> waiters; // (fd, connId)，受缓存的锁保护
+};
+
+class ResponseCache {
+  public:
+    using Waker = std::function<void(int fd, uint64_t connId)>;
+
+    enum class Lookup {
+        HIT,  // entry 为命中的响应
+        LEAD, // 调用方执行处理函数，之后必须调用 Fill
+        WAIT, // 已登记到 flight 上，填充完成后唤醒 (fd, connId)
+    };
+
+    static ResponseCache &GetInstance() {
+        static ResponseCache instance;
+        return instance;
+    }
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    // 由 Server 设置
+    void SetWaker(Waker waker) { _waker = std::move(waker); }
+    void SetCapacity(size_t bytes);
+
+    [[nodiscard]] static std::string Key(const Request &request,
+                                         const CachePolicy &policy,
+                                         bool keepAlive);
+
+    Lookup Find(const std::string &key, int fd, uint64_t connId,
+                std::shared_ptr<const CachedResponse> &entry,
+                std::shared_ptr<CacheFlight> &flight);
+    // 结束 key 上的填充：response 非空则存入，然后唤醒等待者
+    void Fill(const std::string &key,
+              std::shared_ptr<const CachedResponse> response);
+
+    [[nodiscard]] size_t Bytes() const;
+    [[nodiscard]] size_t Size() const;
+
+  private:
+    ResponseCache() = default;
+    ~ResponseCache() = default;
+
+    struct Slot {
+        std::shared_ptr<const CachedResponse> response;
+        std::list<std::string>::iterator lru;
+    };
+
+    void evictLocked(); // 超过容量时从最久未用的一端淘汰
+    void eraseLocked(std::unordered_map<std::string, Slot>::iterator it);
+
+    mutable std::mutex _mtx;
+    std::unordered_map<std::string, Slot> _entries;
+    std::list<std::string> _lru; // 头部为最近使用
+    std::unordered_map<std::string, std::shared_ptr<CacheFlight>> _flights;
+    size_t _bytes{0};
+    size_t _capacity{16 << 20};
+    Waker _waker;
+};
+
+} // namespace zener::http
+
+#endif // !ZENER_HTTP_RESPONSE_CACHE_H
@@ -0,0 +1,88 @@
+#ifndef ZENER_HTTP_RESPONSE_STREAM_H
+#define ZENER_HTTP_RESPONSE_STREAM_H
+
+/*
+    流式响应（Transfer-Encoding: chunked / Server-Sent Events）
+    - 处理函数调用 Context::Stream()/SSE() 先写出首部，拿到的 ResponseStream
+      可以在处理函数返回后继续写，包括在其他线程里写
+    - Write 只追加到流自己的缓冲区；Flush（或缓冲超过 FLUSH_BYTES）时通过事件循环
+      唤醒连接，由持有连接的工作线程一次取走全部数据，编成一个 chunk 写出
+    - 背压：缓冲区达到 HIGH_WATER 后 Write 返回 false（数据仍保留），生产者应暂停；
+      OnWritable 在缓冲区已全部写进 socket 时由工作线程回调，适合按需生成的大报表
+    - socket 写满时工作线程直接交还连接，可写边缘到来后再继续，不占用线程
+    HTTP/2 的流上没有可写事件驱动，流式响应回 501，流被 Detach
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace zener::http {
+
+class ResponseStream {
+  public:
+    using Waker = std::function<void(int fd, uint64_t connId)>;
+    // 由 Server 设置，把 (fd, connId) 交给事件循环派发可写
+    static void SetWaker(Waker fn) { waker = std::move(fn); }
+
+    ResponseStream() = default;
+
+    ResponseStream(const ResponseStream &) = delete;
+    ResponseStream &operator=(const ResponseStream &) = delete;
+
+    // 以下任意线程可调用，连接已关闭时返回 false 并丢弃数据
+    // 返回 false 也可能只是缓冲区已满（见 Closed），此时应等 OnWritable
+    bool Write(std::string_view data);
+    // SSE 事件：多行数据拆成多个 data: 行，写完立即 Flush
+    bool Event(std::string_view data, std::string_view event = {},
+               std::string_view id = {});
+    // SSE 注释行，用作心跳，避免空闲超时
+    bool Comment(std::string_view text = {});
+    void Flush();
+    // 写出结束块，之后连接可以继续处理下一个请求
+    void End();
+
+    // 缓冲区已全部写进 socket 且流未结束时回调，在持有连接的工作线程中执行
+    // 回调里可以换成别的回调，传 nullptr 则不再回调
+    void OnWritable(std::function<void(ResponseStream &)> fn);
+
+    [[nodiscard]] bool Closed() const;
+    [[nodiscard]] size_t Buffered() const;
+
+    // 以下由 Conn 调用
+    // 首部已排进写缓冲区，之后的 Flush 需要唤醒连接
+    void Attach(int fd, uint64_t connId);
+    // 取走缓冲的数据（为空时先回调 OnWritable），返回 true 表示流已结束
+    bool Take(std::string &out);
+    // 有数据待取、或流已结束、或还能按需生成
+    [[nodiscard]] bool Ready() const;
+    // 连接关闭或流已结束：之后的写入一律失败，释放回调（它可能持有本对象）
+    void Detach();
+
+    static constexpr size_t FLUSH_BYTES = 16 * 1024;
+    static constexpr size_t HIGH_WATER = 1 << 20;
+
+  private:
+    // 调用方持有 _mtx
+    void wakeLocked();
+
+    static Waker waker;
+
+    mutable std::mutex _mtx;
+    std::string _pending;
+    std::function<void(ResponseStream &)> _onWritable;
+    uint64_t _writableGen{0}; // 每次 OnWritable 加一
+    int _fd{-1};
+    uint64_t _connId{0};
+    bool _attached{false};
+    bool _wakePending{false}; // 已唤醒、连接还没取走
+    bool _ended{false};
+    bool _closed{false};
+};
+
+} // namespace zener::http
+
+#endif // !ZENER_HTTP_RESPONSE_STREAM_H
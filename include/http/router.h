@@ -2,18 +2,24 @@
 #define ZENER_HTTP_ROUTER_H
 
 #include "http/context.h"
+#include "http/response_cache.h"
+#include "http/websocket.h"
+#include "task/coro.h"
 
 #include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace zener::http {
 
 using HandlerFunc = std::function<void(Context&)>;
+// Coroutine handler, see http/async.h
+using AsyncHandlerFunc = std::function<Task<void>(Context&)>;
 
 struct DispatchResult {
-    enum class Kind { None, Handler, StaticFile };
+    enum class Kind { None, Handler, StaticFile, Async };
     Kind kind{Kind::None};
     std::string fsRoot;       // only set for StaticFile
     std::string relativePath; // only set for StaticFile
@@ -21,8 +27,27 @@ struct DispatchResult {
 
 class Router {
   public:
-    void Add(const std::string& method, const std::string& path, HandlerFunc handler) {
-        _routes[routeKey(method, path)] = std::move(handler);
+    // blocking: the handler does DB/filesystem work and runs on the thread
+    // pool's blocking lane instead of the I/O workers.
+    void Add(const std::string& method, const std::string& path, HandlerFunc handler,
+             bool blocking = false) {
+        const std::string key = routeKey(method, path);
+        _routes[key] = std::move(handler);
+        if (blocking) {
+            _blockingRoutes.insert(key);
+        } else {
+            _blockingRoutes.erase(key);
+        }
+    }
+
+    bool IsBlocking(const std::string& method, const std::string& path) const {
+        return !_blockingRoutes.empty() &&
+               _blockingRoutes.count(routeKey(method, path)) > 0;
+    }
+
+    // Whether an exact (synchronous) handler is registered for method + path
+    bool HasHandler(const std::string& method, const std::string& path) const {
+        return !_routes.empty() && _routes.count(routeKey(method, path)) > 0;
     }
 
     // Mount a filesystem directory at a URL prefix.
@@ -31,6 +56,45 @@ class Router {
         _staticMounts.push_back({urlPrefix, fsRoot});
     }
 
+    // Coroutine handler: suspends on co_await without holding a worker.
+    // Only HTTP/1.1 connections drive them; see Conn::startAsync.
+    void AddAsync(const std::string& method, const std::string& path,
+                  AsyncHandlerFunc handler) {
+        _asyncRoutes[routeKey(method, path)] = std::move(handler);
+    }
+
+    const AsyncHandlerFunc* FindAsync(const std::string& method,
+                                      const std::string& path) const {
+        if (_asyncRoutes.empty()) return nullptr;
+        auto it = _asyncRoutes.find(routeKey(method, path));
+        return it == _asyncRoutes.end() ? nullptr : &it->second;
+    }
+
+    // Cache the handler's response for policy.ttlMs; concurrent misses on the
+    // same key run the handler once. See http/response_cache.h.
+    void Cache(const std::string& method, const std::string& path,
+               CachePolicy policy) {
+        _cachedRoutes[routeKey(method, path)] = std::move(policy);
+    }
+
+    const CachePolicy* FindCache(const std::string& method,
+                                 const std::string& path) const {
+        if (_cachedRoutes.empty()) return nullptr;
+        auto it = _cachedRoutes.find(routeKey(method, path));
+        return it == _cachedRoutes.end() ? nullptr : &it->second;
+    }
+
+    // A GET to path with Upgrade: websocket switches the connection to a ws::Session
+    void WebSocket(const std::string& path, ws::Handlers handlers) {
+        _wsRoutes[path] = std::move(handlers);
+    }
+
+    const ws::Handlers* FindWebSocket(const std::string& path) const {
+        if (_wsRoutes.empty()) return nullptr;
+        auto it = _wsRoutes.find(path);
+        return it == _wsRoutes.end() ? nullptr : &it->second;
+    }
+
     DispatchResult Dispatch(Context& ctx) const {
         // 1. exact route match
         auto it = _routes.find(routeKey(ctx.Method(), ctx.Path()));
@@ -38,6 +102,9 @@ class Router {
             it->second(ctx);
             return {DispatchResult::Kind::Handler, {}, {}};
         }
+        if (FindAsync(ctx.Method(), ctx.Path())) {
+            return {DispatchResult::Kind::Async, {}, {}};
+        }
 
         // 2. static prefix match (GET only)
         if (ctx.Method() == "GET") {
@@ -65,6 +132,10 @@ class Router {
     }
 
     std::unordered_map<std::string, HandlerFunc> _routes;
+    std::unordered_set<std::string> _blockingRoutes;
+    std::unordered_map<std::string, AsyncHandlerFunc> _asyncRoutes;
+    std::unordered_map<std::string, CachePolicy> _cachedRoutes;
+    std::unordered_map<std::string, ws::Handlers> _wsRoutes;
 
     struct Mount { std::string prefix; std::string fsRoot; };
     std::vector<Mount> _staticMounts;
@@ -0,0 +1,200 @@
+#ifndef ZENER_HTTP_WEBSOCKET_H
+#define ZENER_HTTP_WEBSOCKET_H
+
+/*
+    WebSocket（RFC 6455）
+    - 握手在 Conn::Process 中完成：GET 请求带 Upgrade: websocket 且路径注册了
+      WebSocket 路由时回 101，之后连接的读缓冲区交给 Session 按帧解析
+    - 客户端帧的掩码直接在读缓冲区里原地去除（SSE2/AVX2，每次 16/32 字节）
+    - 回调在持有连接的工作线程里执行，Session::Send 直接写入连接的写缓冲区
+    - 其他线程通过 Hub 广播：消息只序列化成一次帧（Frame，引用计数共享），
+      投递到各连接的 Outbox，由事件循环派发可写事件后在持有线程中写出
+    - 空闲超时先发 ping，再过一个超时周期仍无任何数据才关闭连接
+    - 每条收到的完整消息按一个请求经 Conn::admit 准入（与 HTTP 请求共用
+      源 IP 的令牌桶和过载丢弃），超速时以 1008、过载丢弃时以 1013 关闭连接
+*/
+
+#include "buffer/buffer.h"
+#include "common.h"
+#include "utils/mpsc_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace zener::http::ws {
+
+enum Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xa,
+};
+
+// 关闭码（RFC 6455 7.4.1）
+enum CloseCode : uint16_t {
+    NORMAL = 1000,
+    GOING_AWAY = 1001,
+    PROTOCOL_ERROR = 1002,
+    INVALID_DATA = 1007,
+    POLICY_VIOLATION = 1008,
+    TOO_BIG = 1009,
+    TRY_AGAIN_LATER = 1013,
+};
+
+// 序列化好的服务端帧（不带掩码），可被任意多个连接共享
+using Frame = std::shared_ptr<const std::string>;
+
+[[nodiscard]] Frame MakeFrame(Opcode op, std::string_view payload);
+// Sec-WebSocket-Accept = base64(SHA-1(key + GUID))
+[[nodiscard]] std::string AcceptKey(std::string_view key);
+// 原地去除掩码，offset 为 data 在负载中的起始位置
+void Unmask(char *data, size_t len, const uint8_t mask[4], size_t offset = 0);
+
+/*
+    连接的发件箱：Hub 与 Session 共享
+    任意线程 Push，持有连接的工作线程 Drain
+*/
+class Outbox {
+  public:
+    Outbox(const int fd, const uint64_t connId) : _fd(fd), _connId(connId) {}
+
+    // 返回 true 表示此前为空，调用方需唤醒连接
+    bool Push(Frame frame) {
+        return !_closed.load(std::memory_order_acquire) &&
+               _queue.Push(std::move(frame));
+    }
+    template <typename F>
+    size_t Drain(F &&fn) {
+        return _queue.Drain(std::forward<F>(fn));
+    }
+    [[nodiscard]] bool Empty() const { return _queue.Empty(); }
+
+    void Close() { _closed.store(true, std::memory_order_release); }
+    [[nodiscard]] bool Closed() const {
+        return _closed.load(std::memory_order_acquire);
+    }
+
+    // 空闲探测：已发出 ping、还没有收到任何数据
+    bool MarkProbed() { return !_probed.exchange(true, std::memory_order_acq_rel); }
+    void ClearProbed() { _probed.store(false, std::memory_order_release); }
+
+    _ZENER_SHORT_FUNC int Fd() const { return _fd; }
+    _ZENER_SHORT_FUNC uint64_t ConnId() const { return _connId; }
+
+  private:
+    const int _fd;
+    const uint64_t _connId;
+    MpscQueue<Frame> _queue;
+    std::atomic<bool> _closed{false};
+    std::atomic<bool> _probed{false};
+};
+
+class Session;
+
+// 连接异常断开（对端复位、超时）时 onClose 在关闭连接的线程中调用
+struct Handlers {
+    std::function<void(Session &)> onOpen;
+    std::function<void(Session &, std::string_view message, bool binary)>
+        onMessage;
+    std::function<void(Session &)> onClose;
+};
+
+class Session {
+  public:
+    // limiterSlot 为连接在 ClientLimiter 中的槽，交给 Conn::admit
+    Session(const Handlers &handlers, std::string path, int limiterSlot,
+            std::shared_ptr<Outbox> outbox, Buffer &out);
+    ~Session();
+
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    // 握手完成后调用 onOpen
+    void Open();
+    // 解析 in 中完整的帧并回调，再把发件箱中的帧写入 out
+    // 返回 false 表示连接应在写完后关闭
+    bool Feed(Buffer &in);
+
+    // 以下只能在回调中（持有连接的工作线程）调用，其他线程请用 Hub
+    void Send(std::string_view message, bool binary = false);
+    void Close(uint16_t code = NORMAL, std::string_view reason = {});
+    // 订阅 Hub 的主题，连接关闭时自动退订
+    void Subscribe(const std::string &topic);
+
+    _ZENER_SHORT_FUNC const std::string &Path() const { return _path; }
+    _ZENER_SHORT_FUNC uint64_t ConnId() const { return _outbox->ConnId(); }
+    _ZENER_SHORT_FUNC bool Closing() const { return _closeSent; }
+
+  private:
+    // 返回 false 表示协议错误，已发出关闭帧
+    bool onFrame(uint8_t opcode, bool fin, char *payload, size_t len);
+    // 消息交给 onMessage 之前准入，被拒绝时发出关闭帧并返回 false
+    bool admit();
+    void notifyClose();
+
+    static constexpr size_t MAX_MESSAGE = 1 << 20;
+
+    const Handlers &_handlers;
+    std::string _path;
+    int _limiterSlot;
+    std::shared_ptr<Outbox> _outbox;
+    Buffer &_out;
+    std::vector<std::string> _topics;
+
+    std::string _message; // 分片消息的累积
+    uint8_t _messageOp{0};
+    bool _closeSent{false};
+    bool _closeNotified{false};
+};
+
+/*
+    按主题广播：消息只编码一次，所有订阅者共享同一个帧
+    唤醒函数由 Server 设置，把 (fd, connId) 交给事件循环派发可写
+*/
+class Hub {
+  public:
+    static Hub &GetInstance() {
+        static Hub instance;
+        return instance;
+    }
+
+    using Waker = std::function<void(int fd, uint64_t connId)>;
+    void SetWaker(Waker waker) { _waker = std::move(waker); }
+
+    void Join(const std::string &topic, const std::shared_ptr<Outbox> &box);
+    void Leave(const std::string &topic, const Outbox *box);
+
+    // 任意线程调用，返回投递的连接数
+    size_t Broadcast(const std::string &topic, std::string_view message,
+                     bool binary = false);
+    size_t Broadcast(const std::string &topic, const Frame &frame);
+
+    // 把帧投递给单个连接并在需要时唤醒它
+    void Deliver(Outbox &box, Frame frame) const;
+
+    [[nodiscard]] size_t Subscribers(const std::string &topic) const;
+
+    static std::atomic<int> sessionCount;
+
+  private:
+    Hub() = default;
+
+    Waker _waker;
+    mutable std::shared_mutex _mtx;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Outbox>>>
+        _topics;
+};
+
+} // namespace zener::http::ws
+
+#endif // !ZENER_HTTP_WEBSOCKET_H
@@ -0,0 +1,164 @@
+#ifndef ZENER_TASK_CORO_H
+#define ZENER_TASK_CORO_H
+
+/*
+    C++20 协程任务 Task<T>
+    - 惰性启动：创建后挂起，被 co_await 时才开始执行，结束后对称转移回等待者，
+      嵌套调用不增加栈深度
+    - 每个 Task 记录驱动它的 Driver（如 http::AsyncCall），被 co_await 时
+      子任务继承父任务的 Driver；可等待对象通过它登记挂起点、在操作完成时通知
+    - 协程帧从 FramePool 分配：按 64 字节分级的线程本地空闲链表，
+      帧在哪个线程释放就缓存到哪个线程，热路径上不进全局分配器
+    Driver 只负责"何时、在哪个线程恢复"，本文件不依赖事件循环和线程池
+*/
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace zener {
+
+class FramePool {
+  public:
+    [[nodiscard]] static void *Allocate(size_t size);
+    static void Deallocate(void *p, size_t size) noexcept;
+
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t MAX_POOLED = 4096; // 更大的帧直接走全局分配器
+    static constexpr size_t MAX_CACHED = 256;  // 每个线程每一级最多缓存的帧数
+};
+
+namespace coro {
+
+// 驱动一棵协程：记录最内层的挂起点，操作完成后由它安排恢复
+class Driver : public std::enable_shared_from_this<Driver> {
+  public:
+    virtual ~Driver() = default;
+    // 可等待对象在 await_suspend 里、发起操作之前调用
+    virtual void Suspended(std::coroutine_handle<> handle) = 0;
+    // 操作完成，任意线程调用，之后不得再访问可等待对象
+    virtual void Complete() = 0;
+};
+
+struct PromiseBase {
+    struct FinalAwaiter {
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<>
+        await_suspend(const std::coroutine_handle<P> handle) const noexcept {
+            if (auto next = handle.promise().continuation) {
+                return next;
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+    [[nodiscard]] FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    static void *operator new(const size_t size) {
+        return FramePool::Allocate(size);
+    }
+    static void operator delete(void *p, const size_t size) noexcept {
+        FramePool::Deallocate(p, size);
+    }
+
+    Driver *driver{nullptr};
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+};
+
+template <typename T>
+struct Promise;
+
+} // namespace coro
+
+template <typename T = void>
+class [[nodiscard]] Task {
+  public:
+    using promise_type = coro::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(const Handle handle) : _handle(handle) {}
+    Task(Task &&other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            reset();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() { reset(); }
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return !_handle || _handle.done();
+    }
+    template <typename P>
+    std::coroutine_handle<>
+    await_suspend(const std::coroutine_handle<P> parent) noexcept {
+        _handle.promise().driver = parent.promise().driver;
+        _handle.promise().continuation = parent;
+        return _handle;
+    }
+    T await_resume() {
+        if (_handle.promise().error) {
+            std::rethrow_exception(_handle.promise().error);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*_handle.promise().value);
+        }
+    }
+
+    // 以下供 Driver 使用：作为根任务启动和检查结果
+    [[nodiscard]] Handle GetHandle() const { return _handle; }
+    [[nodiscard]] bool Done() const { return !_handle || _handle.done(); }
+
+  private:
+    void reset() {
+        if (_handle) {
+            _handle.destroy();
+            _handle = {};
+        }
+    }
+
+    Handle _handle;
+};
+
+namespace coro {
+
+template <typename T>
+struct Promise : PromiseBase {
+    Task<T> get_return_object() {
+        return Task<T>(std::coroutine_handle<Promise>::from_promise(*this));
+    }
+    template <typename U>
+    void return_value(U &&v) {
+        value.emplace(std::forward<U>(v));
+    }
+    std::optional<T> value;
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() {
+        return Task<void>(std::coroutine_handle<Promise>::from_promise(*this));
+    }
+    void return_void() const noexcept {}
+};
+
+} // namespace coro
+
+} // namespace zener
+
+#endif // !ZENER_TASK_CORO_H
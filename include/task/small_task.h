@@ -0,0 +1,114 @@
+#ifndef ZENER_SMALL_TASK_H
+#define ZENER_SMALL_TASK_H
+
+/*
+    只可移动的 void() 任务，替代 std::packaged_task / std::function
+    - 不超过 INLINE_SIZE 字节的可调用对象直接放在内部缓冲区，不分配内存
+      （reactor 提交的 [this, client] 之类的 lambda 都在此列）
+    - 更大的可调用对象退化为堆分配
+    - 整个对象恰好一条缓存行
+*/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace zener {
+
+class SmallTask {
+  public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    SmallTask() noexcept = default;
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, SmallTask>>>
+    SmallTask(F &&f) { // NOLINT 允许从 lambda 隐式构造
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void *>(_storage)) Fn(std::forward<F>(f));
+            _vtable = &INLINE_VTABLE<Fn>;
+        } else {
+            ::new (static_cast<void *>(_storage)) Fn *(new Fn(std::forward<F>(f)));
+            _vtable = &HEAP_VTABLE<Fn>;
+        }
+    }
+
+    SmallTask(SmallTask &&other) noexcept : _vtable(other._vtable) {
+        if (_vtable) {
+            _vtable->move(_storage, other._storage);
+            other._vtable = nullptr;
+        }
+    }
+
+    SmallTask &operator=(SmallTask &&other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other._vtable) {
+                other._vtable->move(_storage, other._storage);
+                _vtable = other._vtable;
+                other._vtable = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    SmallTask(const SmallTask &) = delete;
+    SmallTask &operator=(const SmallTask &) = delete;
+
+    ~SmallTask() { reset(); }
+
+    explicit operator bool() const noexcept { return _vtable != nullptr; }
+
+    void operator()() { _vtable->invoke(_storage); }
+
+    void reset() noexcept {
+        if (_vtable) {
+            _vtable->destroy(_storage);
+            _vtable = nullptr;
+        }
+    }
+
+  private:
+    struct VTable {
+        void (*invoke)(void *self);
+        // 把 src 移动构造到 dst 并析构 src
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *self) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= INLINE_SIZE &&
+               alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr VTable INLINE_VTABLE{
+        [](void *self) { (*static_cast<Fn *>(self))(); },
+        [](void *dst, void *src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+            static_cast<Fn *>(src)->~Fn();
+        },
+        [](void *self) noexcept { static_cast<Fn *>(self)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr VTable HEAP_VTABLE{
+        [](void *self) { (**static_cast<Fn **>(self))(); },
+        [](void *dst, void *src) noexcept {
+            ::new (dst) Fn *(*static_cast<Fn **>(src));
+        },
+        [](void *self) noexcept { delete *static_cast<Fn **>(self); },
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[INLINE_SIZE]{};
+    const VTable *_vtable{nullptr};
+};
+
+static_assert(sizeof(SmallTask) <= 64);
+
+} // namespace zener
+
+#endif // !ZENER_SMALL_TASK_H
@@ -1,90 +1,146 @@
 #ifndef ZENER_THREADPOOL1_H
 #define ZENER_THREADPOOL1_H
 /*
-    使用packaged_task，支持返回值任务
-    支持工作窃取（work stealing）：每个线程有独立的本地双端队列，
-    空闲时随机从其他线程的队列尾部窃取任务，减少全局锁竞争。
+    任务使用 SmallTask（小对象内联存储，不分配内存）
+    外部线程（reactor）提交的任务进入有界无锁 MPMC 队列，满时退回到加锁的溢出队列
+    工作线程通过 thread_local 下标直接找到自己的本地队列
+    工作窃取（work stealing）：每个线程有一个 Chase-Lev 无锁双端队列，
+    所有者在底部存取，空闲线程从其他线程顶部一次窃取约一半任务。
+    空闲线程通过 EventCount（futex）睡眠，提交任务时按需唤醒，不再轮询。
+
+    任务分三条通道（Lane）：
+    - IO：读写等延迟敏感任务，走上面的本地队列/全局队列，优先级最高
+    - NORMAL：普通处理函数，有界队列；同时执行 NORMAL 的工作线程数受配额限制，
+      保证总有线程能处理 IO
+    - BLOCKING：数据库、文件系统等会阻塞的任务，由独立的少量线程执行，有界队列，
+      不会占住 IO/NORMAL 的工作线程
+    NORMAL/BLOCKING 任务可带截止时间，出队时已过期则不执行，改为调用 onShed；
+    队列满时 AddTask 返回 false，由调用者（reactor/工作线程）决定如何拒绝。
+
+    自适应线程数（ThreadPoolSizing::adaptive）：
+    - 按 1/DELAY_SAMPLE_EVERY 的比例给入队任务打时间戳，出队时累计排队延迟
+    - 监控线程每 SAMPLE_MS 采样一次忙碌线程数，每个评估周期计算平均排队延迟和利用率
+    - 延迟和利用率连续偏高则扩容，连续偏低则缩容（扩快缩慢，形成滞回）
+    - 本地队列按上限预先分配，线程按需创建；缩容时下标超出目标值的线程停放
+      （park）在 futex 上，扩容时优先唤醒停放的线程
+
+    绑核与 NUMA（ThreadPoolAffinity）：
+    - 第 i 个工作线程绑定到 workerCpus[i % n]，BLOCKING 线程绑定到 blockingCpus
+    - 开启 nodeQueues 后每个 NUMA 节点有一条投递队列，AddTaskOnNode 把任务投给
+      同节点的工作线程；工作线程先取本节点队列，最后才取其他节点的，保证不饿死
 */
+#include "task/small_task.h"
+#include "utils/cpu/topology.h"
+#include "utils/chase_lev_deque.hpp"
+#include "utils/eventcount.hpp"
+#include "utils/mpmc_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
-#include <deque>
-#include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <random>
 #include <thread>
 #include <utils/log/logger.h>
+#include <vector>
 
 namespace zener::v0 {
 
+// 各通道的配额，0 表示使用默认值
+struct ThreadPoolLanes {
+    size_t normalQuota{0};     // 同时执行 NORMAL 任务的线程上限，默认 线程数-1
+    size_t normalQueue{4096};  // NORMAL 队列长度上限
+    size_t blockingThreads{2}; // BLOCKING 专用线程数，0 表示不单独开线程
+    size_t blockingQueue{256}; // BLOCKING 队列长度上限
+};
+
+// IO/NORMAL 工作线程数的上下限与自适应参数，0 表示使用默认值
+struct ThreadPoolSizing {
+    bool adaptive{false};
+    size_t minThreads{0};        // 默认 1
+    size_t maxThreads{0};        // 默认 max(初始线程数, 2 * CPU 核数)
+    uint32_t growDelayUs{2000};  // 平均排队延迟高于此值（且利用率高）时扩容
+    uint32_t shrinkDelayUs{200}; // 平均排队延迟低于此值（且利用率低）时缩容
+    uint32_t intervalMs{250};    // 评估周期
+};
+
+// 绑核与 NUMA 亲和，CPU 列表为空表示不绑定
+struct ThreadPoolAffinity {
+    std::vector<int> workerCpus;   // 第 i 个工作线程绑定 workerCpus[i % size]
+    std::vector<int> blockingCpus; // BLOCKING 线程绑定到整个集合
+    bool nodeQueues{false}; // 按 NUMA 节点建投递队列，需要 workerCpus 非空
+};
+
 class ThreadPool {
   public:
-    explicit ThreadPool(
-        const size_t threadCount = std::thread::hardware_concurrency() - 2)
-        : _pool(std::make_shared<Pool>(threadCount)) {
-        assert(threadCount > 0);
-        _pool->threads.reserve(threadCount);
-        for (size_t i = 0; i < threadCount; ++i) {
-            _pool->threads.emplace_back([pool = _pool, i] {
-                std::mt19937 rng(std::random_device{}());
-                const size_t n = pool->localQueues.size();
+    using Task = SmallTask;
+    using Clock = std::chrono::steady_clock;
 
-                while (true) {
-                    std::packaged_task<void()> task;
-
-                    // 1. 先尝试从本地队列头部取任务
-                    {
-                        std::lock_guard<std::mutex> lk(
-                            pool->localQueues[i].mtx);
-                        if (!pool->localQueues[i].deque.empty()) {
-                            task =
-                                std::move(pool->localQueues[i].deque.front());
-                            pool->localQueues[i].deque.pop_front();
-                        }
-                    }
+    enum class Lane : uint8_t { IO, NORMAL, BLOCKING };
 
-                    // 2. 本地为空，尝试从全局队列取
-                    if (!task.valid()) {
-                        std::unique_lock<std::mutex> lock(pool->globalMtx);
-                        if (!pool->globalTasks.empty()) {
-                            task = std::move(pool->globalTasks.front());
-                            pool->globalTasks.pop();
-                        }
-                    }
+    static constexpr size_t GLOBAL_QUEUE_CAPACITY = 4096;
+    static constexpr size_t MAX_STEAL_BATCH = 32; // 单次最多窃取的任务数
 
-                    // 3. 全局也为空，随机窃取其他线程本地队列尾部
-                    if (!task.valid()) {
-                        std::uniform_int_distribution<size_t> dist(0, n - 1);
-                        size_t victim = dist(rng);
-                        if (victim != i) {
-                            std::lock_guard<std::mutex> lk(
-                                pool->localQueues[victim].mtx);
-                            if (!pool->localQueues[victim].deque.empty()) {
-                                task = std::move(
-                                    pool->localQueues[victim].deque.back());
-                                pool->localQueues[victim].deque.pop_back();
-                            }
-                        }
-                    }
+    static constexpr uint32_t DELAY_SAMPLE_EVERY = 16; // 须为 2 的幂
+    static constexpr int SAMPLE_MS = 10;               // 利用率采样间隔
+    static constexpr double GROW_UTILIZATION = 0.75;
+    static constexpr double SHRINK_UTILIZATION = 0.25;
+    static constexpr int GROW_STREAK = 2;   // 连续几个周期过载才扩容
+    static constexpr int SHRINK_STREAK = 8; // 连续几个周期空闲才缩容
+
+    // CPU 核数减 2（留给 reactor 和定时器），至少 1
+    static size_t DefaultThreadCount() {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 2 ? cores - 2 : 1;
+    }
 
-                    if (task.valid()) {
+    explicit ThreadPool(const size_t threadCount = DefaultThreadCount(),
+                        const ThreadPoolLanes &lanes = {},
+                        const ThreadPoolSizing &sizing = {},
+                        const ThreadPoolAffinity &affinity = {})
+        : _pool(std::make_shared<Pool>(threadCount, lanes, sizing, affinity)) {
+        assert(threadCount > 0);
+        std::lock_guard<std::mutex> lock(_pool->threadsMtx);
+        const size_t initial = _pool->target.load(std::memory_order_relaxed);
+        _pool->threads.reserve(initial + lanes.blockingThreads + 1);
+        for (size_t i = 0; i < initial; ++i) {
+            spawnWorker(_pool, i);
+        }
+        // BLOCKING 专用线程：只处理 BLOCKING 队列
+        for (size_t i = 0; i < lanes.blockingThreads; ++i) {
+            _pool->threads.emplace_back([pool = _pool] {
+                if (!cpu::PinCurrentThread(pool->blockingCpus)) {
+                    LOG_W("ThreadPool: failed to pin blocking thread.");
+                }
+                while (true) {
+                    if (LaneTask laneTask;
+                        pool->blockingTasks.TryPop(laneTask)) {
                         ++pool->activeThreads;
-                        task();
+                        pool->RunLaneTask(laneTask);
                         --pool->activeThreads;
-                    } else {
-                        // 无任务可取，等待通知
-                        std::unique_lock<std::mutex> lock(pool->globalMtx);
-                        if (pool->isClosed)
-                            break;
-                        pool->cond.wait_for(lock,
-                                            std::chrono::microseconds(200));
-                        if (pool->isClosed && pool->globalTasks.empty())
-                            break;
+                        continue;
+                    }
+                    const uint32_t key = pool->blockingIdle.PrepareWait();
+                    if (pool->blockingTasks.SizeApprox() > 0) {
+                        pool->blockingIdle.CancelWait();
+                        continue;
                     }
+                    if (pool->isClosed.load(std::memory_order_seq_cst)) {
+                        pool->blockingIdle.CancelWait();
+                        break;
+                    }
+                    pool->blockingIdle.Wait(key);
                 }
             });
         }
+        if (_pool->adaptive) {
+            _pool->threads.emplace_back(
+                [pool = _pool] { monitorLoop(pool); });
+        }
     }
 
     ~ThreadPool() {
@@ -94,26 +150,137 @@ class ThreadPool {
     // 提交任务：优先投入当前线程对应的本地队列，否则投入全局队列
     template <typename F>
     void AddTask(F &&task) {
-        std::packaged_task<void()> packagedTask(std::forward<F>(task));
-
-        // 尝试找到当前线程的本地队列
-        const auto tid = std::this_thread::get_id();
-        auto &queues = _pool->localQueues;
-        for (size_t i = 0; i < _pool->threads.size(); ++i) {
-            if (_pool->threads[i].get_id() == tid) {
-                std::lock_guard<std::mutex> lk(queues[i].mtx);
-                queues[i].deque.push_back(std::move(packagedTask));
-                _pool->cond.notify_one();
-                return;
-            }
+        Task smallTask(std::forward<F>(task));
+
+        if (tWorker.pool == _pool.get()) {
+            // 本池的工作线程：直接压入自己的本地双端队列
+            _pool->localQueues[tWorker.index].deque.Push(
+                newNode(std::move(smallTask)));
+        } else {
+            // 外部线程提交，走全局无锁队列；满了才加锁放入溢出队列
+            _pool->PushGlobal({std::move(smallTask), _pool->Stamp()});
         }
+        _pool->idle.NotifyOne();
+    }
 
-        // 外部线程提交，走全局队列
-        {
-            std::lock_guard<std::mutex> lock(_pool->globalMtx);
-            _pool->globalTasks.emplace(std::move(packagedTask));
+    /*
+        投给 NUMA 节点 node 上的工作线程（IO 通道），node 由连接的
+        SO_INCOMING_CPU 得来；未开启节点队列、node 未知或在工作线程中调用时
+        等同于 AddTask(task)
+    */
+    template <typename F>
+    void AddTaskOnNode(const int node, F &&task) {
+        if (node < 0 || static_cast<size_t>(node) >= _pool->nodeTasks.size() ||
+            tWorker.pool == _pool.get()) {
+            AddTask(std::forward<F>(task));
+            return;
+        }
+        QueuedTask queued{Task(std::forward<F>(task)), _pool->Stamp()};
+        if (!_pool->nodeTasks[node]->TryPush(std::move(queued))) {
+            _pool->PushGlobal(std::move(queued));
         }
-        _pool->cond.notify_one();
+        _pool->idle.NotifyOne();
+    }
+
+    // 是否开启了按节点投递
+    [[nodiscard]] bool NodeAware() const { return !_pool->nodeTasks.empty(); }
+
+    /*
+        按通道提交任务，IO 通道等同于 AddTask(task)
+        deadline 为默认值表示不过期；过期任务出队时不执行，改为执行 onShed
+        通道队列已满时返回 false，任务未被接收，onShed 也不会被调用
+    */
+    bool AddTask(const Lane lane, Task task, const Clock::time_point deadline = {},
+                 Task onShed = {}) {
+        if (lane == Lane::IO) {
+            AddTask(std::move(task));
+            return true;
+        }
+        const bool blocking =
+            lane == Lane::BLOCKING && _pool->blockingThreads > 0;
+        auto &queue = blocking ? _pool->blockingTasks : _pool->normalTasks;
+        const size_t limit =
+            blocking ? _pool->blockingLimit : _pool->normalLimit;
+        if (queue.SizeApprox() >= limit ||
+            !queue.TryPush(LaneTask{std::move(task), std::move(onShed),
+                                    deadline,
+                                    blocking ? 0 : _pool->Stamp()})) {
+            _pool->rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (blocking) {
+            _pool->blockingIdle.NotifyOne();
+        } else {
+            _pool->idle.NotifyOne();
+        }
+        return true;
+    }
+
+    /*
+        调整 IO/NORMAL 工作线程数，结果限制在 [MinSize(), MaxSize()]
+        扩容时先唤醒停放的线程，不够再创建；缩容只降低目标值，多余线程自行停放
+    */
+    void Resize(const size_t threads) const { resize(_pool, threads); }
+
+    // 当前目标线程数
+    [[nodiscard]] size_t Size() const {
+        return _pool->target.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] size_t MinSize() const { return _pool->minThreads; }
+    [[nodiscard]] size_t MaxSize() const { return _pool->maxThreads; }
+
+    // 最近一个评估周期的平均排队延迟（微秒），仅自适应模式下有值
+    [[nodiscard]] uint64_t QueueDelayUs() const {
+        return _pool->lastDelayUs.load(std::memory_order_relaxed);
+    }
+
+    // 等待执行的任务数（近似值），仅用于监控
+    [[nodiscard]] size_t QueueLength() const {
+        return LaneLength(Lane::IO) + LaneLength(Lane::NORMAL) +
+               LaneLength(Lane::BLOCKING);
+    }
+
+    [[nodiscard]] size_t LaneLength(const Lane lane) const {
+        switch (lane) {
+        case Lane::NORMAL:
+            return _pool->normalTasks.SizeApprox();
+        case Lane::BLOCKING:
+            return _pool->blockingTasks.SizeApprox();
+        case Lane::IO:
+            break;
+        }
+        size_t length = _pool->globalTasks.SizeApprox() +
+                        _pool->overflowSize.load(std::memory_order_relaxed);
+        for (const auto &queue : _pool->nodeTasks) {
+            length += queue->SizeApprox();
+        }
+        for (const auto &lq : _pool->localQueues) {
+            length += lq.deque.SizeApprox();
+        }
+        return length;
+    }
+
+    // 通道是否已积压到上限，供 reactor 做背压判断
+    [[nodiscard]] bool Saturated(const Lane lane) const {
+        switch (lane) {
+        case Lane::NORMAL:
+            return LaneLength(lane) >= _pool->normalLimit;
+        case Lane::BLOCKING:
+            return _pool->blockingThreads > 0
+                       ? LaneLength(lane) >= _pool->blockingLimit
+                       : LaneLength(Lane::NORMAL) >= _pool->normalLimit;
+        case Lane::IO:
+            break;
+        }
+        return _pool->overflowSize.load(std::memory_order_relaxed) > 0;
+    }
+
+    // 因过期被丢弃 / 因队列满被拒绝的任务总数
+    [[nodiscard]] uint64_t ShedCount() const {
+        return _pool->shed.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t RejectedCount() const {
+        return _pool->rejected.load(std::memory_order_relaxed);
     }
 
     void Shutdown(int timeoutMS = 1000) const {
@@ -123,22 +290,31 @@ class ThreadPool {
 
         // -------------------- Phase 1: 优雅关闭 --------------------
         {
-            std::lock_guard<std::mutex> lock(_pool->globalMtx);
-            _pool->isClosed = true;
-            _pool->cond.notify_all();
+            std::lock_guard<std::mutex> lock(_pool->monitorMtx);
+            _pool->isClosed.store(true, std::memory_order_seq_cst);
         }
+        _pool->monitorCv.notify_all();
+        _pool->idle.NotifyAll();
+        _pool->parked.NotifyAll();
+        _pool->blockingIdle.NotifyAll();
         // 等待任务完成或超时
-        auto completionFuture =
-            std::async(std::launch::async, [this, timeoutMS] {
-                std::unique_lock<std::mutex> lock(_pool->globalMtx);
-                return _pool->cond.wait_for(
-                    lock, std::chrono::milliseconds(timeoutMS), [this] {
-                        return _pool->globalTasks.empty() &&
-                               _pool->activeThreads == 0;
-                    });
-            });
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(timeoutMS);
+        bool completed = false;
+        while (true) {
+            if (!_pool->HasWork() && _pool->normalTasks.SizeApprox() == 0 &&
+                _pool->blockingTasks.SizeApprox() == 0 &&
+                _pool->activeThreads == 0) {
+                completed = true;
+                break;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
 
-        if (completionFuture.get()) {
+        if (completed) {
             LOG_I("ThreadPool: All tasks completed gracefully");
         } else {
             LOG_W("ThreadPool: Graceful shutdown timed out");
@@ -147,13 +323,34 @@ class ThreadPool {
         // -------------------- Phase 2: 强制关闭 --------------------
         {
             std::lock_guard<std::mutex> lock(_pool->globalMtx);
-            while (!_pool->globalTasks.empty()) {
-                _pool->globalTasks.pop();
+            QueuedTask dropped;
+            while (_pool->globalTasks.TryPop(dropped)) {
+            }
+            for (const auto &queue : _pool->nodeTasks) {
+                while (queue->TryPop(dropped)) {
+                }
+            }
+            LaneTask droppedLane;
+            while (_pool->normalTasks.TryPop(droppedLane)) {
+            }
+            while (_pool->blockingTasks.TryPop(droppedLane)) {
+            }
+            while (!_pool->overflowTasks.empty()) {
+                _pool->overflowTasks.pop();
             }
+            _pool->overflowSize.store(0, std::memory_order_relaxed);
+            // 本地队列只有所有者能 Pop，这里用 Steal 清空
             for (auto &lq : _pool->localQueues) {
-                std::lock_guard<std::mutex> lk(lq.mtx);
-                lq.deque.clear();
+                TaskNode *node = nullptr;
+                while (lq.deque.SizeApprox() > 0) {
+                    if (lq.deque.Steal(node)) {
+                        freeNode(node);
+                    }
+                }
             }
+        }
+        {
+            std::lock_guard<std::mutex> lock(_pool->threadsMtx);
             for (auto &thread : _pool->threads) {
                 if (thread.joinable()) {
                     thread.detach();
@@ -163,26 +360,522 @@ class ThreadPool {
             }
             _pool->threads.clear();
         }
+        _pool->idle.NotifyAll();
+        _pool->parked.NotifyAll();
+        _pool->blockingIdle.NotifyAll();
         LOG_I("ThreadPool: Shutdown complete.");
     }
 
   private:
-    struct LocalQueue {
-        std::mutex mtx;
-        std::deque<std::packaged_task<void()>> deque;
+    // 本地队列中的任务节点；Chase-Lev 队列只能存指针
+    struct TaskNode {
+        Task task;
+        TaskNode *next{nullptr};
     };
 
+    // 每线程缓存执行完的节点，避免本地提交反复分配
+    struct NodeCache {
+        static constexpr size_t MAX_CACHED = 1024;
+        TaskNode *head;
+        size_t size;
+        NodeCache() : head(nullptr), size(0) {}
+        ~NodeCache() {
+            while (head) {
+                TaskNode *next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+    };
+    static inline thread_local NodeCache tNodeCache;
+
+    static TaskNode *newNode(Task &&task) {
+        auto &cache = tNodeCache;
+        if (cache.head) {
+            TaskNode *node = cache.head;
+            cache.head = node->next;
+            --cache.size;
+            node->task = std::move(task);
+            node->next = nullptr;
+            return node;
+        }
+        return new TaskNode{std::move(task), nullptr};
+    }
+
+    static void freeNode(TaskNode *node) {
+        node->task.reset();
+        auto &cache = tNodeCache;
+        if (cache.size >= NodeCache::MAX_CACHED) {
+            delete node;
+            return;
+        }
+        node->next = cache.head;
+        cache.head = node;
+        ++cache.size;
+    }
+
+    struct alignas(64) LocalQueue {
+        ChaseLevDeque<TaskNode *> deque;
+    };
+
+    // 全局队列中的任务，enqueuedNs 非 0 表示被抽中做排队延迟采样
+    struct QueuedTask {
+        Task task;
+        int64_t enqueuedNs;
+    };
+
+    // NORMAL/BLOCKING 通道中的任务，deadline 为默认值表示不过期
+    struct LaneTask {
+        Task task;
+        Task onShed;
+        Clock::time_point deadline;
+        int64_t enqueuedNs;
+    };
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   Clock::now().time_since_epoch())
+            .count();
+    }
+
+    static inline thread_local uint32_t tSampleTick{0};
+
     struct Pool {
-        explicit Pool(size_t n) : localQueues(n) {}
+        Pool(const size_t n, const ThreadPoolLanes &lanes,
+             const ThreadPoolSizing &sizing, const ThreadPoolAffinity &affinity)
+            : minThreads(std::max<size_t>(sizing.minThreads, 1)),
+              maxThreads(std::max(
+                  minThreads,
+                  sizing.maxThreads > 0 ? sizing.maxThreads
+                  : sizing.adaptive
+                      ? std::max<size_t>(
+                            n, 2 * std::max(std::thread::hardware_concurrency(),
+                                            1U))
+                      : n)),
+              adaptive(sizing.adaptive && minThreads < maxThreads),
+              growDelayUs(sizing.growDelayUs),
+              shrinkDelayUs(sizing.shrinkDelayUs),
+              intervalMs(std::max<uint32_t>(sizing.intervalMs, SAMPLE_MS)),
+              target(std::clamp(n, minThreads, maxThreads)),
+              localQueues(maxThreads), globalTasks(GLOBAL_QUEUE_CAPACITY),
+              normalTasks(std::max<size_t>(lanes.normalQueue, 1)),
+              blockingTasks(std::max<size_t>(lanes.blockingQueue, 1)),
+              normalQuota(lanes.normalQuota),
+              normalLimit(std::max<size_t>(lanes.normalQueue, 1)),
+              blockingThreads(lanes.blockingThreads),
+              blockingLimit(std::max<size_t>(lanes.blockingQueue, 1)),
+              workerCpus(affinity.workerCpus),
+              blockingCpus(affinity.blockingCpus) {
+            if (affinity.nodeQueues && !workerCpus.empty()) {
+                for (int node = 0; node < cpu::NodeCount(); ++node) {
+                    nodeTasks.push_back(std::make_unique<MpmcQueue<QueuedTask>>(
+                        GLOBAL_QUEUE_CAPACITY));
+                }
+            }
+        }
+
+        const size_t minThreads;
+        const size_t maxThreads;
+        const bool adaptive;
+        const uint32_t growDelayUs;
+        const uint32_t shrinkDelayUs;
+        const uint32_t intervalMs;
+        std::atomic<size_t> target;     // 下标小于此值的工作线程处于活动状态
+        std::atomic<size_t> spawned{0}; // 已创建的工作线程数
+        std::mutex threadsMtx;          // 保护 threads（监控线程会扩容）
         std::vector<std::thread> threads;
-        std::vector<LocalQueue> localQueues; // 每线程本地双端队列
-        std::mutex globalMtx;
-        std::condition_variable cond;
-        bool isClosed = false;
-        std::queue<std::packaged_task<void()>>
-            globalTasks; // 全局队列（外部提交）
+
+        std::vector<LocalQueue> localQueues; // 每线程本地双端队列，按上限分配
+        MpmcQueue<QueuedTask> globalTasks;   // 全局队列（外部提交）
+        std::mutex globalMtx;                // 只保护溢出队列
+        std::queue<QueuedTask> overflowTasks; // 全局队列满时的退路
+        std::atomic<size_t> overflowSize{0};
+        std::atomic<bool> isClosed{false};
         std::atomic<int> activeThreads{0};
+        std::atomic<size_t> busyWorkers{0}; // 正在执行任务的 IO/NORMAL 线程
+        EventCount idle;   // 空闲线程在此睡眠
+        EventCount parked; // 超出目标线程数的线程在此停放
+
+        MpmcQueue<LaneTask> normalTasks;
+        MpmcQueue<LaneTask> blockingTasks;
+        EventCount blockingIdle; // BLOCKING 专用线程在此睡眠
+        const size_t normalQuota; // 0 表示随线程数变化：目标线程数-1
+        const size_t normalLimit;
+        const size_t blockingThreads;
+        const size_t blockingLimit;
+        std::atomic<size_t> normalRunning{0};
+        std::atomic<uint64_t> shed{0};
+        std::atomic<uint64_t> rejected{0};
+
+        const std::vector<int> workerCpus;
+        const std::vector<int> blockingCpus;
+        std::vector<std::unique_ptr<MpmcQueue<QueuedTask>>> nodeTasks; // 按节点投递
+
+        // 工作线程 i 绑定的 CPU，未绑定为 -1
+        [[nodiscard]] int CpuOfWorker(const size_t i) const {
+            return workerCpus.empty() ? -1 : workerCpus[i % workerCpus.size()];
+        }
+
+        // 排队延迟采样，监控线程每个周期取走清零
+        std::atomic<uint64_t> delaySumNs{0};
+        std::atomic<uint64_t> delayCount{0};
+        std::atomic<uint64_t> lastDelayUs{0};
+        std::mutex monitorMtx;
+        std::condition_variable monitorCv;
+
+        [[nodiscard]] size_t NormalQuota() const {
+            if (normalQuota > 0) {
+                return normalQuota;
+            }
+            const size_t n = target.load(std::memory_order_relaxed);
+            return n > 1 ? n - 1 : 1;
+        }
+
+        // 抽样打时间戳，未抽中或未开启自适应时为 0
+        [[nodiscard]] int64_t Stamp() const {
+            if (!adaptive ||
+                (++tSampleTick & (DELAY_SAMPLE_EVERY - 1)) != 0) {
+                return 0;
+            }
+            return nowNs();
+        }
+
+        void RecordDelay(const int64_t enqueuedNs) {
+            if (enqueuedNs == 0) {
+                return;
+            }
+            const int64_t delay = nowNs() - enqueuedNs;
+            delaySumNs.fetch_add(static_cast<uint64_t>(std::max<int64_t>(delay, 0)),
+                                 std::memory_order_relaxed);
+            delayCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void PushGlobal(QueuedTask &&task) {
+            if (!globalTasks.TryPush(std::move(task))) {
+                std::lock_guard<std::mutex> lock(globalMtx);
+                overflowTasks.emplace(std::move(task));
+                overflowSize.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // NORMAL 配额已满时不算有活，避免空闲线程空转
+        [[nodiscard]] bool HasWork() const {
+            if (globalTasks.SizeApprox() > 0 ||
+                overflowSize.load(std::memory_order_relaxed) > 0) {
+                return true;
+            }
+            for (const auto &queue : nodeTasks) {
+                if (queue->SizeApprox() > 0) {
+                    return true;
+                }
+            }
+            if (normalTasks.SizeApprox() > 0 &&
+                normalRunning.load(std::memory_order_acquire) < NormalQuota()) {
+                return true;
+            }
+            const size_t n = spawned.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i) {
+                if (localQueues[i].deque.SizeApprox() > 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+            依次尝试：本地队列 → 本节点队列 → 全局队列 → 溢出队列 → 窃取
+            → 其他节点队列
+        */
+        bool FindTask(const size_t self, const int home, std::mt19937 &rng,
+                      Task &task) {
+            TaskNode *node = nullptr;
+            if (localQueues[self].deque.Pop(node)) {
+                task = std::move(node->task);
+                freeNode(node);
+                return true;
+            }
+            if (home >= 0 && popQueued(*nodeTasks[home], task)) {
+                return true;
+            }
+            if (popQueued(globalTasks, task)) {
+                return true;
+            }
+            if (overflowSize.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(globalMtx);
+                if (!overflowTasks.empty()) {
+                    RecordDelay(overflowTasks.front().enqueuedNs);
+                    task = std::move(overflowTasks.front().task);
+                    overflowTasks.pop();
+                    overflowSize.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            if (stealHalf(self, rng, node)) {
+                task = std::move(node->task);
+                freeNode(node);
+                return true;
+            }
+            for (size_t other = 0; other < nodeTasks.size(); ++other) {
+                if (static_cast<int>(other) != home &&
+                    popQueued(*nodeTasks[other], task)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool popQueued(MpmcQueue<QueuedTask> &queue, Task &task) {
+            QueuedTask queued;
+            if (!queue.TryPop(queued)) {
+                return false;
+            }
+            RecordDelay(queued.enqueuedNs);
+            task = std::move(queued.task);
+            return true;
+        }
+
+        // 在配额内取一个 NORMAL 任务，成功时占用一个配额，执行完由调用者归还
+        bool TakeNormal(LaneTask &out) {
+            if (normalTasks.SizeApprox() == 0) {
+                return false;
+            }
+            if (normalRunning.fetch_add(1, std::memory_order_acq_rel) >=
+                NormalQuota()) {
+                normalRunning.fetch_sub(1, std::memory_order_release);
+                return false;
+            }
+            if (!normalTasks.TryPop(out)) {
+                normalRunning.fetch_sub(1, std::memory_order_release);
+                return false;
+            }
+            RecordDelay(out.enqueuedNs);
+            return true;
+        }
+
+        // 已过期的任务不执行，改为执行 onShed
+        void RunLaneTask(LaneTask &laneTask) {
+            if (laneTask.deadline != Clock::time_point{} &&
+                Clock::now() > laneTask.deadline) {
+                shed.fetch_add(1, std::memory_order_relaxed);
+                if (laneTask.onShed) {
+                    runTask(laneTask.onShed);
+                }
+                return;
+            }
+            runTask(laneTask.task);
+        }
+
+        /*
+            下标超出目标值的线程在此停放，直到扩容或关闭
+            停放前把本地队列剩余任务交还全局队列；
+            若自己是被 NotifyOne 唤醒的，把唤醒转交给其他线程，避免丢失
+        */
+        void Park(const size_t self) {
+            TaskNode *node = nullptr;
+            while (localQueues[self].deque.Pop(node)) {
+                PushGlobal({std::move(node->task), 0});
+                freeNode(node);
+            }
+            if (HasWork()) {
+                idle.NotifyOne();
+            }
+            while (true) {
+                const uint32_t key = parked.PrepareWait();
+                if (self < target.load(std::memory_order_acquire) ||
+                    isClosed.load(std::memory_order_seq_cst)) {
+                    parked.CancelWait();
+                    return;
+                }
+                parked.Wait(key);
+            }
+        }
+
+        // 从随机起点开始找一个非空的受害者，取走约一半任务：
+        // 第一个直接返回，其余压入自己的本地队列
+        bool stealHalf(const size_t self, std::mt19937 &rng, TaskNode *&out) {
+            const size_t n = spawned.load(std::memory_order_acquire);
+            if (n <= 1) {
+                return false;
+            }
+            const size_t start = rng() % n;
+            for (size_t k = 0; k < n; ++k) {
+                const size_t victim = (start + k) % n;
+                if (victim == self) {
+                    continue;
+                }
+                auto &deque = localQueues[victim].deque;
+                const size_t want = std::min<size_t>(
+                    (deque.SizeApprox() + 1) / 2, MAX_STEAL_BATCH);
+                if (want == 0 || !deque.Steal(out)) {
+                    continue;
+                }
+                TaskNode *extra = nullptr;
+                size_t moved = 0;
+                while (moved + 1 < want && deque.Steal(extra)) {
+                    localQueues[self].deque.Push(extra);
+                    ++moved;
+                }
+                if (moved > 0) {
+                    idle.NotifyOne(); // 让其他空闲线程有机会从这里继续窃取
+                }
+                return true;
+            }
+            return false;
+        }
     };
+
+    // 当前线程所属的池和下标，非工作线程为 nullptr
+    struct WorkerSlot {
+        const Pool *pool;
+        size_t index;
+    };
+    static inline thread_local WorkerSlot tWorker{nullptr, 0};
+
+    // 调用者须持有 threadsMtx
+    static void spawnWorker(const std::shared_ptr<Pool> &pool, const size_t i) {
+        pool->threads.emplace_back([pool, i] { workerLoop(*pool, i); });
+        pool->spawned.store(i + 1, std::memory_order_release);
+    }
+
+    static void workerLoop(Pool &pool, const size_t i) {
+        tWorker = {&pool, i};
+        std::mt19937 rng(std::random_device{}());
+        const int cpuId = pool.CpuOfWorker(i);
+        if (cpuId >= 0 && !cpu::PinCurrentThread({cpuId})) {
+            LOG_W("ThreadPool: failed to pin worker {} to cpu {}.", i, cpuId);
+        }
+        // 本节点投递队列下标，未开启时为 -1
+        int home = pool.nodeTasks.empty() ? -1 : cpu::NodeOf(cpuId);
+        if (home >= static_cast<int>(pool.nodeTasks.size())) {
+            home = -1;
+        }
+
+        while (true) {
+            if (i >= pool.target.load(std::memory_order_acquire) &&
+                !pool.isClosed.load(std::memory_order_acquire)) {
+                pool.Park(i);
+                continue;
+            }
+            Task task;
+            if (pool.FindTask(i, home, rng, task)) {
+                ++pool.activeThreads;
+                pool.busyWorkers.fetch_add(1, std::memory_order_relaxed);
+                runTask(task);
+                pool.busyWorkers.fetch_sub(1, std::memory_order_relaxed);
+                --pool.activeThreads;
+                continue;
+            }
+            // IO 任务都取完了才看 NORMAL
+            if (LaneTask laneTask; pool.TakeNormal(laneTask)) {
+                ++pool.activeThreads;
+                pool.busyWorkers.fetch_add(1, std::memory_order_relaxed);
+                pool.RunLaneTask(laneTask);
+                pool.busyWorkers.fetch_sub(1, std::memory_order_relaxed);
+                pool.normalRunning.fetch_sub(1, std::memory_order_release);
+                --pool.activeThreads;
+                continue;
+            }
+            // 无任务可取：先登记为等待者再检查一次，避免丢失唤醒
+            const uint32_t key = pool.idle.PrepareWait();
+            if (pool.HasWork()) {
+                pool.idle.CancelWait();
+                continue;
+            }
+            if (pool.isClosed.load(std::memory_order_seq_cst)) {
+                pool.idle.CancelWait();
+                break;
+            }
+            pool.idle.Wait(key);
+        }
+    }
+
+    static void resize(const std::shared_ptr<Pool> &pool, size_t threads) {
+        std::lock_guard<std::mutex> lock(pool->threadsMtx);
+        if (pool->isClosed.load(std::memory_order_acquire)) {
+            return;
+        }
+        threads = std::clamp(threads, pool->minThreads, pool->maxThreads);
+        const size_t old = pool->target.load(std::memory_order_relaxed);
+        if (threads == old) {
+            return;
+        }
+        for (size_t i = pool->spawned.load(std::memory_order_relaxed);
+             i < threads; ++i) {
+            spawnWorker(pool, i);
+        }
+        pool->target.store(threads, std::memory_order_release);
+        pool->parked.NotifyAll();
+        pool->idle.NotifyAll(); // 让多余的线程尽快停放
+        LOG_I("ThreadPool: resize {} -> {} (queue delay {}us)", old, threads,
+              pool->lastDelayUs.load(std::memory_order_relaxed));
+    }
+
+    // 监控线程：采样利用率与排队延迟，按滞回规则调整目标线程数
+    static void monitorLoop(const std::shared_ptr<Pool> &pool) {
+        const size_t samplesPerRound = pool->intervalMs / SAMPLE_MS;
+        size_t samples = 0;
+        size_t busySum = 0;
+        int growStreak = 0;
+        int shrinkStreak = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(pool->monitorMtx);
+                if (pool->monitorCv.wait_for(
+                        lock, std::chrono::milliseconds(SAMPLE_MS), [&pool] {
+                            return pool->isClosed.load(
+                                std::memory_order_acquire);
+                        })) {
+                    return;
+                }
+            }
+            busySum += pool->busyWorkers.load(std::memory_order_relaxed);
+            if (++samples < samplesPerRound) {
+                continue;
+            }
+            const size_t size = pool->target.load(std::memory_order_relaxed);
+            const double utilization = static_cast<double>(busySum) /
+                                       static_cast<double>(samples * size);
+            samples = 0;
+            busySum = 0;
+            const uint64_t count =
+                pool->delayCount.exchange(0, std::memory_order_relaxed);
+            const uint64_t sum =
+                pool->delaySumNs.exchange(0, std::memory_order_relaxed);
+            const uint64_t delayUs = count > 0 ? sum / count / 1000 : 0;
+            pool->lastDelayUs.store(delayUs, std::memory_order_relaxed);
+
+            if (delayUs > pool->growDelayUs &&
+                utilization > GROW_UTILIZATION) {
+                shrinkStreak = 0;
+                if (++growStreak >= GROW_STREAK) {
+                    growStreak = 0;
+                    resize(pool, size + std::max<size_t>(size / 4, 1));
+                }
+            } else if (delayUs < pool->shrinkDelayUs &&
+                       utilization < SHRINK_UTILIZATION) {
+                growStreak = 0;
+                if (++shrinkStreak >= SHRINK_STREAK) {
+                    shrinkStreak = 0;
+                    resize(pool, size - 1);
+                }
+            } else {
+                growStreak = 0;
+                shrinkStreak = 0;
+            }
+        }
+    }
+
+    // packaged_task 会吞掉异常，这里保持同样的行为，避免工作线程退出
+    static void runTask(Task &task) {
+        try {
+            task();
+        } catch (const std::exception &e) {
+            LOG_E("ThreadPool: task threw: {}", e.what());
+        } catch (...) {
+            LOG_E("ThreadPool: task threw unknown exception");
+        }
+    }
+
     std::shared_ptr<Pool> _pool;
 };
 
@@ -91,6 +91,12 @@ class TimerManager final : public ITimerManager {
         return _timer.GetNextTick();
     }
 
+    // 当前定时器数量
+    _ZENER_SHORT_FUNC size_t Size() const {
+        std::lock_guard<std::mutex> lk(_mtx);
+        return _timer._heap.size();
+    }
+
     // 基于业务ID取消定时器
     void CancelByKey(const int key) {
         std::lock_guard<std::mutex> lk(_mtx);
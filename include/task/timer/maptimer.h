@@ -66,6 +66,12 @@ class TimerManager final : public ITimerManager {
     // 获取下一个定时事件的超时时间
     int GetNextTick() override;
 
+    // 当前定时器数量
+    [[nodiscard]] size_t Size() const {
+        std::shared_lock lk(_timerMutex);
+        return _timers.size();
+    }
+
     // 基于业务ID取消定时器
     void CancelByKey(uint64_t key);
 
@@ -0,0 +1,137 @@
+#ifndef ZENER_CHASE_LEV_DEQUE_HPP
+#define ZENER_CHASE_LEV_DEQUE_HPP
+
+/*
+    Chase-Lev 无锁工作窃取双端队列（按 Lê 等人 2013 年的 C11 内存序版本实现）
+    - 所有者线程在底部 Push / Pop，无需 CAS（只剩最后一个元素时才与窃取者竞争）
+    - 其他线程在顶部 Steal，通过 CAS 推进 top
+    - 数组满时由所有者扩容为两倍；旧数组可能仍被窃取者读取，保留到析构时释放
+    元素类型须为指针等可原子读写的平凡类型。
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace zener {
+
+template <typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "ChaseLevDeque stores raw values; use pointers");
+
+  public:
+    explicit ChaseLevDeque(const size_t capacity = 256) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        _arrays.push_back(std::make_unique<Array>(cap));
+        _array.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    // 仅所有者线程调用
+    void Push(const T value) {
+        const int64_t b = _bottom.load(std::memory_order_relaxed);
+        const int64_t t = _top.load(std::memory_order_acquire);
+        Array *a = _array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+            a = grow(a, t, b);
+        }
+        a->Put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // 仅所有者线程调用，空时返回 false
+    bool Pop(T &out) {
+        const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = _array.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+        if (t > b) { // 空
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->Get(b);
+        if (t == b) { // 最后一个元素，与窃取者竞争
+            const bool won = _top.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // 任意线程调用；空或与他人竞争失败时返回 false
+    bool Steal(T &out) {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        const Array *a = _array.load(std::memory_order_acquire);
+        const T value = a->Get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    // 近似长度，供窃取者决定批量大小和监控使用
+    [[nodiscard]] size_t SizeApprox() const {
+        const int64_t b = _bottom.load(std::memory_order_relaxed);
+        const int64_t t = _top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+  private:
+    struct Array {
+        explicit Array(const size_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        [[nodiscard]] T Get(const int64_t i) const {
+            return slots[static_cast<size_t>(i) & mask].load(
+                std::memory_order_relaxed);
+        }
+        void Put(const int64_t i, const T value) {
+            slots[static_cast<size_t>(i) & mask].store(
+                value, std::memory_order_relaxed);
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Array *grow(const Array *old, const int64_t t, const int64_t b) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->Put(i, old->Get(i));
+        }
+        Array *a = bigger.get();
+        _arrays.push_back(std::move(bigger));
+        _array.store(a, std::memory_order_release);
+        return a;
+    }
+
+    alignas(64) std::atomic<int64_t> _top{0};
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    std::atomic<Array *> _array{nullptr};
+    std::vector<std::unique_ptr<Array>> _arrays; // 所有者线程维护，含已淘汰的旧数组
+};
+
+} // namespace zener
+
+#endif // !ZENER_CHASE_LEV_DEQUE_HPP
@@ -0,0 +1,33 @@
+#ifndef ZENER_CPU_TOPOLOGY_H
+#define ZENER_CPU_TOPOLOGY_H
+
+/*
+    CPU 拓扑与线程绑核
+    - CPU 列表使用内核 cpulist 格式："0-3,8,10-11"
+    - NUMA 节点信息读自 /sys/devices/system/node，读不到时视为单节点
+    - 绑核失败只返回 false，由调用者决定是否告警
+*/
+
+#include <string_view>
+#include <vector>
+
+namespace zener::cpu {
+
+// 解析 cpulist，非法片段被忽略，结果去重并升序
+std::vector<int> ParseList(std::string_view list);
+
+// 当前进程可用的 CPU（sched_getaffinity）
+std::vector<int> Available();
+
+// CPU 所在 NUMA 节点，未知时为 0
+int NodeOf(int cpu);
+
+// NUMA 节点数，至少为 1
+int NodeCount();
+
+// 把当前线程绑定到给定 CPU 集合，集合为空时不做任何事并返回 true
+bool PinCurrentThread(const std::vector<int> &cpus);
+
+} // namespace zener::cpu
+
+#endif // !ZENER_CPU_TOPOLOGY_H
@@ -0,0 +1,60 @@
+#ifndef ZENER_EVENTCOUNT_HPP
+#define ZENER_EVENTCOUNT_HPP
+
+/*
+    EventCount：让空闲线程睡眠而不丢失唤醒
+    等待方：
+        const auto key = ec.PrepareWait();
+        if (有活可干) { ec.CancelWait(); ... } else { ec.Wait(key); }
+    通知方：先发布任务，再 ec.NotifyOne() / NotifyAll()
+    没有等待者时 Notify 只是一次原子读，不进入内核
+    std::atomic::wait 在 Linux 上基于 futex
+*/
+
+#include <atomic>
+#include <cstdint>
+
+namespace zener {
+
+class EventCount {
+  public:
+    [[nodiscard]] uint32_t PrepareWait() {
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        return _epoch.load(std::memory_order_seq_cst);
+    }
+
+    void CancelWait() { _waiters.fetch_sub(1, std::memory_order_seq_cst); }
+
+    void Wait(const uint32_t key) {
+        _epoch.wait(key, std::memory_order_seq_cst);
+        _waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void NotifyOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_seq_cst) > 0) {
+            _epoch.fetch_add(1, std::memory_order_seq_cst);
+            _epoch.notify_one();
+        }
+    }
+
+    void NotifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_seq_cst) > 0) {
+            _epoch.fetch_add(1, std::memory_order_seq_cst);
+            _epoch.notify_all();
+        }
+    }
+
+    [[nodiscard]] uint32_t Waiters() const {
+        return _waiters.load(std::memory_order_relaxed);
+    }
+
+  private:
+    alignas(64) std::atomic<uint32_t> _epoch{0};
+    alignas(64) std::atomic<uint32_t> _waiters{0};
+};
+
+} // namespace zener
+
+#endif // !ZENER_EVENTCOUNT_HPP
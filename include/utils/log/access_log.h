@@ -0,0 +1,88 @@
+#ifndef ZENER_ACCESS_LOG_H
+#define ZENER_ACCESS_LOG_H
+
+/*
+    访问日志：每个请求一条定长二进制记录（见 access_log_format.h）
+    - 调用线程只做采样判断和 memcpy，写入自己的 SPSC 环形缓冲区
+    - 后台线程定期汇总所有缓冲区，批量 write 到 logs/access_<日期>.bin
+    - 采样：每 N 个请求记录 1 个，状态码 >= 400 的请求总是记录
+    用 access_log_dump 工具转换为文本或 JSON
+*/
+
+#include "utils/log/access_log_format.h"
+#include "utils/log/async_logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace zener {
+
+#define DEFAULT_ACCESS_LOG_QUEUE_SIZE (64 * 1024) // 每线程缓冲区 64KB
+
+class AccessLog {
+  public:
+    // 同 AsyncLogger，故意不析构
+    static AccessLog &GetInstance() {
+        static auto *instance = new AccessLog();
+        return *instance;
+    }
+
+    AccessLog(const AccessLog &) = delete;
+    AccessLog &operator=(const AccessLog &) = delete;
+    ~AccessLog() { Stop(); }
+
+    // sampleEvery 为 1 时记录全部请求
+    bool Start(const std::string &logDir, uint32_t sampleEvery,
+               size_t queueSize = DEFAULT_ACCESS_LOG_QUEUE_SIZE);
+    void Stop();
+
+    [[nodiscard]] bool Enabled() const {
+        return _running.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t Dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::string FileName() const { return _fileName; }
+
+    void Record(uint64_t connId, std::string_view method,
+                std::string_view path, int status, size_t bytes,
+                std::chrono::steady_clock::time_point start);
+
+  private:
+    AccessLog() = default;
+
+    [[nodiscard]] bool sampled(int status) const;
+    detail::LogThreadQueue *localQueue();
+
+    void backendLoop();
+    // 读空所有线程缓冲区并写出，返回写出的记录数
+    size_t drainOnce();
+
+    std::atomic<bool> _running{false};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _generation{0};
+    uint32_t _sampleEvery{1};
+    size_t _queueSize{DEFAULT_ACCESS_LOG_QUEUE_SIZE};
+    int _fd{-1};
+    std::string _fileName;
+
+    std::mutex _registryMtx;
+    std::vector<std::shared_ptr<detail::LogThreadQueue>> _queues;
+    std::atomic<uint64_t> _registryVersion{0};
+
+    std::mutex _wakeMtx;
+    std::condition_variable _wakeCond;
+    std::thread _backend;
+};
+
+} // namespace zener
+
+#endif // !ZENER_ACCESS_LOG_H
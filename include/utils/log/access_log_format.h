@@ -0,0 +1,97 @@
+#ifndef ZENER_ACCESS_LOG_FORMAT_H
+#define ZENER_ACCESS_LOG_FORMAT_H
+
+/*
+    二进制访问日志的文件格式，服务器和解码工具（cmd/access_log_dump）共用
+    文件：AccessLogFileHeader + 若干条 [AccessRecord][path 字节]
+    字段按本机字节序写入，解码需在同一架构上进行
+*/
+
+#include <cstdint>
+#include <string_view>
+
+namespace zener {
+
+inline constexpr char ACCESS_LOG_MAGIC[8] = {'Z', 'A', 'C', 'C',
+                                             'L', 'O', 'G', '\0'};
+inline constexpr uint32_t ACCESS_LOG_VERSION = 1;
+inline constexpr uint16_t ACCESS_LOG_MAX_PATH = 1024; // 超长路径截断
+
+struct AccessLogFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize; // sizeof(AccessRecord)，便于以后扩展字段
+};
+
+enum class AccessMethod : uint8_t {
+    OTHER,
+    GET,
+    POST,
+    PUT,
+    DELETE,
+    HEAD,
+    OPTIONS,
+    PATCH,
+};
+
+struct AccessRecord {
+    int64_t timeNs;     // 请求开始时间（system_clock 纳秒）
+    uint64_t connId;    // 连接唯一 ID
+    uint32_t latencyUs; // 开始处理到响应写完的耗时
+    uint32_t bytes;     // 响应字节数（含头部）
+    uint16_t status;
+    uint16_t pathLen; // 紧随其后的 path 字节数
+    AccessMethod method;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(AccessRecord) == 32);
+
+constexpr AccessMethod AccessMethodOf(const std::string_view method) {
+    if (method == "GET") {
+        return AccessMethod::GET;
+    }
+    if (method == "POST") {
+        return AccessMethod::POST;
+    }
+    if (method == "PUT") {
+        return AccessMethod::PUT;
+    }
+    if (method == "DELETE") {
+        return AccessMethod::DELETE;
+    }
+    if (method == "HEAD") {
+        return AccessMethod::HEAD;
+    }
+    if (method == "OPTIONS") {
+        return AccessMethod::OPTIONS;
+    }
+    if (method == "PATCH") {
+        return AccessMethod::PATCH;
+    }
+    return AccessMethod::OTHER;
+}
+
+constexpr std::string_view AccessMethodName(const AccessMethod method) {
+    switch (method) {
+    case AccessMethod::GET:
+        return "GET";
+    case AccessMethod::POST:
+        return "POST";
+    case AccessMethod::PUT:
+        return "PUT";
+    case AccessMethod::DELETE:
+        return "DELETE";
+    case AccessMethod::HEAD:
+        return "HEAD";
+    case AccessMethod::OPTIONS:
+        return "OPTIONS";
+    case AccessMethod::PATCH:
+        return "PATCH";
+    default:
+        return "OTHER";
+    }
+}
+
+} // namespace zener
+
+#endif // !ZENER_ACCESS_LOG_FORMAT_H
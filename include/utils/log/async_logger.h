@@ -0,0 +1,295 @@
+#ifndef ZENER_ASYNC_LOGGER_H
+#define ZENER_ASYNC_LOGGER_H
+
+/*
+    异步日志后端
+    - 每个写日志的线程持有一个 SPSC 无锁环形缓冲区，调用线程只做参数捕获（memcpy）
+    - 格式化推迟到后台线程：记录里保存 fmt 字符串指针和一个按参数类型实例化的
+      解码函数，后台线程解码参数后再调用 fmt
+    - 单个后台写线程汇总所有线程的缓冲区，一轮一次 writev 批量写入文件
+    - 缓冲区满时按策略丢弃（DROP）或阻塞等待（BLOCK）
+
+    注意：fmt 字符串只保存指针，必须具有静态存储期（LOG_* 宏传入的都是字面量）。
+    字符串参数会被拷贝进缓冲区；非算术/字符串类型的参数在调用线程上先格式化成字符串。
+*/
+
+#include "spdlog/common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace zener {
+
+#define DEFAULT_ASYNC_QUEUE_SIZE (256 * 1024) // 每线程环形缓冲区 256KB
+
+enum class AsyncOverflowPolicy {
+    DROP,  // 缓冲区满时丢弃本条日志，只计数
+    BLOCK, // 缓冲区满时让出 CPU 等待后台线程腾出空间
+};
+
+namespace detail {
+
+// 把参数转换为可以按字节拷贝的形式：算术类型/普通指针原样保留，字符串转为
+// string_view（随后拷贝内容），其他类型在调用线程上先格式化为字符串
+inline std::string_view captureLogArg(const char *str) {
+    return str ? std::string_view(str) : std::string_view("(null)");
+}
+inline std::string_view captureLogArg(const std::string &str) { return str; }
+inline std::string_view captureLogArg(const std::string_view str) {
+    return str;
+}
+
+template <typename T>
+auto captureLogArg(const T &value) {
+    if constexpr (std::is_pointer_v<T> &&
+                  std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>,
+                                 char>) {
+        return value ? std::string_view(value) : std::string_view("(null)");
+    } else if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>) {
+        return value;
+    } else {
+        return fmt::format("{}", value);
+    }
+}
+
+template <typename T>
+inline constexpr bool IS_LOG_STRING_V =
+    std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>;
+
+// 参数编码：字符串为 [uint32 长度][内容]，其余类型直接 memcpy
+template <typename T>
+size_t encodedLogArgSize(const T &value) {
+    if constexpr (IS_LOG_STRING_V<T>) {
+        return sizeof(uint32_t) + value.size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+void encodeLogArg(char *&out, const T &value) {
+    if constexpr (IS_LOG_STRING_V<T>) {
+        const auto len = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &len, sizeof(len));
+        std::memcpy(out + sizeof(len), value.data(), len);
+        out += sizeof(len) + len;
+    } else {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+}
+
+template <typename T>
+auto decodeLogArg(const char *&in) {
+    if constexpr (IS_LOG_STRING_V<T>) {
+        uint32_t len = 0;
+        std::memcpy(&len, in, sizeof(len));
+        const std::string_view str(in + sizeof(len), len);
+        in += sizeof(len) + len;
+        return str;
+    } else {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+}
+
+// 后台线程调用：解码参数并格式化
+template <typename... Captured>
+void formatLogRecord(const char *payload, const std::string_view fmt,
+                     spdlog::memory_buf_t &dest) {
+    const char *in = payload;
+    // 花括号初始化保证从左到右求值
+    auto decoded = std::tuple<decltype(decodeLogArg<Captured>(in))...>{
+        decodeLogArg<Captured>(in)...};
+    std::apply(
+        [&](auto &...values) {
+            fmt::vformat_to(std::back_inserter(dest), fmt,
+                            fmt::make_format_args(values...));
+        },
+        decoded);
+}
+
+using LogFormatFn = void (*)(const char *payload, std::string_view fmt,
+                             spdlog::memory_buf_t &dest);
+
+// 环形缓冲区中每条记录都以此开头
+struct RingRecordPrefix {
+    uint32_t size;    // 记录总长度（含头部，8 字节对齐）
+    uint32_t padding; // 非 0 表示回绕填充，读端直接跳过
+};
+
+struct LogRecordHeader {
+    RingRecordPrefix prefix;
+    LogFormatFn format;
+    const char *fmt;
+    uint32_t fmtLen;
+    spdlog::source_loc loc;
+    spdlog::level::level_enum level;
+    size_t threadId;
+    int64_t timeNs; // system_clock 纳秒时间戳
+};
+
+// 单生产者（写日志线程）单消费者（后台线程）的字节环形缓冲区
+// 记录以 RingRecordPrefix 开头，异步日志和访问日志共用
+class LogRingBuffer {
+  public:
+    explicit LogRingBuffer(size_t capacity);
+
+    LogRingBuffer(const LogRingBuffer &) = delete;
+    LogRingBuffer &operator=(const LogRingBuffer &) = delete;
+
+    // 生产者：申请 len 字节连续空间，失败返回 nullptr
+    [[nodiscard]] char *Reserve(size_t len);
+    // 生产者：提交最近一次 Reserve 的空间
+    void Commit();
+
+    // 消费者：可读区间
+    [[nodiscard]] size_t Head() const {
+        return _head.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] size_t Tail() const {
+        return _tail.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] const char *At(const size_t pos) const {
+        return _data.get() + (pos & _mask);
+    }
+    void Release(const size_t head) {
+        _head.store(head, std::memory_order_release);
+    }
+
+    [[nodiscard]] size_t Capacity() const { return _mask + 1; }
+
+  private:
+    std::unique_ptr<char[]> _data;
+    size_t _mask;
+    size_t _pendingTail{0}; // 仅生产者访问
+
+    alignas(64) std::atomic<size_t> _head{0}; // 消费者写
+    alignas(64) std::atomic<size_t> _tail{0}; // 生产者写
+};
+
+struct LogThreadQueue {
+    explicit LogThreadQueue(size_t capacity) : ring(capacity) {}
+
+    LogRingBuffer ring;
+    std::atomic<bool> retired{false}; // 所属线程已退出，读空后回收
+};
+
+} // namespace detail
+
+class AsyncLogger {
+  public:
+    // 故意不析构：静态对象析构期间仍可能有线程写日志
+    static AsyncLogger &GetInstance() {
+        static auto *instance = new AsyncLogger();
+        return *instance;
+    }
+
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+    ~AsyncLogger() { Stop(); }
+
+    // filePath 为空时写到 stdout
+    bool Start(const std::string &filePath, size_t queueSize,
+               AsyncOverflowPolicy policy);
+    void Stop();
+    // 阻塞直到调用前提交的日志全部写出
+    void Flush();
+
+    [[nodiscard]] bool Running() const {
+        return _running.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] uint64_t Dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    void Push(const spdlog::source_loc &loc,
+              const spdlog::level::level_enum lvl, const std::string_view fmt,
+              Args &&...args) {
+        auto captured = std::make_tuple(detail::captureLogArg(args)...);
+        std::apply(
+            [&](const auto &...values) {
+                push<std::decay_t<decltype(values)>...>(loc, lvl, fmt,
+                                                       values...);
+            },
+            captured);
+    }
+
+  private:
+    AsyncLogger() = default;
+
+    template <typename... Captured>
+    void push(const spdlog::source_loc &loc,
+              const spdlog::level::level_enum lvl, const std::string_view fmt,
+              const Captured &...values) {
+        const size_t payload = (size_t{0} + ... +
+                                detail::encodedLogArgSize(values));
+        char *buf = reserve(sizeof(detail::LogRecordHeader) + payload);
+        if (!buf) {
+            return;
+        }
+        auto *header = reinterpret_cast<detail::LogRecordHeader *>(buf);
+        header->fmtLen = static_cast<uint32_t>(fmt.size());
+        header->format = &detail::formatLogRecord<Captured...>;
+        header->fmt = fmt.data();
+        header->loc = loc;
+        header->level = lvl;
+        header->threadId = threadId();
+        header->timeNs = nowNs();
+        [[maybe_unused]] char *out = buf + sizeof(detail::LogRecordHeader);
+        (detail::encodeLogArg(out, values), ...);
+        commit();
+    }
+
+    // 在当前线程的缓冲区中申请空间，处理满溢策略
+    char *reserve(size_t len);
+    void commit();
+
+    detail::LogThreadQueue *localQueue();
+    static size_t threadId();
+    static int64_t nowNs();
+
+    void backendLoop();
+    // 读空所有线程缓冲区并写出，返回写出的记录数
+    size_t drainOnce();
+
+    std::atomic<bool> _running{false};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _generation{0}; // 每次 Start 递增，使线程缓冲区失效
+    size_t _queueSize{DEFAULT_ASYNC_QUEUE_SIZE};
+    AsyncOverflowPolicy _policy{AsyncOverflowPolicy::DROP};
+    int _fd{-1};
+    bool _ownFd{false};
+
+    std::mutex _registryMtx; // 只在线程首次写日志和后台线程回收时使用
+    std::vector<std::shared_ptr<detail::LogThreadQueue>> _queues;
+    std::atomic<uint64_t> _registryVersion{0};
+
+    std::mutex _wakeMtx;
+    std::condition_variable _wakeCond; // 后台线程空闲等待 / Flush 等待
+    uint64_t _flushRequested{0};
+    uint64_t _flushDone{0};
+
+    std::thread _backend;
+};
+
+} // namespace zener
+
+#endif // !ZENER_ASYNC_LOGGER_H
@@ -3,12 +3,17 @@
 
 // #define FMT_UNSAFE_ARITHMETIC_FORMATTING
 
+#include "utils/log/async_logger.h"
+
 #include "spdlog/common.h"
 #include "spdlog/fmt/bundled/core.h"
 #include "spdlog/fmt/bundled/format.h"
 
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include <fmt/format.h>
 
@@ -21,6 +26,49 @@ namespace zener {
 #define DEFAULT_MAX_FILE_SIZE (50 * 1024 * 1024) // 50MB
 #define DEFAULT_MAX_FILES 10                     // 保留10个历史文件
 
+// 按模块过滤日志级别，模块由源文件路径在编译期确定
+enum class LogModule : uint8_t {
+    CORE,  // core/ 服务器、epoll
+    HTTP,  // http/ 连接、请求、响应
+    TIMER, // task/timer/ 定时器
+    DB,    // database/ 连接池
+    OTHER, // 其余（配置、缓冲区、线程池等）
+    COUNT,
+};
+
+// 源文件是否在 src/<dir> 或 include/<dir> 下；只认这两层，
+// 构建目录或依赖的路径里碰巧有同名目录时不会被误判
+constexpr bool LogPathUnder(const std::string_view file,
+                            const std::string_view dir) {
+    for (const std::string_view root :
+         {std::string_view("src/"), std::string_view("include/")}) {
+        for (size_t pos = file.find(root); pos != std::string_view::npos;
+             pos = file.find(root, pos + 1)) {
+            if ((pos == 0 || file[pos - 1] == '/') &&
+                file.substr(pos + root.size()).starts_with(dir)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+constexpr LogModule LogModuleOf(const std::string_view file) {
+    if (LogPathUnder(file, "task/timer/")) {
+        return LogModule::TIMER;
+    }
+    if (LogPathUnder(file, "core/")) {
+        return LogModule::CORE;
+    }
+    if (LogPathUnder(file, "http/")) {
+        return LogModule::HTTP;
+    }
+    if (LogPathUnder(file, "database/")) {
+        return LogModule::DB;
+    }
+    return LogModule::OTHER;
+}
+
 class Logger {
   public:
     static Logger *GetLoggerInstance() { return &_instance; }
@@ -45,12 +93,41 @@ class Logger {
                                         size_t max_size = DEFAULT_MAX_FILE_SIZE,
                                         size_t max_files = DEFAULT_MAX_FILES);
 
+    // 切换到异步模式：之后的日志由后台线程格式化并批量写入当前日志文件
+    // （未设置日志文件时写 stdout），不再经过控制台 sink
+    static bool StartAsync(size_t queueSize = DEFAULT_ASYNC_QUEUE_SIZE,
+                           AsyncOverflowPolicy policy = AsyncOverflowPolicy::DROP);
+    // 写出剩余日志并切回同步模式
+    static void StopAsync();
+
     static void Flush();
     static void Shutdown();
 
+    // 运行时级别过滤，在格式化参数之前检查
+    [[nodiscard]] static bool ShouldLog(const LogModule module,
+                                        const spdlog::level::level_enum lvl) {
+        return lvl >= _sModuleLevels[static_cast<size_t>(module)].load(
+                          std::memory_order_relaxed);
+    }
+    static void SetLevel(LogModule module, spdlog::level::level_enum lvl);
+    // 设置所有模块
+    static void SetLevel(spdlog::level::level_enum lvl);
+    // 按名字设置，module 为 core/http/timer/db/other/all，失败返回 false
+    static bool SetLevel(std::string_view module, std::string_view level);
+    [[nodiscard]] static spdlog::level::level_enum
+    GetLevel(LogModule module);
+    // 解析级别名（trace/debug/info/warn/error/critical/off，兼容 DEBUG/RELEASE）
+    [[nodiscard]] static bool ParseLevel(std::string_view name,
+                                         spdlog::level::level_enum &lvl);
+
     template <typename... Args>
     void Log(const spdlog::source_loc loc, const spdlog::level::level_enum lvl,
              std::string_view fmt, Args &&...args) {
+        if (_sAsync.load(std::memory_order_relaxed)) {
+            AsyncLogger::GetInstance().Push(loc, lvl, fmt,
+                                            std::forward<Args>(args)...);
+            return;
+        }
         spdlog::memory_buf_t buf;
         fmt::vformat_to(std::back_inserter(buf), fmt,
                         fmt::make_format_args(args...));
@@ -61,6 +138,9 @@ class Logger {
     [[nodiscard]] static std::string GetLogFileName() { return _logFileName; }
     [[nodiscard]] static std::string GetLogDirectory() { return _logDirectory; }
     [[nodiscard]] static bool Initialized() { return _sInitialized; }
+    [[nodiscard]] static bool Async() {
+        return _sAsync.load(std::memory_order_relaxed);
+    }
 
   private:
     Logger() = default;
@@ -77,12 +157,28 @@ class Logger {
     static std::string _logDirectory; // 日志文件存储目录
     static std::string _filePrefix;   // 日志文件名前缀，默认为"zener"
     static std::atomic<bool> _sInitialized;
+    static std::atomic<bool> _sAsync; // 是否使用异步后端
+    static std::array<std::atomic<int>, static_cast<size_t>(LogModule::COUNT)>
+        _sModuleLevels;
     static bool _usingRotation; // 是否使用日志轮转
 };
 
+// 编译期级别下限（spdlog::level 的数值），低于它的日志调用连同参数求值一起被消除
+#ifndef ZENER_LOG_ACTIVE_LEVEL
+#define ZENER_LOG_ACTIVE_LEVEL 0 // trace
+#endif
+
 #define ZENER_LOG_LOGGER_CALL(zener_log, level, ...)                           \
-    (zener_log)->Log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},  \
-                     level, __VA_ARGS__)
+    do {                                                                       \
+        if constexpr (static_cast<int>(level) >= ZENER_LOG_ACTIVE_LEVEL) {     \
+            constexpr auto zenerLogModule = zener::LogModuleOf(__FILE__);      \
+            if (zener::Logger::ShouldLog(zenerLogModule, level)) {             \
+                (zener_log)->Log(                                              \
+                    spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION},   \
+                    level, __VA_ARGS__);                                       \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
 
 } // namespace zener
 
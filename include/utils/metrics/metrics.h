@@ -0,0 +1,185 @@
+#ifndef ZENER_METRICS_H
+#define ZENER_METRICS_H
+
+/*
+    运行时指标：计数器、仪表盘、对数线性直方图
+    - 计数器和直方图按线程分片，热路径上只做一次 relaxed 原子加
+    - 抓取（/metrics）时才汇总各分片，输出 Prometheus 文本格式
+    - 指标对象在 Registry 中注册后地址不变，调用方缓存引用即可
+*/
+
+#include "common.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace zener::metrics {
+
+inline constexpr size_t METRIC_SHARDS = 8;
+
+// 当前线程使用的分片下标，首次调用时按线程轮流分配
+size_t ShardIndex();
+
+class Counter {
+  public:
+    void Inc(const uint64_t n = 1) {
+        _shards[ShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t Value() const;
+
+  private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, METRIC_SHARDS> _shards{};
+};
+
+class Gauge {
+  public:
+    void Set(const int64_t v) { _value.store(v, std::memory_order_relaxed); }
+    void Add(const int64_t n = 1) {
+        _value.fetch_add(n, std::memory_order_relaxed);
+    }
+    void Sub(const int64_t n = 1) {
+        _value.fetch_sub(n, std::memory_order_relaxed);
+    }
+    _ZENER_SHORT_FUNC int64_t Value() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    alignas(64) std::atomic<int64_t> _value{0};
+};
+
+/*
+    HDR 风格的对数线性直方图，记录整数微秒
+    每个 2 的幂区间再线性分为 SUB_BUCKETS 个桶，相对误差不超过 1/8
+    导出时只在 2 的幂边界输出 le，保证各次抓取的桶边界一致
+*/
+class Histogram {
+  public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr size_t GROUPS = 31; // 最大约 2^33 微秒
+    static constexpr size_t BUCKETS = SUB_BUCKETS * GROUPS;
+
+    void Record(uint64_t us);
+
+    template <typename Duration>
+    void Record(const Duration d) {
+        const auto us =
+            std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        Record(static_cast<uint64_t>(us > 0 ? us : 0));
+    }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count{0};
+        uint64_t sum{0};
+        // 分位数（微秒），返回所在桶的上界
+        [[nodiscard]] uint64_t Quantile(double q) const;
+    };
+    [[nodiscard]] Snapshot Collect() const;
+
+    static size_t BucketOf(uint64_t us);
+    // 桶内最大值（含）
+    static uint64_t BucketUpper(size_t index);
+
+  private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+    };
+    std::array<Shard, METRIC_SHARDS> _shards{};
+};
+
+// 统计一段作用域的耗时
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(Histogram &histogram)
+        : _histogram(histogram), _start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        _histogram.Record(std::chrono::steady_clock::now() - _start);
+    }
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  private:
+    Histogram &_histogram;
+    std::chrono::steady_clock::time_point _start;
+};
+
+class Registry {
+  public:
+    _ZENER_SHORT_FUNC static Registry &GetInstance() {
+        static Registry instance;
+        return instance;
+    }
+
+    Registry(const Registry &) = delete;
+    Registry &operator=(const Registry &) = delete;
+
+    // 同名重复注册返回已有对象
+    Counter &NewCounter(const std::string &name, const std::string &help);
+    Gauge &NewGauge(const std::string &name, const std::string &help);
+    Histogram &NewHistogram(const std::string &name, const std::string &help);
+    // 抓取时调用 fn 取值，用于队列长度等已有状态
+    void NewCallbackGauge(const std::string &name, const std::string &help,
+                          std::function<double()> fn);
+    // 移除回调仪表盘（回调捕获的对象析构前调用）
+    void RemoveCallbackGauge(const std::string &name);
+
+    // Prometheus text exposition format 0.0.4
+    [[nodiscard]] std::string Render() const;
+
+  private:
+    Registry() = default;
+
+    enum class Kind { COUNTER, GAUGE, HISTOGRAM, CALLBACK };
+    struct Entry {
+        std::string name;
+        std::string help;
+        Kind kind;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> callback;
+    };
+    Entry *find(const std::string &name);
+
+    mutable std::mutex _mtx; // 只在注册和抓取时使用
+    std::vector<std::unique_ptr<Entry>> _entries;
+};
+
+// 服务器内置指标，首次调用时注册
+struct ServerMetrics {
+    Counter &accepted;
+    Counter &acceptDropped;
+    Counter &limitedConns;
+    Counter &limitedRequests;
+    Counter &overloadShed;
+    Counter &requests;
+    Counter &bytesIn;
+    Counter &bytesOut;
+    Counter &fileCacheHits;
+    Counter &fileCacheMisses;
+    Counter &responseCacheHits;
+    Counter &responseCacheMisses;
+    Counter &responseCacheCoalesced;
+    Histogram &parseTime;
+    Histogram &handlerTime;
+    Histogram &sqlWait;
+};
+ServerMetrics &Server();
+
+} // namespace zener::metrics
+
+#endif // !ZENER_METRICS_H
@@ -0,0 +1,114 @@
+#ifndef ZENER_MPMC_QUEUE_HPP
+#define ZENER_MPMC_QUEUE_HPP
+
+/*
+    有界无锁多生产者多消费者队列（Dmitry Vyukov 的环形数组实现）
+    每个槽位带一个序号，生产者/消费者各自 CAS 推进位置，
+    不需要互斥锁，也没有 ABA 问题。
+    容量向上取整为 2 的幂；满时 TryPush 返回 false，由调用者决定退路。
+*/
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace zener {
+
+template <typename T>
+class MpmcQueue {
+  public:
+    explicit MpmcQueue(const size_t capacity)
+        : _mask(roundUpPow2(capacity) - 1),
+          _cells(new Cell[_mask + 1]) {
+        for (size_t i = 0; i <= _mask; ++i) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    template <typename U>
+    bool TryPush(U &&value) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 满
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T &out) {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                              static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 空
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->data = T{}; // 及时释放捕获的资源
+        cell->seq.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似长度，仅用于监控
+    [[nodiscard]] size_t SizeApprox() const {
+        const size_t tail = _enqueuePos.load(std::memory_order_relaxed);
+        const size_t head = _dequeuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const { return _mask + 1; }
+
+  private:
+    static size_t roundUpPow2(const size_t n) {
+        size_t cap = 2;
+        while (cap < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    struct alignas(64) Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t _mask;
+    const std::unique_ptr<Cell[]> _cells;
+    alignas(64) std::atomic<size_t> _enqueuePos{0};
+    alignas(64) std::atomic<size_t> _dequeuePos{0};
+};
+
+} // namespace zener
+
+#endif // !ZENER_MPMC_QUEUE_HPP
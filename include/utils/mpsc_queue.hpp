@@ -0,0 +1,78 @@
+#ifndef ZENER_MPSC_QUEUE_HPP
+#define ZENER_MPSC_QUEUE_HPP
+
+/*
+    无界无锁多生产者单消费者队列（侵入式链表栈 + 整批取走）
+    - 生产者 Push 只需一次 CAS 把节点压到栈顶
+    - 消费者 Drain 用一次 exchange 取走整条链，反转后按 FIFO 顺序回调
+    消费者一次只处理一批，适合事件循环每轮集中处理跨线程命令。
+    Push 返回 true 表示队列此前为空，调用方可据此决定是否需要唤醒消费者。
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace zener {
+
+template <typename T>
+class MpscQueue {
+  public:
+    MpscQueue() = default;
+    ~MpscQueue() {
+        Drain([](T &) {});
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // 任意线程调用
+    bool Push(T value) {
+        auto *node = new Node{std::move(value), nullptr};
+        Node *head = _head.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!_head.compare_exchange_weak(head, node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    // 仅消费者线程调用，返回处理的元素个数
+    template <typename F>
+    size_t Drain(F &&fn) {
+        Node *node = _head.exchange(nullptr, std::memory_order_acquire);
+        Node *fifo = nullptr;
+        while (node) { // 栈是后进先出，先反转
+            Node *next = node->next;
+            node->next = fifo;
+            fifo = node;
+            node = next;
+        }
+        size_t count = 0;
+        while (fifo) {
+            Node *next = fifo->next;
+            fn(fifo->value);
+            delete fifo;
+            fifo = next;
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool Empty() const {
+        return _head.load(std::memory_order_acquire) == nullptr;
+    }
+
+  private:
+    struct Node {
+        T value;
+        Node *next;
+    };
+
+    std::atomic<Node *> _head{nullptr};
+};
+
+} // namespace zener
+
+#endif // !ZENER_MPSC_QUEUE_HPP
@@ -19,6 +19,10 @@ PORT=1316
 CONNECTIONS=1000
 DURATION=10
 URL_PATH="/"
+THREADS=4
+RATE=0
+PIPELINE=1
+JSON=false
 START_SERVER=true
 
 # 帮助函数
@@ -32,12 +36,17 @@ function show_help {
     echo -e "  -c, --connections <num> 并发连接数 [默认: 1000]"
     echo -e "  -d, --duration <sec>    测试持续时间(秒) [默认: 10]"
     echo -e "  -u, --url <path>        请求URL路径 [默认: /]"
+    echo -e "  -T, --threads <num>     压测线程数 [默认: 4]"
+    echo -e "  -r, --rate <num>        开环恒定速率(请求/秒), 0 为闭环 [默认: 0]"
+    echo -e "  -P, --pipeline <num>    每条连接的流水线深度 [默认: 1]"
+    echo -e "  -j, --json              结果输出为 JSON"
     echo -e "  -n, --no-start          不自动启动服务器(假设服务器已运行)"
     echo -e "  -h, --help              显示此帮助信息"
     echo ""
     echo -e "示例:"
     echo -e "  $0 -t map -c 5000 -d 30       运行MAP定时器版本压力测试,5000并发,30秒"
     echo -e "  $0 -t heap -p 8080 -n         在端口8080测试已运行的HEAP定时器版本"
+    echo -e "  $0 -n -c 100 -r 20000         开环 20000 请求/秒, 看延迟分位数"
     echo ""
     exit 0
 }
@@ -65,6 +74,22 @@ while [[ $# -gt 0 ]]; do
             URL_PATH="$2"
             shift 2
             ;;
+        -T|--threads)
+            THREADS="$2"
+            shift 2
+            ;;
+        -r|--rate)
+            RATE="$2"
+            shift 2
+            ;;
+        -P|--pipeline)
+            PIPELINE="$2"
+            shift 2
+            ;;
+        -j|--json)
+            JSON=true
+            shift
+            ;;
         -n|--no-start)
             START_SERVER=false
             shift
@@ -100,12 +125,11 @@ if ! [[ "$DURATION" =~ ^[0-9]+$ ]] || [ "$DURATION" -lt 1 ]; then
     exit 1
 fi
 
-# 检查webbench是否可用
-if [ ! -f "./webbench-1.5/webbench" ]; then
-    echo -e "${YELLOW}警告: webbench未找到, 请确保WebBench已安装${NC}"
-    echo -e "${BLUE}可以通过以下命令安装WebBench:${NC}"
-    echo -e "  git clone https://github.com/EZLippi/WebBench.git webbench-1.5"
-    echo -e "  cd webbench-1.5 && make"
+# 检查压测工具是否可用
+BENCH="bin/zener_bench"
+if [ ! -f "$BENCH" ]; then
+    echo -e "${YELLOW}警告: ${BENCH} 未找到, 请先构建 zener_bench 目标${NC}"
+    echo -e "  cmake -S . -B build && cmake --build build --target zener_bench"
     exit 1
 fi
 
@@ -169,7 +193,16 @@ fi
 
 # 构建URL
 TEST_URL="http://127.0.0.1:${PORT}${URL_PATH}"
-RESULT_FILE="results/benchmark_${TIMER_TYPE}_c${CONNECTIONS}_d${DURATION}_$(date +"%Y%m%d_%H%M%S").txt"
+RESULT_EXT=txt
+BENCH_ARGS=(-c "$CONNECTIONS" -t "$THREADS" -d "$DURATION" -p "$PIPELINE")
+if [ "$RATE" != "0" ]; then
+    BENCH_ARGS+=(-R "$RATE")
+fi
+if [ "$JSON" = true ]; then
+    BENCH_ARGS+=(--json)
+    RESULT_EXT=json
+fi
+RESULT_FILE="results/benchmark_${TIMER_TYPE}_c${CONNECTIONS}_d${DURATION}_$(date +"%Y%m%d_%H%M%S").${RESULT_EXT}"
 
 # 运行基准测试
 echo -e "${CYAN}开始性能测试:${NC}"
@@ -177,10 +210,12 @@ echo -e "  服务器类型:    ${BLUE}${TIMER_TYPE} 定时器${NC}"
 echo -e "  URL:          ${BLUE}${TEST_URL}${NC}"
 echo -e "  并发连接数:    ${BLUE}${CONNECTIONS}${NC}"
 echo -e "  持续时间:      ${BLUE}${DURATION}秒${NC}"
+echo -e "  速率:          ${BLUE}$([ "$RATE" = "0" ] && echo "闭环" || echo "${RATE} 请求/秒")${NC}"
+echo -e "  流水线深度:    ${BLUE}${PIPELINE}${NC}"
 echo -e "${YELLOW}正在运行测试...${NC}"
 
 # 执行测试并保存结果
-./webbench-1.5/webbench -c "$CONNECTIONS" -t "$DURATION" "$TEST_URL" | tee "$RESULT_FILE"
+"$BENCH" "${BENCH_ARGS[@]}" "$TEST_URL" | tee "$RESULT_FILE"
 
 # 测试完成
 echo -e "\n${GREEN}测试完成!${NC}"
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""运行 zener_microbench 并与保存的基线对比，任何一项变慢超过阈值即以 1 退出。
+
+    scripts/microbench_compare.py --save            # 在当前机器上生成基线
+    scripts/microbench_compare.py                   # 对比基线
+    scripts/microbench_compare.py -f 'Request|Router' -t 5
+    scripts/microbench_compare.py --result out.json # 只对比已有结果，不重新运行
+
+基线与机器、编译选项强相关，只在同一台机器、同一构建类型下对比才有意义。
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+PROJECT_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def run_bench(binary, bench_filter, repetitions, min_time):
+    fd, out = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+    cmd = [
+        binary,
+        "--benchmark_out=" + out,
+        "--benchmark_out_format=json",
+        "--benchmark_repetitions=%d" % repetitions,
+        "--benchmark_report_aggregates_only=true",
+    ]
+    if bench_filter:
+        cmd.append("--benchmark_filter=" + bench_filter)
+    if min_time:
+        cmd.append("--benchmark_min_time=%s" % min_time)
+    try:
+        subprocess.run(cmd, check=True)
+        with open(out) as f:
+            return json.load(f)
+    finally:
+        os.unlink(out)
+
+
+def load_times(result):
+    """名字 -> 每次迭代的 real_time（纳秒）。重复运行时取中位数，单次运行取原值。"""
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    times = {}
+    medians = {}
+    for b in result.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        t = b["real_time"] * scale.get(b.get("time_unit", "ns"), 1.0)
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[b["run_name"]] = t
+        else:
+            times[b.get("run_name", b["name"])] = t
+    times.update(medians)
+    return times
+
+
+def fmt_ns(ns):
+    for unit, div in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= div:
+            return "%.2f%s" % (ns / div, unit)
+    return "%.1fns" % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(description="zener 微基准与基线对比")
+    parser.add_argument("-b", "--binary",
+                        default=os.path.join(PROJECT_ROOT, "bin", "zener_microbench"))
+    parser.add_argument("--baseline",
+                        default=os.path.join(PROJECT_ROOT, "bench", "baseline.json"))
+    parser.add_argument("-f", "--filter", default="", help="--benchmark_filter 正则")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="允许的变慢百分比 [默认: 10]")
+    parser.add_argument("-r", "--repetitions", type=int, default=3,
+                        help="每项重复次数，取中位数 [默认: 3]")
+    parser.add_argument("--min-time", default="", help="--benchmark_min_time")
+    parser.add_argument("--result", help="已有的 JSON 结果，不再运行基准")
+    parser.add_argument("--save", action="store_true", help="把本次结果写为基线")
+    args = parser.parse_args()
+
+    if args.result:
+        with open(args.result) as f:
+            result = json.load(f)
+    else:
+        if not os.access(args.binary, os.X_OK):
+            sys.exit("%s 未找到, 请先构建 zener_microbench 目标:\n"
+                     "  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && "
+                     "cmake --build build --target zener_microbench" % args.binary)
+        result = run_bench(args.binary, args.filter, args.repetitions, args.min_time)
+
+    if args.save:
+        with open(args.baseline, "w") as f:
+            json.dump(result, f, indent=2)
+        print("基线已保存到 %s" % args.baseline)
+        return 0
+
+    if not os.path.exists(args.baseline):
+        sys.exit("基线 %s 不存在, 先用 --save 生成" % args.baseline)
+    with open(args.baseline) as f:
+        base = load_times(json.load(f))
+    current = load_times(result)
+
+    regressions = 0
+    width = max((len(n) for n in current), default=10)
+    print("%-*s %12s %12s %9s" % (width, "benchmark", "baseline", "current", "change"))
+    for name, t in current.items():
+        if name not in base:
+            print("%-*s %12s %12s %9s" % (width, name, "-", fmt_ns(t), "new"))
+            continue
+        change = (t - base[name]) / base[name] * 100.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-*s %12s %12s %+8.1f%%%s"
+              % (width, name, fmt_ns(base[name]), fmt_ns(t), change, mark))
+
+    if regressions:
+        print("\n%d 项变慢超过 %.1f%%" % (regressions, args.threshold))
+        return 1
+    print("\n没有超过 %.1f%% 的退化" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
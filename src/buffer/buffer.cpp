@@ -1,16 +1,18 @@
 #include "buffer/buffer.h"
 
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 #include <strings.h>
 
 namespace zener {
 
-Buffer::Buffer(size_t size) : _buffer(size), _readPos(0), _writePos(0) {
+Buffer::Buffer(size_t size) : _initSize(size), _readPos(0), _writePos(0) {
     // _prePos(INIT_PREPEND_SIZE)
 }
 
-Buffer::Buffer(Buffer &&other) noexcept : _buffer(std::move(other._buffer)) {
+Buffer::Buffer(Buffer &&other) noexcept
+    : _buffer(std::move(other._buffer)), _initSize(other._initSize) {
     // 使用原子操作来安全地设置值
     _readPos.store(other._readPos.load(std::memory_order_acquire),
                    std::memory_order_release);
@@ -26,6 +28,7 @@ Buffer::Buffer(Buffer &&other) noexcept : _buffer(std::move(other._buffer)) {
 Buffer &Buffer::operator=(Buffer &&other) noexcept {
     if (this != &other) {
         _buffer = std::move(other._buffer);
+        _initSize = other._initSize;
         _readPos.store(other._readPos.load(std::memory_order_acquire),
                        std::memory_order_release);
         _writePos.store(other._writePos.load(std::memory_order_acquire),
@@ -91,6 +94,9 @@ void Buffer::Append(const Buffer &buff) {
 }
 
 void Buffer::EnsureWritable(const size_t len) {
+    if (_buffer.empty()) { // 首次写入，在当前线程分配
+        _buffer.resize(std::max(_initSize, len));
+    }
     if (WritableBytes() < len) {
         makeSpace(len);
     }
@@ -7,26 +7,25 @@
 
 namespace zener {
 
-Epoller::Epoller(const int maxEvent, const bool isET)
-    : _isET(isET), _epollFd(epoll_create(512)), _events(maxEvent) {
+Epoller::Epoller(const int maxEvent)
+    : _epollFd(epoll_create1(EPOLL_CLOEXEC)), _events(maxEvent) {
     assert(_epollFd >= 0 && !_events.empty());
 }
 
 Epoller::~Epoller() { close(_epollFd); }
 
-bool Epoller::AddFd(const int fd, const uint32_t events) const {
+bool Epoller::AddFd(const int fd, const uint32_t events) {
     if (fd < 0) {
         return false;
     }
     epoll_event ev = {};
     ev.data.fd = fd;
+    // 触发方式由调用方决定（连接 fd 为 EPOLLIN|EPOLLOUT|EPOLLET|EPOLLRDHUP）
     ev.events = events;
-    // 此处是连接 fd，设置 EPOLLET 代表要循环读取数据
-    ev.events = _isET ? EPOLLIN | EPOLLET : EPOLLIN;
     return 0 == epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev);
 }
 
-bool Epoller::ModFd(const int fd, const uint32_t events) const {
+bool Epoller::ModFd(const int fd, const uint32_t events) {
     if (fd < 0) {
         return false;
     }
@@ -36,7 +35,7 @@ bool Epoller::ModFd(const int fd, const uint32_t events) const {
     return 0 == epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev);
 }
 
-bool Epoller::DelFd(const int fd) const {
+bool Epoller::DelFd(const int fd) {
     assert(fd >= 0);
     if (fd < 0) {
         LOG_W("Deleting invalid fd:{} from epoll!", fd);
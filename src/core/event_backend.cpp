@@ -0,0 +1,23 @@
+#include "core/event_backend.h"
+#include "core/epoller.h"
+#include "core/uring_poller.h"
+#include "utils/log/logger.h"
+
+namespace zener {
+
+std::unique_ptr<EventBackend> NewEventBackend(const EventBackendOptions &opts) {
+    if (opts.kind == "io_uring") {
+        auto uring = std::make_unique<UringPoller>(
+            opts.maxEvents, opts.uringEntries, opts.uringSqpoll,
+            opts.uringCompletion);
+        if (uring->Ok()) {
+            return uring;
+        }
+        LOG_W("io_uring unavailable, falling back to epoll.");
+    } else if (opts.kind != "epoll") {
+        LOG_W("Unknown event backend \"{}\", using epoll.", opts.kind);
+    }
+    return std::make_unique<Epoller>(opts.maxEvents);
+}
+
+} // namespace zener
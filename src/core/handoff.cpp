@@ -0,0 +1,143 @@
+#include "core/handoff.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace zener::handoff {
+
+namespace {
+
+bool makeAddr(const std::string &path, sockaddr_un &addr) {
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+} // namespace
+
+int Listen(const std::string &path) {
+    sockaddr_un addr{};
+    if (!makeAddr(path, addr)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    const int sock =
+        socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    unlink(path.c_str());
+    if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(sock, 4) != 0) {
+        const int err = errno;
+        close(sock);
+        errno = err;
+        return -1;
+    }
+    return sock;
+}
+
+int Receive(const std::string &path) {
+    sockaddr_un addr{};
+    if (!makeAddr(path, addr)) {
+        return -1;
+    }
+    const int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    if (connect(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+        0) {
+        close(sock); // 没有前任（ENOENT/ECONNREFUSED）
+        return -1;
+    }
+    // 旧进程卡死时不要让新进程一直等下去
+    timeval tv{5, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char byte = 0;
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    int fd = -1;
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) > 0) {
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+                std::memcpy(&fd, CMSG_DATA(c), sizeof(int));
+            }
+        }
+    }
+    close(sock);
+    return fd;
+}
+
+bool Send(const int sock, const int fd) {
+    char byte = 'L';
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr *c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == 1;
+}
+
+int SpawnSelf() {
+    // /proc/self/cmdline 是以 '\0' 分隔的参数列表
+    std::ifstream in("/proc/self/cmdline", std::ios::binary);
+    const std::string cmdline{std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>()};
+    std::vector<std::string> args;
+    for (size_t pos = 0; pos < cmdline.size();) {
+        const size_t end = cmdline.find('\0', pos);
+        args.emplace_back(cmdline.substr(pos, end - pos));
+        pos = end == std::string::npos ? cmdline.size() : end + 1;
+    }
+    if (args.empty()) {
+        args.emplace_back("/proc/self/exe");
+    }
+    std::vector<char *> argv;
+    for (auto &arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+    // 解析出真实路径，否则新进程的进程名会变成 "exe"
+    char exe[PATH_MAX]{};
+    if (readlink("/proc/self/exe", exe, sizeof(exe) - 1) <= 0) {
+        return -1;
+    }
+    pid_t pid = -1;
+    if (const int err =
+            posix_spawn(&pid, exe, nullptr, nullptr, argv.data(), environ);
+        err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+} // namespace zener::handoff
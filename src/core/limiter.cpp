@@ -0,0 +1,161 @@
+#include "core/limiter.h"
+#include "utils/log/logger.h"
+
+#include <algorithm>
+
+namespace zener {
+
+namespace {
+
+// 32 位整数混洗（murmur3 的 fmix32），让相邻网段的地址分散到不同分片
+uint32_t mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bU;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35U;
+    x ^= x >> 16;
+    return x;
+}
+
+constexpr uint64_t TOKEN = 1000; // 一个令牌，桶里以千分之一令牌计
+
+// 别的线程可能刚用稍晚的时间戳更新过桶，这时按没有经过时间算
+uint64_t elapsed(const uint32_t now, const uint32_t last) {
+    const auto d = static_cast<int32_t>(now - last);
+    return d > 0 ? static_cast<uint64_t>(d) : 0;
+}
+
+} // namespace
+
+ClientLimiter::ClientLimiter(const LimiterOptions &opts)
+    : _maxConns(opts.maxConnsPerIp), _rate(opts.rate),
+      _burst(std::min<uint64_t>(opts.burst > 0 ? opts.burst : opts.rate,
+                                UINT32_MAX / TOKEN) *
+             TOKEN),
+      _shardSize(std::max<uint32_t>((opts.tableSize + SHARDS - 1) / SHARDS, 1)),
+      _epoch(std::chrono::steady_clock::now()) {
+    if (Enabled()) {
+        _slots = std::make_unique<Slot[]>(static_cast<size_t>(_shardSize) *
+                                          SHARDS);
+    }
+}
+
+bool ClientLimiter::Admit(const uint32_t ip, int &slot) {
+    slot = UNTRACKED;
+    if (!Enabled() || ip == 0) {
+        return true;
+    }
+    const uint32_t h = mix(ip);
+    const uint32_t base = (h % SHARDS) * _shardSize;
+    const uint32_t probes = std::min<uint32_t>(MAX_PROBES, _shardSize);
+    // 回收会在探测序列中间留下空槽，所以总是探测完整个序列再决定插入位置
+    int empty = UNTRACKED;
+    for (uint32_t i = 0; i < probes; ++i) {
+        const int idx = static_cast<int>(base + (h / SHARDS + i) % _shardSize);
+        Slot &s = _slots[idx];
+        const uint32_t cur = s.ip.load(std::memory_order_relaxed);
+        if (cur == ip) {
+            const uint32_t conns = s.conns.load(std::memory_order_relaxed);
+            if (_maxConns > 0 && conns >= _maxConns) {
+                return false;
+            }
+            s.conns.store(conns + 1, std::memory_order_relaxed);
+            slot = idx;
+            return true;
+        }
+        if (cur == 0 && empty == UNTRACKED) {
+            empty = idx;
+        }
+    }
+    if (empty == UNTRACKED) {
+        if (!_fullLogged) { // 直到下次有槽被回收前只记一次
+            LOG_W("Client limiter table full, new clients are not limited.");
+            _fullLogged = true;
+        }
+        return true;
+    }
+    Slot &s = _slots[empty];
+    s.conns.store(1, std::memory_order_relaxed);
+    // 槽交给连接之前写好，工作线程经由任务派发看到它
+    s.bucket.store(fullBucket(nowMs()), std::memory_order_relaxed);
+    s.ip.store(ip, std::memory_order_release);
+    slot = empty;
+    return true;
+}
+
+void ClientLimiter::Release(const int slot) {
+    if (slot == UNTRACKED) {
+        return;
+    }
+    Slot &s = _slots[slot];
+    if (const uint32_t conns = s.conns.load(std::memory_order_relaxed);
+        conns > 0) {
+        s.conns.store(conns - 1, std::memory_order_relaxed);
+    }
+}
+
+bool ClientLimiter::Acquire(const int slot) {
+    if (slot == UNTRACKED || _rate == 0) {
+        return true;
+    }
+    std::atomic<uint64_t> &bucket = _slots[slot].bucket;
+    const uint32_t now = nowMs();
+    uint64_t cur = bucket.load(std::memory_order_relaxed);
+    while (true) {
+        const auto last = static_cast<uint32_t>(cur >> 32);
+        const uint64_t tokens =
+            std::min<uint64_t>((cur & UINT32_MAX) + elapsed(now, last) * _rate,
+                               _burst);
+        if (tokens < TOKEN) {
+            return false; // 不更新时间戳，补充从上次取令牌的时刻继续累计
+        }
+        const uint64_t next = static_cast<uint64_t>(now) << 32 | (tokens - TOKEN);
+        if (bucket.compare_exchange_weak(cur, next, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+void ClientLimiter::Sweep() {
+    if (!Enabled()) {
+        return;
+    }
+    const uint32_t now = nowMs();
+    if (now - _lastSweep < SWEEP_INTERVAL_MS) {
+        return;
+    }
+    _lastSweep = now;
+    const uint32_t base = static_cast<uint32_t>(_nextSweep) * _shardSize;
+    _nextSweep = (_nextSweep + 1) % SHARDS;
+    for (uint32_t i = 0; i < _shardSize; ++i) {
+        Slot &s = _slots[base + i];
+        if (s.ip.load(std::memory_order_relaxed) != 0 &&
+            s.conns.load(std::memory_order_relaxed) == 0 && idle(s, now)) {
+            s.ip.store(0, std::memory_order_relaxed);
+            _fullLogged = false;
+        }
+    }
+}
+
+uint32_t ClientLimiter::nowMs() const {
+    // 约 49 天回绕一次，间隔都按差值计算
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - _epoch)
+            .count());
+}
+
+uint64_t ClientLimiter::fullBucket(const uint32_t now) const {
+    return static_cast<uint64_t>(now) << 32 | _burst;
+}
+
+bool ClientLimiter::idle(const Slot &slot, const uint32_t now) const {
+    if (_rate == 0) {
+        return true;
+    }
+    const uint64_t cur = slot.bucket.load(std::memory_order_relaxed);
+    const auto last = static_cast<uint32_t>(cur >> 32);
+    return (cur & UINT32_MAX) + elapsed(now, last) * _rate >= _burst;
+}
+
+} // namespace zener
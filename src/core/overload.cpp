@@ -0,0 +1,89 @@
+#include "core/overload.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace zener {
+
+namespace {
+
+constexpr uint32_t PERMILLE = 1000;
+
+// 每个线程各自的 xorshift 状态，拒绝判断不需要同步
+uint32_t nextRandom() {
+    thread_local uint32_t state =
+        static_cast<uint32_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count()) |
+        1U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+OverloadGuard::OverloadGuard(const OverloadOptions &opts)
+    : _loopLagUs(static_cast<int64_t>(opts.loopLagMs) * 1000),
+      _queueDelayUs(static_cast<int64_t>(opts.queueDelayMs) * 1000),
+      _shedStep(std::clamp<uint32_t>(opts.shedStep, 1, PERMILLE)),
+      _closeKeepAlive(opts.closeKeepAlive) {}
+
+bool OverloadGuard::Tick(const int64_t busyUs) {
+    // 滑动平均，权重 1/8：单独一轮慢不至于触发
+    const int64_t lag = _lagUs.load(std::memory_order_relaxed);
+    _lagUs.store(lag + (busyUs - lag) / 8, std::memory_order_relaxed);
+
+    const int64_t now = NowUs();
+    if (now - _lastSample < SAMPLE_MS * 1000) {
+        return false;
+    }
+    _lastSample = now;
+    int64_t age = _probeAgeUs.load(std::memory_order_relaxed);
+    if (const int64_t sent = _probeSent.load(std::memory_order_acquire);
+        sent != 0) {
+        age = std::max(age, now - sent);
+    }
+    _ageUs.store(age, std::memory_order_relaxed);
+
+    _overloaded = (_loopLagUs > 0 && _lagUs.load(std::memory_order_relaxed) >
+                                         _loopLagUs) ||
+                  (_queueDelayUs > 0 && age > _queueDelayUs);
+    const uint32_t shed = _shed.load(std::memory_order_relaxed);
+    uint32_t next = 0;
+    if (_overloaded) {
+        next = std::min(shed + _shedStep, PERMILLE);
+    } else if (shed * 3 / 4 >= _shedStep / 4) { // 降到一步的四分之一以下直接归零
+        next = shed * 3 / 4;
+    }
+    _shed.store(next, std::memory_order_relaxed);
+    return true;
+}
+
+int64_t OverloadGuard::StartProbe() {
+    if (_queueDelayUs <= 0 ||
+        _probeSent.load(std::memory_order_relaxed) != 0) {
+        return 0;
+    }
+    const int64_t now = NowUs();
+    _probeSent.store(now, std::memory_order_relaxed);
+    return now;
+}
+
+void OverloadGuard::FinishProbe(const int64_t stamp) {
+    _probeAgeUs.store(NowUs() - stamp, std::memory_order_relaxed);
+    _probeSent.store(0, std::memory_order_release);
+}
+
+bool OverloadGuard::Shed() const {
+    const uint32_t shed = _shed.load(std::memory_order_relaxed);
+    return shed > 0 && nextRandom() % PERMILLE < shed;
+}
+
+int64_t OverloadGuard::NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace zener
@@ -1,12 +1,22 @@
 #include "core/server.h"
 #include "config/config.h"
-#include "core/epoller.h"
+#include "core/event_backend.h"
+#include "core/handoff.h"
+#include "http/async.h"
 #include "database/sql_connector.h"
 #include "http/conn.h"
+#include "http/h2_session.h"
+#include "http/response_cache.h"
+#include "http/response_stream.h"
+#include "http/websocket.h"
 #include "task/threadpool_1.h"
 #include "task/timer/timer.h"
+#include "utils/cpu/topology.h"
+#include "utils/log/access_log.h"
 #include "utils/log/logger.h"
+#include "utils/metrics/metrics.h"
 
+#include <algorithm>
 #include <asm-generic/socket.h>
 #include <atomic>
 #include <cassert>
@@ -16,26 +26,71 @@
 #include <cstring>
 #include <ctime>
 #include <fcntl.h>
+#include <fstream>
 #include <memory>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <type_traits>
 #include <unistd.h>
 
 namespace zener {
 namespace v0 {
 
+namespace {
+
+// 信号处理函数只做异步信号安全的事：记下信号并写 eventfd 唤醒事件循环
+std::atomic<int> pendingSignal{0};
+std::atomic<int> signalWakeFd{-1};
+
+void onSignal(const int sig) {
+    const int savedErrno = errno;
+    pendingSignal.store(sig, std::memory_order_relaxed);
+    if (const int fd = signalWakeFd.load(std::memory_order_relaxed); fd >= 0) {
+        constexpr uint64_t one = 1;
+        (void)!write(fd, &one, sizeof(one));
+    }
+    errno = savedErrno;
+}
+
+void installSignals() {
+    struct sigaction sa{};
+    sa.sa_handler = onSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    for (const int sig : {SIGTERM, SIGINT, SIGUSR2}) {
+        sigaction(sig, &sa, nullptr);
+    }
+    // 对端已关闭时 writev 返回 EPIPE 即可，不要让进程被 SIGPIPE 杀掉
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// 读取非负整数配置项，小于 min 时取 min，未配置时保留默认值
+template <typename T>
+void readUnsigned(const char *key, T &value, const long long min = 0) {
+    if (Config::Has(key)) {
+        value = static_cast<T>(std::max(atoll(GET_CONFIG(key).c_str()), min));
+    }
+}
+
+} // namespace
+
 Server::Server(int port, const int trigMode, const int timeoutMS,
                const bool optLinger, const char *sqlHost, const int sqlPort,
                const char *sqlUser, const char *sqlPwd, const char *dbName,
                int connPoolNum, int threadNum, bool openLog, int logLevel,
                int logQueSize)
     : _port(port), _openLinger(optLinger), _timeoutMS(timeoutMS),
-      _isClose(false), _threadpool(new ThreadPool(threadNum)),
-      _epoller(new Epoller()) {
+      _isClose(false),
+      _threadpool(new ThreadPool(
+          threadNum > 0 ? threadNum : ThreadPool::DefaultThreadCount(),
+          lanesFromConfig(), sizingFromConfig(), affinityFromConfig())),
+      _limiter(limiterFromConfig()), _overload(overloadFromConfig()) {
 
     Logger::Init();
+    _epoller = NewEventBackend(backendFromConfig());
 
     char cwdBuff[256];           // 程序所在路径
     if (!getcwd(cwdBuff, 256)) { // 接受两个参数：缓冲区 char *buf 和 缓冲区大小
@@ -46,8 +101,59 @@ Server::Server(int port, const int trigMode, const int timeoutMS,
     _staticDir = _cwd + "/static";
     http::Conn::userCount.store(0);
     http::Conn::router = &_router;
+    http::Conn::admit = [this](const int slot) { return admitRequest(slot); };
+    if (_epoller->CompletionIo()) {
+        // 收发交给事件后端：Write 拷进环里发送，Read 取循环线程投递的数据
+        http::Conn::sender = [this](const int fd, const iovec *iov,
+                                    const int iovCnt) {
+            return _epoller->Send(fd, iov, iovCnt);
+        };
+    }
+    // 其他线程给连接产生了待发数据：请循环线程关心可写并派发
+    const auto armWrite = [this](const int fd, const uint64_t connId) {
+        post({LoopCommand::Kind::ARM_WRITE, fd, connId, false, {}});
+    };
+    http::ws::Hub::GetInstance().SetWaker(armWrite);
+    // HTTP/2 流的处理函数在通道里跑完（或排队超时被丢弃）后，唤醒连接发出响应
+    http::Conn::offload = [this, armWrite](const http::Conn::Lane route,
+                                           const int fd, const uint64_t connId,
+                                           std::function<void()> run,
+                                           std::function<void()> shed) {
+        return enqueue(
+            route,
+            [run = std::move(run), armWrite, fd, connId] {
+                run();
+                armWrite(fd, connId);
+            },
+            [shed = std::move(shed), armWrite, fd, connId] {
+                shed();
+                armWrite(fd, connId);
+            });
+    };
+    http::ResponseStream::SetWaker(armWrite);
+    http::ResponseCache::GetInstance().SetWaker(armWrite);
+    http::AsyncCall::SetHooks({
+        .wake = armWrite,
+        .after =
+            [this](int ms, std::function<void()> fn) {
+                TimerManagerImpl::GetInstance().Schedule(ms, 0, std::move(fn));
+                wakeup(); // 循环可能正阻塞在更晚的超时上，让它重新计算
+            },
+        .offload =
+            [this](std::function<void()> run, std::function<void()> shed) {
+                const auto deadline =
+                    _blockingDeadlineMS > 0
+                        ? ThreadPool::Clock::now() +
+                              std::chrono::milliseconds(_blockingDeadlineMS)
+                        : ThreadPool::Clock::time_point{};
+                return _threadpool->AddTask(ThreadPool::Lane::BLOCKING,
+                                            std::move(run), deadline,
+                                            std::move(shed));
+            },
+    });
     // Register default static file mount — equivalent to gin's Static("/", "./static")
     _router.Static("/", _staticDir);
+    initMetrics();
 
     initEventMode(trigMode); // TODO 在Epoller里已经设置一遍了
 
@@ -56,16 +162,42 @@ Server::Server(int port, const int trigMode, const int timeoutMS,
 
         throw std::runtime_error("Failed to initialize listen socket.");
     }
+    if (!initWakeup()) {
+        LOG_W("Failed to create wakeup eventfd: {}", strerror(errno));
+    }
+    signalWakeFd.store(_wakeupFd, std::memory_order_relaxed);
+    installSignals();
 
     db::SqlConnector::GetInstance().Init(sqlHost, sqlPort, sqlUser, sqlPwd,
                                          dbName, connPoolNum);
 
+    // 先读配置再准备日志文件：日志目录不可用时这些设置同样生效
+    logLevelsFromConfig(logLevel);
+    loopFromConfig();
+    httpFromConfig();
+
     const std::string logDir = GET_CONFIG("log.dir");
     const std::string fullLogDir = _cwd + "/" + logDir;
     if (!Logger::WriteToFile(fullLogDir)) {
         LOG_E("Failed to create log file in directory: {}!", fullLogDir);
         return;
     }
+    if (openLog && logQueSize > 0) {
+        const auto policy = GET_CONFIG("log.overflow") == "block"
+                                ? AsyncOverflowPolicy::BLOCK
+                                : AsyncOverflowPolicy::DROP;
+        if (!Logger::StartAsync(static_cast<size_t>(logQueSize), policy)) {
+            LOG_W("Failed to start async logging, fallback to sync logger.");
+        }
+    }
+    if (Config::Has("accesslog.enable") &&
+        GET_CONFIG("accesslog.enable") == "true") {
+        uint32_t sample = 1;
+        readUnsigned("accesslog.sample", sample, 1);
+        if (!AccessLog::GetInstance().Start(fullLogDir, sample)) {
+            LOG_W("Failed to start access log.");
+        }
+    }
     LOG_T("🚀--------------------------------+--");
     LOG_I("|   __________ _   _ _____ ____");
     LOG_I("|  |__  / ____| \\ | | ____|  _ \\");
@@ -79,58 +211,179 @@ Server::Server(int port, const int trigMode, const int timeoutMS,
           (_listenEvent & EPOLLET ? "ET" : "LT"),
           (_connEvent & EPOLLET ? "ET" : "LT"));
     LOG_I("|  static path: {}", _staticDir);
-    LOG_I("| 󰰙 SqlConnPool num: {}, ThreadPool num: {}", connPoolNum,
-          threadNum);
+    LOG_I("|  Event backend: {}", _epoller->Name());
+    LOG_I("| 󰰙 SqlConnPool num: {}, ThreadPool num: {} ({}-{})", connPoolNum,
+          _threadpool->Size(), _threadpool->MinSize(), _threadpool->MaxSize());
     LOG_I("| 󰔛 TimerManager: {}", TIMER_MANAGER_TYPE);
+    if (!_reactorCpus.empty()) {
+        LOG_I("|  Pinned: reactor {} cpus, NUMA nodes: {}, steering: {}",
+              _reactorCpus.size(), cpu::NodeCount(),
+              _threadpool->NodeAware() ? "on" : "off");
+    }
     LOG_T("-------------------------------------+--");
 }
 
 Server::~Server() {
-    close(_listenFd);
     _isClose.store(true, std::memory_order_release);
+    signalWakeFd.store(-1, std::memory_order_relaxed);
+    // 广播线程应在 Server 析构前停止，此后的 Broadcast 只入队不再唤醒
+    http::ws::Hub::GetInstance().SetWaker(nullptr);
+    http::ResponseStream::SetWaker(nullptr);
+    http::ResponseCache::GetInstance().SetWaker(nullptr);
+    http::AsyncCall::SetHooks({});
+    // 先停线程池：工作线程还在使用连接、数据库连接池和日志
+    _threadpool->Shutdown(_drainTimeoutMS);
+    _threadpool.reset();
+    http::Conn::admit = nullptr; // 工作线程都已退出，不会再有人调用
+    http::Conn::sender = nullptr;
+    http::Conn::offload = nullptr;
+    {
+        std::unique_lock lk(_connMutex);
+        _users.clear(); // 关闭剩余连接
+    }
+    if (_listenFd >= 0) {
+        close(_listenFd);
+    }
+    if (_upgradeFd >= 0) {
+        close(_upgradeFd);
+        if (!_handedOff) { // 交接后该路径已归新进程所有
+            unlink(_upgradePath.c_str());
+        }
+    }
+    if (_wakeupFd >= 0) {
+        close(_wakeupFd);
+    }
+    if (_reserveFd >= 0) {
+        close(_reserveFd);
+    }
     db::SqlConnector::GetInstance().Close();
+    AccessLog::GetInstance().Stop();
+    // 回调里捕获了 this
+    for (const char *name :
+         {"zener_threadpool_queue_length", "zener_threadpool_workers",
+          "zener_threadpool_queue_delay_seconds",
+          "zener_threadpool_blocking_queue_length",
+          "zener_threadpool_shed_tasks", "zener_threadpool_rejected_tasks"}) {
+        metrics::Registry::GetInstance().RemoveCallbackGauge(name);
+    }
     LOG_I("Server exited.");
     Logger::Flush();
     Logger::Shutdown();
 }
 
+void Server::initMetrics() {
+    auto &registry = metrics::Registry::GetInstance();
+    metrics::Server(); // 先注册内置指标，保证输出顺序稳定
+    registry.NewCallbackGauge("zener_active_connections",
+                              "Currently open client connections.", [] {
+                                  return static_cast<double>(
+                                      http::Conn::userCount.load(
+                                          std::memory_order_relaxed));
+                              });
+    registry.NewCallbackGauge("zener_websocket_sessions",
+                              "Currently open WebSocket sessions.", [] {
+                                  return static_cast<double>(
+                                      http::ws::Hub::sessionCount.load(
+                                          std::memory_order_relaxed));
+                              });
+    registry.NewCallbackGauge(
+        "zener_timer_queue_depth", "Pending timers.", [] {
+            return static_cast<double>(TimerManagerImpl::GetInstance().Size());
+        });
+    registry.NewCallbackGauge("zener_threadpool_queue_length",
+                              "Tasks waiting in the worker pool.", [this] {
+                                  return static_cast<double>(
+                                      _threadpool->QueueLength());
+                              });
+    registry.NewCallbackGauge("zener_threadpool_workers",
+                              "Active I/O and handler worker threads.", [this] {
+                                  return static_cast<double>(
+                                      _threadpool->Size());
+                              });
+    registry.NewCallbackGauge(
+        "zener_threadpool_queue_delay_seconds",
+        "Average task queueing delay in the last sizing round.", [this] {
+            return static_cast<double>(_threadpool->QueueDelayUs()) / 1e6;
+        });
+    registry.NewCallbackGauge(
+        "zener_threadpool_blocking_queue_length",
+        "Tasks waiting in the blocking lane.", [this] {
+            return static_cast<double>(
+                _threadpool->LaneLength(ThreadPool::Lane::BLOCKING));
+        });
+    registry.NewCallbackGauge(
+        "zener_threadpool_shed_tasks", "Lane tasks dropped after their deadline.",
+        [this] { return static_cast<double>(_threadpool->ShedCount()); });
+    registry.NewCallbackGauge(
+        "zener_threadpool_rejected_tasks",
+        "Lane tasks rejected because the lane queue was full.",
+        [this] { return static_cast<double>(_threadpool->RejectedCount()); });
+    registry.NewCallbackGauge(
+        "zener_event_loop_lag_seconds",
+        "Smoothed time the event loop spends per iteration.", [this] {
+            return static_cast<double>(_overload.LoopLagUs()) / 1e6;
+        });
+    registry.NewCallbackGauge(
+        "zener_threadpool_queue_age_seconds",
+        "Queueing time of the latest overload probe task.", [this] {
+            return static_cast<double>(_overload.QueueAgeUs()) / 1e6;
+        });
+    registry.NewCallbackGauge(
+        "zener_overload_shed_ratio",
+        "Fraction of new requests currently answered 503.", [this] {
+            return static_cast<double>(_overload.ShedPermille()) / 1000;
+        });
+    registry.NewCallbackGauge(
+        "zener_response_cache_bytes", "Bytes held by the route response cache.",
+        [] {
+            return static_cast<double>(
+                http::ResponseCache::GetInstance().Bytes());
+        });
+    registry.NewCallbackGauge(
+        "zener_sql_pool_free_connections", "Idle SQL connections.", [] {
+            return static_cast<double>(
+                db::SqlConnector::GetInstance().GetFreeConnCount());
+        });
+    // 保留路由，Prometheus 抓取入口
+    GET("/metrics", [](http::Context &ctx) {
+        ctx.Send(metrics::Registry::GetInstance().Render());
+    });
+}
+
 ///@thread 安全
+///@intro trigMode 只决定监听 fd 的触发方式（2/3 为 ET）；连接 fd 固定为
+/// ET 并一次性关心读写，就绪状态由 Conn 在用户态记录，处理过程中不再 ModFd
 void Server::initEventMode(const int trigMode) {
     _listenEvent = EPOLLRDHUP;
-    _connEvent = EPOLLONESHOT | EPOLLRDHUP;
-    switch (trigMode) {
-    case 0:
-        break;
-    case 1:
-        _connEvent |= EPOLLET;
-        break;
-    case 2:
-        _listenEvent |= EPOLLET;
-        break;
-    case 3:
-        _listenEvent |= EPOLLET;
-        _connEvent |= EPOLLET;
-        break;
-    default:
+    _connEvent = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+    if (trigMode >= 2 || trigMode < 0) {
         _listenEvent |= EPOLLET;
-        _connEvent |= EPOLLET;
-        break;
     }
-    http::Conn::isET = (_connEvent & EPOLLET);
+    http::Conn::isET = true;
 }
 
 ///@thread 单线程
 void Server::Run() {
-    std::shared_lock readLocker(_connMutex, std::defer_lock);
+    if (!cpu::PinCurrentThread(_reactorCpus)) {
+        LOG_W("Failed to pin reactor thread: {}", strerror(errno));
+    }
+    _loopThread = std::this_thread::get_id();
     int timeMS = -1; // epoll wait timeout 默认不超时，一直阻塞，直到有事件发生
     while (!_isClose.load(std::memory_order_acquire)) {
-        if (_timeoutMS > 0) {
-            timeMS = TimerManagerImpl::GetInstance().GetNextTick();
+        // 关闭了连接超时也要跑计时器：协程处理函数的 Sleep 挂在上面
+        timeMS = TimerManagerImpl::GetInstance().GetNextTick();
+        if (_acceptPending) {
+            timeMS = 0; // 还有没 accept 完的连接，不阻塞
+        } else if (_draining) {
+            timeMS = timeMS < 0 ? 100 : std::min(timeMS, 100); // 定期检查排空进度
+        } else if (_overload.Active()) {
+            // 过载期间没有事件也要醒来采样，才能及时恢复 accept
+            timeMS = timeMS < 0 ? OverloadGuard::SAMPLE_MS
+                                : std::min(timeMS, OverloadGuard::SAMPLE_MS);
         }
         const int eventCnt = _epoller->Wait(timeMS);
-        if (eventCnt == 0) { // 超时，继续下一轮 ? 会跳过超时任务处理?
-            continue;
-        }
+        const int64_t busyStart = OverloadGuard::NowUs();
+        bool listened = false;
         for (int i = 0; i < eventCnt; i++) { // 处理事件
             const int fd = _epoller->GetEventFd(i);
             const uint32_t events = _epoller->GetEvents(i);
@@ -139,74 +392,213 @@ void Server::Run() {
                 continue;
             }
             if (fd == _listenFd) { // @Listen
-                dealListen();
-            } else if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
-                /*
-                 *TODO 想出来的比较阴间的操作：
-                 *如果不存在于 _users map 中（只会在错误下出现）：
-                 *会调用 ConnInfo 的默认构造函数
-                 *则 conn 会是 nullptr，connId 是 0
-                 *但下次调用会查找到对象，且为默认初始化的不合法对象。
-                 *所以在其他地方要进行判断。
-                 */
-                readLocker.lock();
-                const auto conn = _users[fd].conn.get();
-                readLocker.unlock();
-                assert(conn);
-                if (conn) {
-                    closeConn(conn); // closeConn内部有_epoller和_users中的删除
-                }
-            } else if (events & EPOLLIN) { // @Read
-                readLocker.lock();
-                const auto conn = _users[fd].conn.get();
-                readLocker.unlock();
-                assert(conn);
-                if (conn) {
-                    dealRead(conn);
-                } else {
-                    /* 和原版不一样的处理：
-                       若 fd 已被关闭或未注册到 _users，但 epoll 仍在监听，
-                       可能因内核事件队列未清空导致事件重复触发
-                       这几行可以加到 dealWrite
-                       等函数内部，但还是在这更清晰 -- 单一职责原则
-                    */
-                    if (!_epoller->DelFd(fd)) { // 从epoll中删除并关闭
-                        LOG_W("Invalid fd: {} from epoll!", fd);
-                    }
-                    close(fd);
-                }
-            } else if (events & EPOLLOUT) { // @Write
-                readLocker.lock();
-                const auto conn = _users[fd].conn.get();
-                readLocker.unlock();
-                assert(conn);
-                if (conn) {
-                    dealWrite(conn);
+                if (_epoller->CompletionIo()) {
+                    dealAccepted(_epoller->GetAccepted(i));
                 } else {
-                    if (!_epoller->DelFd(fd)) {
-                        LOG_W("Invalid fd: {} from epoll!", fd);
-                    }
-                    close(fd);
+                    dealListen();
+                    listened = true;
                 }
+            } else if (fd == _upgradeFd) { // 新进程来取监听 fd
+                dealUpgrade();
+            } else if (fd == _wakeupFd) { // 命令、信号在本轮末尾统一处理
+                uint64_t count = 0;
+                (void)read(_wakeupFd, &count, sizeof(count));
             } else {
-                LOG_E("Unexpected events: {} from epoll!", events);
+                dealEvent(fd, events, _epoller->GetData(i));
+            }
+        }
+        if (!_commands.Empty()) {
+            drainCommands();
+        }
+        if (const int sig = pendingSignal.exchange(0, std::memory_order_relaxed)) {
+            handleSignal(sig);
+        }
+        if (_draining) {
+            closeIdleConns();
+            if (_users.empty()) {
+                LOG_I("All connections drained.");
+                break;
+            }
+            if (std::chrono::steady_clock::now() >= _drainDeadline) {
+                LOG_W("Drain timed out, {} connection(s) left.", _users.size());
+                break;
             }
         }
+        // 已建立连接的事件先派发出去，再继续上一轮没 accept 完的连接
+        if (_acceptPending && !listened && !_isClose.load()) {
+            dealListen();
+        }
+        if (_overload.Enabled()) {
+            checkOverload(OverloadGuard::NowUs() - busyStart);
+        }
+    }
+}
+
+///@thread 循环线程
+void Server::checkOverload(const int64_t busyUs) {
+    if (!_overload.Tick(busyUs)) {
+        return;
+    }
+    if (const int64_t stamp = _overload.StartProbe(); stamp > 0) {
+        // 与连接的任务走同一条队列，测到的就是它们的排队时间
+        _threadpool->AddTask([this, stamp] { _overload.FinishProbe(stamp); });
+    }
+    const bool overloaded = _overload.Overloaded();
+    if (overloaded == _acceptPaused || _draining) {
+        return;
+    }
+    if (overloaded) {
+        LOG_W("Overloaded (loop lag {}us, queue age {}us): accept paused.",
+              _overload.LoopLagUs(), _overload.QueueAgeUs());
+    } else {
+        LOG_I("Load recovered (loop lag {}us, queue age {}us): accept resumed.",
+              _overload.LoopLagUs(), _overload.QueueAgeUs());
+    }
+    pauseAccept(overloaded);
+    if (_overload.CloseKeepAlive()) {
+        http::Conn::shedding.store(overloaded, std::memory_order_relaxed);
+    }
+}
+
+///@thread 循环线程
+///@intro 暂停时监听 fd 移出 epoll，新连接留在内核的监听队列里，
+/// 恢复后重新加入并主动 accept 一轮（ET 下不一定会再通知）。
+/// 完成式下只用 ModFd 取消 accept，已经 accept 进完成队列的连接照常交付，
+/// 恢复后多次触发的 accept 直接交付排队的连接
+void Server::pauseAccept(const bool pause) {
+    _acceptPaused = pause;
+    if (_listenFd < 0) {
+        return;
+    }
+    const bool completion = _epoller->CompletionIo();
+    if (pause) {
+        _acceptPending = false;
+        if (!(completion ? _epoller->ModFd(_listenFd, _listenEvent)
+                         : _epoller->DelFd(_listenFd))) {
+            LOG_W("Failed to del listen fd {} from epoll!", _listenFd);
+        }
+    } else {
+        if (!(completion
+                  ? _epoller->ModFd(_listenFd, _listenEvent | EPOLLIN)
+                  : _epoller->AddListener(_listenFd, _listenEvent | EPOLLIN))) {
+            LOG_E("Failed to re-add listen fd {}: {}", _listenFd,
+                  strerror(errno));
+        }
+        _acceptPending = !completion;
     }
 }
 
 ///@thread 安全
+///@intro 立即退出事件循环；连接池、日志等由析构函数在线程池停下之后关闭
 void Server::Stop() {
-    if (close(_listenFd) != 0) {
-        LOG_E("Failed to close listen fd {0} : {1}", _listenFd,
-              strerror(errno));
-        _listenFd = -1;
-    }
-    db::SqlConnector::GetInstance().Close();
     LOG_I("Server Stop =========================>");
     _isClose.store(true, std::memory_order_release);
-    Logger::Flush();
-    Logger::Shutdown();
+    post({LoopCommand::Kind::SHUTDOWN, -1, 0, false, {}});
+}
+
+///@thread 安全
+void Server::Drain() {
+    post({LoopCommand::Kind::DRAIN, -1, 0, false, {}});
+}
+
+///@thread 循环线程
+///@intro 停止 accept，已在处理的请求照常完成但不再复用连接，空闲连接立即关闭，
+/// 连接清空或超过 drainTimeout 后退出事件循环
+void Server::startDrain() {
+    if (_draining) {
+        return;
+    }
+    _draining = true;
+    http::Conn::draining.store(true, std::memory_order_relaxed);
+    _drainDeadline = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(_drainTimeoutMS);
+    _acceptPending = false;
+    if (_listenFd >= 0) {
+        // 完成式下暂停的监听 fd 仍登记在后端里
+        if ((!_acceptPaused || _epoller->CompletionIo()) &&
+            !_epoller->DelFd(_listenFd)) {
+            LOG_W("Failed to del listen fd {} from epoll!", _listenFd);
+        }
+        close(_listenFd); // 已交接时新进程持有同一个监听 socket，不受影响
+        _listenFd = -1;
+    }
+    if (_upgradeFd >= 0) {
+        (void)_epoller->DelFd(_upgradeFd);
+    }
+    LOG_I("Draining {} connection(s), deadline {}ms.", _users.size(),
+          _drainTimeoutMS);
+}
+
+///@thread 循环线程
+///@intro 只关闭两次请求之间的长连接；刚建立、请求还没收完的连接继续等，
+/// 它们的响应会带 Connection: close
+void Server::closeIdleConns() {
+    std::vector<http::Conn *> idle;
+    for (auto &[fd, info] : _users) {
+        http::Conn *client = info.conn.get();
+        if (!client || !client->TryAcquireIdle()) {
+            continue;
+        }
+        if (client->BetweenRequests()) {
+            idle.push_back(client);
+        } else if (!client->Release()) {
+            schedule(client); // 取得所有权期间来了事件
+        }
+    }
+    for (http::Conn *client : idle) {
+        removeConn(client);
+    }
+}
+
+///@thread 循环线程
+void Server::handleSignal(const int sig) {
+    switch (sig) {
+    case SIGTERM:
+    case SIGINT:
+        if (_draining) { // 排空中再收到一次：不再等待
+            LOG_W("Signal {} received again, stop now.", sig);
+            _isClose.store(true, std::memory_order_release);
+            return;
+        }
+        LOG_I("Signal {} received, draining.", sig);
+        startDrain();
+        break;
+    case SIGUSR2:
+        if (_upgradeFd < 0 || _draining) {
+            LOG_W("SIGUSR2 ignored: upgrade socket not configured or draining.");
+            return;
+        }
+        // 新进程连上 upgrade socket 取走监听 fd 后，本进程在 dealUpgrade 里开始排空
+        if (const int pid = handoff::SpawnSelf(); pid > 0) {
+            LOG_I("Spawned successor pid {}.", pid);
+        } else {
+            LOG_E("Failed to spawn successor: {}", strerror(errno));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+///@thread 循环线程
+void Server::dealUpgrade() {
+    const int sock = accept4(_upgradeFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (sock < 0) {
+        return;
+    }
+    if (_listenFd < 0 || _draining) {
+        close(sock); // 已经交接过或在排空，新进程会自己 bind
+        return;
+    }
+    if (!handoff::Send(sock, _listenFd)) {
+        LOG_E("Failed to hand off listen fd: {}", strerror(errno));
+        close(sock);
+        return;
+    }
+    close(sock);
+    _handedOff = true;
+    LOG_I("Listen socket handed off to successor.");
+    startDrain();
 }
 
 ///@thread 安全
@@ -219,6 +611,12 @@ void Server::sendError(int fd, const char *info) {
     close(fd);
 }
 
+void Server::resetConn(const int fd) {
+    constexpr linger rst{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &rst, sizeof(rst));
+    close(fd);
+}
+
 ///@param client 调用的时候使用 connInfo.conn.get() 传入
 ///@notice 在release下不进行 client 的空指针判断，需要在调用的时候在外面判空
 ///@important 内部有锁
@@ -230,6 +628,16 @@ void Server::closeConn(http::Conn *client) {
         LOG_W("Trying to close null client!");
         return;
     }
+    if (inLoop()) {
+        removeConn(client);
+        return;
+    }
+    post({LoopCommand::Kind::CLOSE, client->GetFd(), client->GetConnId(),
+          true, {}});
+}
+
+///@thread 循环线程
+void Server::removeConn(http::Conn *client) {
     std::unique_lock writeLocker(_connMutex, std::defer_lock);
     int fd = client->GetFd();
     assert(fd > 0);
@@ -243,7 +651,7 @@ void Server::closeConn(http::Conn *client) {
         return;
     }
     // Cancel the timeout timer when closing the connection (key = fd)
-    if (_timeoutMS > 0) {
+    if (_timeoutMS > 0 || http::Conn::Deadlines()) {
         try {
             TimerManagerImpl::GetInstance().CancelByKey(fd);
         } catch (const std::exception &e) {
@@ -252,6 +660,7 @@ void Server::closeConn(http::Conn *client) {
             LOG_E("Unknown exception canceling timer for fd {}", fd);
         }
     }
+    _limiter.Release(client->TakeLimiterSlot());
     if (!_epoller->DelFd(fd)) {
         LOG_E("Failed to del fd {}, connId {} from epoll!", fd, connId);
     }
@@ -312,7 +721,7 @@ void Server::_closeConnInternal(http::Conn &&client) const {
     auto connId = client.GetConnId();
     assert(connId > 0);
     LOG_T("Closing fd {} (connId={}) asynchronously.", fd, connId);
-    if (_timeoutMS > 0) {
+    if (_timeoutMS > 0 || http::Conn::Deadlines()) {
         try { // 取消计时器里注册的超时关闭任务，因为此时就要关闭了
             TimerManagerImpl::GetInstance().CancelByKey(fd);
         } catch (const std::exception &e) {
@@ -354,19 +763,22 @@ void Server::closeConnAsync(int fd, const std::function<void()> &callback) {
 }
 
 ///@thread 安全
-void Server::addClient(int fd, const sockaddr_in &addr) {
+void Server::addClient(int fd, const sockaddr_in &addr,
+                       const int limiterSlot) {
     assert(fd > 0);
     if (fd <= 0) {
         LOG_E("Invalid fd: {}!", fd);
+        _limiter.Release(limiterSlot);
         return;
     }
     std::unique_lock writeLock(_connMutex, std::defer_lock);
-    if (setNoDelay(fd) < 0) { // NO_DELAY
-        LOG_W("Failed to set TCP_NODELAY for client fd {}: {}", fd,
-              strerror(errno));
-    }
+    // 非阻塞、CLOEXEC 由 accept4 设置，TCP_NODELAY 从监听 socket 继承
+    metrics::Server().accepted.Inc();
     uint64_t connId = _nextConnId.fetch_add(
         1, std::memory_order_acquire); // 为新连接生成唯一ID
+    // 之后这条连接的读写任务优先投给与网卡队列同节点的工作线程
+    const int node = _threadpool->NodeAware() ? incomingNode(fd) : -1;
+    http::Conn *client = nullptr;
     try {
         /*
             把 fd 添加进 _users 表，并且生成对应的 conn
@@ -390,6 +802,7 @@ void Server::addClient(int fd, const sockaddr_in &addr) {
                 LOG_E("Duplicate fd {} detected!", fd);
                 _users.erase(fd); // new
                 close(fd);        // 没啥影响
+                _limiter.Release(limiterSlot);
                 return;
             }
             auto &connInfo = it->second;
@@ -400,7 +813,10 @@ void Server::addClient(int fd, const sockaddr_in &addr) {
              */
             conn->SetConnId(connId);
             conn->Init(fd, addr);
+            conn->SetNode(node);
+            conn->SetLimiterSlot(limiterSlot);
             connInfo.connId = connId;
+            client = conn.get();
             connInfo.conn = std::move(conn);
             writeLock.unlock();
         } else {
@@ -410,11 +826,15 @@ void Server::addClient(int fd, const sockaddr_in &addr) {
             _users[fd].connId = connId;
             _users[fd].conn->Init(fd, addr);
             _users[fd].conn->SetConnId(connId);
+            _users[fd].conn->SetNode(node);
             writeLock.unlock();
         }
 
     } catch (const std::exception &e) {
         LOG_E("Add client exception. fd:{}. id:{}. {}", fd, connId, e.what());
+        if (!client) {
+            _limiter.Release(limiterSlot);
+        }
     }
     /*
      * 设置超时取消 此处传入 connId 和 fd
@@ -425,43 +845,32 @@ void Server::addClient(int fd, const sockaddr_in &addr) {
             fd, _timeoutMS, 0, [this, fd, connId]() {
                 /*
                  * 检查文件描述符和连接ID都匹配
-                 * 防止文件描述符重用导致的错误关闭
+                 * 防止文件描述符重用导致的错误关闭，由事件循环完成
                  */
-                assert(fd > 0);
-                assert(connId > 0);
-                http::Conn *conn = nullptr;
-                {
-                    std::shared_lock readLock(_connMutex, std::defer_lock);
-                    if (!_isClose.load() && _users.count(fd) > 0 &&
-                        _users[fd].connId == connId) {
-                        conn = _users[fd].conn.get();
-                    }
-                }
-                if (conn) {
-                    // 包含删除 _users 表中的 fd
-                    closeConn(conn);
+                if (!_isClose.load(std::memory_order_acquire)) {
+                    post({LoopCommand::Kind::CLOSE, fd, connId, false, {}});
                 }
             });
     }
-    /*
-        在 epoll 开始监听 fd 前，必须确保 fd 处于非阻塞模式。
-        若顺序颠倒，可能在 epoll_wait 返回事件后，执行阻塞式读写，导致线程卡死
-        （尤其在单线程 Reactor 中）
-     */
-    if (setFdNonBlock(fd) == -1) {
-        LOG_E("Error setFdNonblock: {}! {}", fd, strerror(errno));
+    if (!_epoller->AddConn(fd, _connEvent)) {
+        LOG_E("Failed to add client fd {} to epoll!", fd);
+        _limiter.Release(limiterSlot);
         writeLock.lock();
         _users.erase(fd);
         writeLock.unlock();
         close(fd);
         return;
     }
-    if (!_epoller->AddFd(fd, EPOLLIN | _connEvent)) {
-        LOG_E("Failed to add client fd {} to epoll!", fd);
-        writeLock.lock();
-        _users.erase(fd);
-        writeLock.unlock();
-        close(fd);
+    /*
+     * 首个请求已随连接到达：不等 epoll 通知，直接交给工作线程读
+     * 注册在前、取得所有权在后，都在循环线程上完成：注册时已有数据，ET 会立即
+     * 报告一次可读，循环线程处理它时连接由工作线程持有，Notify 只记下 IO_READ，
+     * 工作线程 Release 前会看到并接着处理，不会丢失边缘
+     * 完成式 IO 下 recv 已挂在环上，数据到了就会交付，不需要这一步
+     */
+    if (_readOnAccept && !_epoller->CompletionIo() && client &&
+        client->Notify(http::Conn::IO_READ)) {
+        _threadpool->AddTaskOnNode(node, [this, client] { onAccept(client); });
     }
     LOG_T("Set client({}) id:{}.", fd, connId);
 }
@@ -493,7 +902,8 @@ int Server::setNoDelay(const int fd) {
 ///@thread 安全
 bool Server::checkServerNotFull(const int fd) {
     if (http::Conn::userCount.load(std::memory_order_acquire) >= MAX_FD) {
-        sendError(fd, "Server busy!");
+        metrics::Server().acceptDropped.Inc();
+        sendError(fd, "Server busy!"); // fd 是非阻塞的，发不出去也不会卡住 reactor
         LOG_W("Clients full! Current user count: {}.",
               http::Conn::userCount.load());
         return false;
@@ -501,93 +911,230 @@ bool Server::checkServerNotFull(const int fd) {
     return true;
 }
 
+///@thread reactor 线程
+///@intro 每轮最多 accept _acceptBudget 个连接，剩下的留到处理完本轮已就绪连接之后
 void Server::dealListen() {
-    struct sockaddr_in addr{};
-    socklen_t len = sizeof(addr);
-    if (_listenEvent & EPOLLET) { // ET 模式：必须处理所有就绪连接
-        while (!_isClose.load(std::memory_order_acquire)) {
-            const int fd = accept(
-                _listenFd, reinterpret_cast<struct sockaddr *>(&addr), &len);
-            if (fd <= 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    break; // 没有更多连接可接受
-                }
-                LOG_E("Listen and accept error: {}", strerror(errno));
-                break;
-            }
-            if (_isClose.load(std::memory_order_acquire)) {
-                close(fd); // TODO check
-                break;
+    _acceptPending = false;
+    for (int i = 0; i < _acceptBudget; ++i) {
+        if (_isClose.load(std::memory_order_acquire)) {
+            return;
+        }
+        struct sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        const int fd =
+            accept4(_listenFd, reinterpret_cast<struct sockaddr *>(&addr),
+                    &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                dropPendingConn();
+                continue;
             }
-            if (checkServerNotFull(fd)) {
-                addClient(fd, addr);
+            if (errno == ECONNABORTED || errno == EINTR) {
+                continue; // 只是这一个连接没接到，队列里可能还有
             }
-        }
-    } else { // LT 模式：限制单次 accept 数量
-        const int maxAccept =
-            std::min(50, MAX_FD - http::Conn::userCount.load());
-        for (int i = 0; i < maxAccept; ++i) {
-            const int fd = accept(
-                _listenFd, reinterpret_cast<struct sockaddr *>(&addr), &len);
-            if (fd <= 0) {
-                if (errno == EAGAIN)
-                    break;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
                 LOG_E("Listen and accept error: {}", strerror(errno));
-                break;
-            }
-            if (checkServerNotFull(fd)) {
-                addClient(fd, addr);
             }
+            return; // 没有更多连接可接受
         }
+        acceptConn(fd, addr);
     }
+    // 预算用完但队列可能还有连接：ET 下不会再有新的通知，由 Run 主动再来一轮
+    _acceptPending = true;
 }
 
-///@thread 安全
-void Server::dealRead(http::Conn *client) {
-    assert(client);
-    if (!client) {
+///@thread reactor 线程
+///@intro 多次触发的 accept 不带对端地址，这里取一次再走与 dealListen 相同的准入
+void Server::dealAccepted(const int fd) {
+    if (fd < 0) {
+        if (fd == -EMFILE || fd == -ENFILE) {
+            dropPendingConn();
+        } else if (fd != -EAGAIN && fd != -EINTR && fd != -ECONNABORTED) {
+            LOG_E("Listen and accept error: {}", strerror(-fd));
+        }
         return;
     }
-    int fd = client->GetFd();
-    assert(fd > 0);
-    if (fd <= 0) {
-        LOG_W("Invalid fd {}!", fd);
+    if (_isClose.load(std::memory_order_acquire)) {
+        close(fd);
         return;
     }
-    std::shared_lock readLocker(_connMutex, std::defer_lock);
-    readLocker.lock();
-    const size_t ret = _users.count(fd);
-    readLocker.unlock();
-    if (ret == 0) {
-        LOG_W("Fd {} is not in _users!", fd);
+    struct sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    (void)getpeername(fd, reinterpret_cast<struct sockaddr *>(&addr), &len);
+    acceptConn(fd, addr);
+}
+
+///@thread reactor 线程
+void Server::acceptConn(const int fd, const sockaddr_in &addr) {
+    if (!checkServerNotFull(fd)) {
+        return;
+    }
+    _limiter.Sweep();
+    int slot = ClientLimiter::UNTRACKED;
+    if (!_limiter.Admit(addr.sin_addr.s_addr, slot)) {
+        // 同一 IP 的连接数已满：不分配 Conn，直接 RST
+        metrics::Server().limitedConns.Inc();
+        resetConn(fd);
+        return;
+    }
+    addClient(fd, addr, slot);
+}
+
+///@thread reactor 线程
+///@intro fd 耗尽（EMFILE）时连接会一直留在监听队列里，LT 下 epoll 反复通知、
+/// ET 下再也不通知。腾出预留的 fd 接下这个连接并立即关闭，让客户端尽快失败
+void Server::dropPendingConn() {
+    metrics::Server().acceptDropped.Inc();
+    if (_reserveFd < 0) {
+        LOG_W("Too many open files and no reserve fd, accept paused.");
+        return;
+    }
+    close(_reserveFd);
+    if (const int fd = accept4(_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        fd >= 0) {
+        close(fd);
+    }
+    _reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    ++_acceptDropped;
+    // 连接风暴时每秒最多记一条
+    if (const auto now = std::chrono::steady_clock::now();
+        now - _lastDropLog >= std::chrono::seconds(1)) {
+        LOG_W("Too many open files, dropped {} pending connection(s).",
+              _acceptDropped);
+        _acceptDropped = 0;
+        _lastDropLog = now;
+    }
+}
+
+///@thread reactor 线程
+void Server::dealEvent(const int fd, const uint32_t events,
+                       const std::string_view data) {
+    // 完成式下 EPOLLIN 事件是 recv 的结果，关闭和出错随数据进收件箱，不直接 IO_HUP
+    const bool received = _epoller->CompletionIo() && (events & EPOLLIN);
+    uint32_t ready = 0;
+    if (!received && (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        ready |= http::Conn::IO_HUP;
+    }
+    if (events & EPOLLIN) {
+        ready |= http::Conn::IO_READ;
+    }
+    if (events & EPOLLOUT) {
+        ready |= http::Conn::IO_WRITE;
+    }
+    // _users 只由循环线程增删，这里读不需要加锁，连接也不会被并发析构
+    const auto it = _users.find(fd);
+    if (it == _users.end() || !it->second.conn) {
+        /* 和原版不一样的处理：
+           若 fd 已被关闭或未注册到 _users，但 epoll 仍在监听，
+           可能因内核事件队列未清空导致事件重复触发
+        */
+        if (!_epoller->DelFd(fd)) { // 从epoll中删除并关闭
+            LOG_W("Invalid fd: {} from epoll!", fd);
+        }
+        close(fd);
         return;
     }
+    http::Conn *client = it->second.conn.get();
+    // 先进收件箱再通知：持有线程看到 IO_READ 时数据一定已经在了，关闭前收到的请求也不会丢
+    if (received &&
+        client->Deliver(data, events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) &&
+        !_epoller->ModFd(fd, _connEvent & ~EPOLLIN)) {
+        LOG_W("Failed to pause receiving on fd {}!", fd);
+    }
+    if (client->Notify(ready)) {
+        schedule(client);
+    }
+    // 否则已有工作线程持有该连接，或只是不关心的可写事件
+}
+
+///@thread 循环线程，调用方刚取得连接的所有权
+void Server::schedule(http::Conn *client) {
     extentTime(client); // TODO 两种计时器处理差异的本质所在
     // client 是值捕获。引用捕获很容易崩溃
-    _threadpool->AddTask([this, client] { onRead(client); });
+    _threadpool->AddTaskOnNode(client->GetNode(),
+                               [this, client] { onEvent(client); });
 }
 
 ///@thread 安全
-void Server::dealWrite(http::Conn *client) {
-    assert(client);
-    if (!client) {
-        return;
+void Server::post(const LoopCommand &cmd) {
+    if (_commands.Push(cmd)) {
+        wakeup(); // 队列原本非空时循环已被唤醒过，会一并取走
     }
-    int fd = client->GetFd();
-    if (fd <= 0) {
-        LOG_E("Invalid fd {}!", fd);
+}
+
+///@thread 安全
+void Server::wakeup() const {
+    if (_wakeupFd < 0) {
         return;
     }
-    std::shared_lock readLocker(_connMutex, std::defer_lock);
-    readLocker.lock();
-    const size_t ret = _users.count(fd);
-    readLocker.unlock();
-    if (ret == 0) {
-        LOG_E("Fd {} not found in _users!", fd);
-        return;
+    constexpr uint64_t one = 1;
+    if (write(_wakeupFd, &one, sizeof(one)) != sizeof(one) &&
+        errno != EAGAIN) {
+        LOG_W("Failed to wake event loop: {}", strerror(errno));
     }
-    extentTime(client);
-    _threadpool->AddTask([this, client] { onWrite(client); });
+}
+
+///@thread 安全
+void Server::Adopt(const int fd, const sockaddr_in &addr) {
+    post({LoopCommand::Kind::ADOPT, fd, 0, false, addr});
+}
+
+///@thread 循环线程
+void Server::drainCommands() {
+    _commands.Drain([this](const LoopCommand &cmd) {
+        switch (cmd.kind) {
+        case LoopCommand::Kind::SHUTDOWN:
+            _isClose.store(true, std::memory_order_release);
+            break;
+        case LoopCommand::Kind::DRAIN:
+            startDrain();
+            break;
+        case LoopCommand::Kind::ADOPT:
+            if (_draining) {
+                close(cmd.fd);
+            } else if (checkServerNotFull(cmd.fd)) {
+                addClient(cmd.fd, cmd.addr);
+            }
+            break;
+        case LoopCommand::Kind::CLOSE:
+        case LoopCommand::Kind::TIMEOUT:
+        case LoopCommand::Kind::ARM_WRITE:
+        case LoopCommand::Kind::RESUME_READ: {
+            const auto it = _users.find(cmd.fd);
+            if (it == _users.end() || !it->second.conn ||
+                it->second.connId != cmd.connId) {
+                break; // 已关闭，或 fd 已被新连接复用
+            }
+            http::Conn *client = it->second.conn.get();
+            if (cmd.kind == LoopCommand::Kind::RESUME_READ) {
+                // 暂停与恢复都在循环线程上，不会和 dealEvent 的暂停交错
+                if (client->ResumeRecv() &&
+                    !_epoller->ModFd(cmd.fd, _connEvent)) {
+                    LOG_W("Failed to resume receiving on fd {}!", cmd.fd);
+                }
+            } else if (cmd.kind == LoopCommand::Kind::TIMEOUT &&
+                       client->ProbeIdle()) {
+                // WebSocket 空闲：ping 已放进发件箱，再等一个超时周期
+                extentTime(client);
+                client->WantWrite(true);
+                if (client->Notify(http::Conn::IO_WRITE)) {
+                    schedule(client);
+                }
+            } else if (cmd.kind != LoopCommand::Kind::ARM_WRITE) {
+                // 不是持有者发起的（如超时）：有工作线程持有时交给它在 Release 时关闭
+                if (cmd.owned || client->Notify(http::Conn::IO_HUP)) {
+                    removeConn(client);
+                }
+            } else {
+                client->WantWrite(true);
+                if (client->Notify(http::Conn::IO_WRITE)) {
+                    schedule(client);
+                }
+            }
+            break;
+        }
+        }
+    });
 }
 
 ///@thread 安全
@@ -597,7 +1144,7 @@ void Server::extentTime(http::Conn *client) {
         return;
     }
     std::shared_lock readLocker(this->_connMutex, std::defer_lock);
-    if (_timeoutMS <= 0) {
+    if (_timeoutMS <= 0 && !http::Conn::Deadlines()) {
         return;
     }
     int fd = client->GetFd();
@@ -612,6 +1159,16 @@ void Server::extentTime(http::Conn *client) {
     }
     uint64_t connId = _users.at(fd).connId;
     readLocker.unlock();
+    // 空闲超时与读写进度的截止时间（慢速攻击）取先到者
+    int timeout = _timeoutMS;
+    if (const int64_t deadline = client->Deadline(); deadline > 0) {
+        const auto left = static_cast<int>(
+            std::max<int64_t>(deadline - http::Conn::NowMs(), 0));
+        timeout = timeout > 0 ? std::min(timeout, left) : left;
+    } else if (timeout <= 0) {
+        TimerManagerImpl::GetInstance().CancelByKey(fd);
+        return;
+    }
     /*
         使用ScheduleWithKey，确保每个文件描述符只有一个定时器
         webserver 11 里只调用了一个 timer_->adjust
@@ -620,26 +1177,13 @@ void Server::extentTime(http::Conn *client) {
     // 没有细看Timer实现，不知道原本的有没有取消
     // TimerManagerImpl::GetInstance().CancelByKey(connId); // TODO ??
     TimerManagerImpl::GetInstance().ScheduleWithKey(
-        fd, _timeoutMS, 0, [this, fd, connId]() {
+        fd, timeout, 0, [this, fd, connId]() {
             if (_isClose.load(std::memory_order_acquire)) {
                 LOG_D("Timer callback aborted: server is closing.");
                 return;
             }
-            http::Conn *conn = nullptr;
-            {
-                std::shared_lock lk(this->_connMutex);
-                if (_users[fd].connId != connId) {
-                    LOG_D("ConnId mismatch for fd {} (expected {}, found {}).",
-                          fd, connId, _users[fd].connId);
-                    return;
-                }
-                conn = _users[fd].conn.get();
-            }
-            if (conn) {
-                if (!conn->IsClosed()) {
-                    this->closeConn(conn);
-                }
-            }
+            // connId 由事件循环校验，工作线程正持有时由它关闭
+            post({LoopCommand::Kind::TIMEOUT, fd, connId, false, {}});
         });
 }
 
@@ -660,43 +1204,173 @@ void Server::handleReadError(http::Conn *client, int err) {
     closeConn(client);
 }
 
+///@thread 工作线程在线程池里调用，调用方持有连接
+void Server::onEvent(http::Conn *client) {
+    assert(client);
+    if (!checkFdAndMatchId(client)) {
+        LOG_W("Not match!");
+        return;
+    }
+    const uint32_t ready = client->TakeReady();
+    if (ready & http::Conn::IO_HUP) {
+        closeConn(client);
+        return;
+    }
+    if (client->ToWriteBytes() > 0) {
+        // 上一个响应还没写完，先不读新请求
+        if (ready & http::Conn::IO_READ) {
+            client->DeferRead();
+        }
+        if (ready & http::Conn::IO_WRITE) {
+            onWrite(client);
+        } else {
+            finishIo(client);
+        }
+        return;
+    }
+    if ((ready & http::Conn::IO_READ) || client->TakeDeferredRead()) {
+        onRead(client);
+        return;
+    }
+    if (client->HasQueued()) { // 其他线程投递的 WebSocket 帧、流式响应数据
+        onProcess(client);
+        return;
+    }
+    finishIo(client);
+}
+
+///@thread 工作线程在线程池里调用，调用方持有连接
+void Server::finishIo(http::Conn *client) {
+    if (client->Release()) {
+        return;
+    }
+    // 处理期间又来了事件：重新排队而不是原地循环，避免长连接霸占工作线程
+    _threadpool->AddTaskOnNode(client->GetNode(),
+                               [this, client] { onEvent(client); });
+}
+
 ///@thread 工作线程在线程池里调用
 void Server::onRead(http::Conn *client) {
     assert(client);
-    const int fd = client->GetFd();
+    int readErrno = 0;
+    const ssize_t ret = client->Read(&readErrno);
+    if (_epoller->CompletionIo() && client->RecvPaused()) {
+        // 收件箱已取空，请循环线程恢复接收
+        post({LoopCommand::Kind::RESUME_READ, client->GetFd(),
+              client->GetConnId(), false, {}});
+    }
+    afterRead(client, ret, readErrno);
+}
+
+///@thread 工作线程在线程池里调用，调用方持有连接
+///@intro TCP_DEFER_ACCEPT 下 accept 时首个请求已在内核缓冲区：
+/// 循环线程注册 fd 后直接派发本任务读取，不必等下一轮 epoll_wait 报告可读
+void Server::onAccept(http::Conn *client) {
+    assert(client);
     if (!checkFdAndMatchId(client)) {
-        LOG_W("Not match!");
         return;
     }
+    (void)client->TakeReady();
     int readErrno = 0;
-    if (const ssize_t ret = client->Read(&readErrno); ret == 0) {
+    const ssize_t ret = client->Read(&readErrno);
+    afterRead(client, ret, readErrno);
+}
+
+///@thread 工作线程在线程池里调用
+void Server::afterRead(http::Conn *client, const ssize_t ret,
+                       const int readErrno) {
+    if (ret == 0) {
         /*
         经常收到 104 应该是ECONNRESET，即对端重置了连接
         read返回0表示对端正常关闭连接（发送了FIN），此时应视为正常关闭，而不是错误
         */
-        LOG_D("Shutdown on fd={}.", fd); // 对端关闭
+        LOG_D("Shutdown on fd={}.", client->GetFd()); // 对端关闭
         closeConn(client);
         return;
-    } else if (ret < 0) {
+    }
+    if (ret < 0) {
         /*
             EWOULDBLOCK 和 EAGAIN 的值一样，本质上是同一个错误
-            非阻塞模式下，数据尚未准备好，需等待下次事件通知
-            原版放在 onProcess 中处理
-            此实现在 client->Read 里也进行了处理，但是没有调整fd。
-            放在handleEagain中具体处理。
+            非阻塞模式下，数据尚未准备好：ET 下 fd 一直在 epoll 中，
+            有新数据时会再次通知，这里只需交还连接
         */
         if (readErrno == EAGAIN || readErrno == EWOULDBLOCK) {
-            LOG_D("Shutdown on fd={}.", fd);
-            if (!_epoller->ModFd(fd, EPOLLIN)) {
-                LOG_E("Failed to re-arm EPOLLIN on fd={}!", fd);
-                closeConn(client);
-            }
+            dispatchProcess(client); // 可能还有未处理完的流水线请求
+            return;
         }
         handleReadError(client, readErrno);
         return;
     }
+    if (readErrno != EAGAIN && readErrno != EWOULDBLOCK) {
+        // 达到单次读取上限而不是读空，不会再有新的边缘，自己补记可读
+        client->MarkReady(http::Conn::IO_READ);
+    }
     // ret > 0 只有当确实读取到数据时才处理请求
-    onProcess(client);
+    dispatchProcess(client);
+}
+
+///@thread 工作线程在线程池里调用
+void Server::dispatchProcess(http::Conn *client) {
+    if (client->HasRequest()) {
+        if (const int code = admitRequest(client->GetLimiterSlot()); code != 0) {
+            rejectBusy(client, code);
+            return;
+        }
+    }
+    const http::Conn::Lane route = client->PickLane();
+    if (route == http::Conn::Lane::IO) {
+        onProcess(client);
+        return;
+    }
+    // 积压到上限时直接拒绝，不再往队列里堆；连接仍由本任务持有（IO_OWNED），
+    // 交出去后只有该任务会再碰它
+    if (!enqueue(
+            route, [this, client] { onProcess(client); },
+            [this, client] { rejectBusy(client); })) {
+        LOG_W("{} lane full, reject fd={}.",
+              route == http::Conn::Lane::BLOCKING ? "Blocking" : "Normal",
+              client->GetFd());
+        rejectBusy(client);
+    }
+}
+
+bool Server::enqueue(const http::Conn::Lane route, std::function<void()> task,
+                     std::function<void()> onShed) {
+    const bool blocking = route == http::Conn::Lane::BLOCKING;
+    const auto lane =
+        blocking ? ThreadPool::Lane::BLOCKING : ThreadPool::Lane::NORMAL;
+    const int deadlineMS = blocking ? _blockingDeadlineMS : _normalDeadlineMS;
+    const auto deadline =
+        deadlineMS > 0 ? ThreadPool::Clock::now() +
+                             std::chrono::milliseconds(deadlineMS)
+                       : ThreadPool::Clock::time_point{};
+    return !_threadpool->Saturated(lane) &&
+           _threadpool->AddTask(lane, std::move(task), deadline,
+                                std::move(onShed));
+}
+
+///@thread 持有连接的工作线程
+int Server::admitRequest(const int limiterSlot) {
+    if (_limiter.RateLimited() && !_limiter.Acquire(limiterSlot)) {
+        metrics::Server().limitedRequests.Inc();
+        return 429;
+    }
+    if (_overload.Shed()) {
+        metrics::Server().overloadShed.Inc();
+        return 503;
+    }
+    return 0;
+}
+
+///@thread 工作线程在线程池里调用
+void Server::rejectBusy(http::Conn *client, const int code) {
+    if (!checkFdAndMatchId(client)) {
+        return;
+    }
+    client->RejectBusy(code);
+    int writeErrno = 0;
+    (void)client->Write(&writeErrno); // 尽力而为，发不完也直接关闭
+    closeConn(client);
 }
 
 ///@thread 工作线程在线程池里调用
@@ -709,21 +1383,19 @@ void Server::onProcess(http::Conn *client) {
     int fd = client->GetFd();
     switch (client->Process()) {
     case http::Conn::ProcessResult::NEED_MORE_DATA:
-        /* 重新注册EPOLLIN */
-        if (!_epoller->ModFd(fd, _connEvent | EPOLLIN)) {
-            LOG_E("Failed to mod fd {}! {}", fd, strerror(errno));
-            closeConn(client);
+        // fd 一直在 epoll 中，等下一个可读边缘
+        if (client->Deadline() > 0) {
+            extentTime(client); // 请求没收全：按首部或正文的截止时间重新计时
         }
+        finishIo(client);
         break;
     case http::Conn::ProcessResult::OK:
-        /* 处理成功，注册EPOLLOUT等待可写事件*/
-        if (!_epoller->ModFd(fd, _connEvent | EPOLLOUT)) {
-            LOG_E("Failed to mod fd {}! {}", fd, strerror(errno));
-            closeConn(client);
-        }
+        // 直接写，写不完再等可写边缘
+        onWrite(client);
         break;
     case http::Conn::ProcessResult::RETRY_LATER:
         // TODO
+        finishIo(client);
         break;
     case http::Conn::ProcessResult::ERROR:
         LOG_W("Failed to process fd {}! {}", fd, strerror(errno));
@@ -742,11 +1414,25 @@ void Server::onWrite(http::Conn *client) {
     }
     int ret = -1;
     int writeErrno = 0;
+    client->WantWrite(true);
     ret = static_cast<int>(client->Write(&writeErrno));
     extentTime(client);
     if (client->ToWriteBytes() == 0) { // 传输完成 TODO 长连接的其他处理
+        client->WantWrite(false);
+        if (client->InFlight()) {
+            // 下一段交给新任务生成：不在本栈上递归，长流也不会一直占着工作线程
+            if (client->HasQueued()) {
+                client->MarkReady(http::Conn::IO_WRITE);
+            }
+            finishIo(client);
+            return;
+        }
         if (client->IsKeepAlive()) {
-            onProcess(client);
+            if (client->TakeDeferredRead()) {
+                onRead(client);
+            } else {
+                dispatchProcess(client);
+            }
             return;
         }
         closeConn(client);
@@ -754,10 +1440,8 @@ void Server::onWrite(http::Conn *client) {
     }
     if (ret < 0) { // 以下均为新加 TODO check
         if (writeErrno == EAGAIN || writeErrno == EWOULDBLOCK) {
-            // 内核发送缓冲区已满，需要等待可写事件
-            if (!_epoller->ModFd(fd, _connEvent | EPOLLOUT)) {
-                LOG_E("Failed to adjust fd {} EPOLLOUT!", fd);
-            }
+            // 内核发送缓冲区已满，等待可写边缘（IO_WANT_WRITE 已打开）
+            finishIo(client);
             return;
         }
         LOG_E("Write err: fd:{}, connId:{}, errno:{}.", fd, client->GetConnId(),
@@ -765,12 +1449,25 @@ void Server::onWrite(http::Conn *client) {
         closeConn(client);
         return;
     }
-    // ret >= 0 但还有数据需要发送，继续注册EPOLLOUT事件
-    if (client->ToWriteBytes() > 0) {
-        if (!_epoller->ModFd(fd, _connEvent | EPOLLOUT)) {
-            LOG_E("Failed to adjust fd {} EPOLLOUT!", fd);
-        }
+    // ret >= 0 但还有数据需要发送
+    if (writeErrno != EAGAIN && writeErrno != EWOULDBLOCK) {
+        // 达到单次写出上限，缓冲区没满就不会有可写边缘，自己补记
+        client->MarkReady(http::Conn::IO_WRITE);
+    }
+    finishIo(client);
+}
+
+bool Server::initWakeup() {
+    _wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeupFd < 0) {
+        return false;
     }
+    if (!_epoller->AddFd(_wakeupFd, EPOLLIN)) {
+        close(_wakeupFd);
+        _wakeupFd = -1;
+        return false;
+    }
+    return true;
 }
 
 /* Create listenFd */
@@ -802,7 +1499,21 @@ bool Server::initSocket() {
         optLinger.l_linger = 1;
     }
 
-    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (Config::Has("upgrade.socket")) {
+        _upgradePath = GET_CONFIG("upgrade.socket");
+    }
+    if (!_upgradePath.empty()) {
+        // 热重启：前任进程还在时直接接过它的监听 socket
+        if (const int inherited = handoff::Receive(_upgradePath);
+            inherited >= 0) {
+            _listenFd = inherited;
+            LOG_I("Inherited listen fd {} from predecessor.", _listenFd);
+            applyListenOptions();
+            return initUpgrade() && initListenEvent();
+        }
+    }
+    // 监听 socket 本身非阻塞；accept4 为新连接单独设置 NONBLOCK|CLOEXEC
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (_listenFd < 0) {
         LOG_E("Create socket error!, port: {0}, {1}", _port, strerror(errno));
         return false;
@@ -837,21 +1548,53 @@ bool Server::initSocket() {
      * 参数指定了套接字监听队列的预期最大长度，用于存放已完成三次握手但尚未被
      * accept() 处理的连接
      */
-    ret = listen(_listenFd, SOMAXCONN); // 使用系统默认最大值，Linux内核会取
-                                        // backlog 与 SOMAXCONN 的较小值
+    applyListenOptions();
+    // 未配置或为 0 时使用系统最大值，Linux内核会取 backlog 与 net.core.somaxconn 的较小值
+    int backlog = 0;
+    readUnsigned("tcp.backlog", backlog);
+    ret = listen(_listenFd, backlog > 0 ? backlog : SOMAXCONN);
     if (ret < 0) {
         LOG_E("Listen port: {0} error!, {1}", _port, strerror(errno));
         close(_listenFd);
         return false;
     }
-    ret = _epoller->AddFd(_listenFd, _listenEvent | EPOLLIN);
-    if (ret == 0) {
+    // Linux 上 accept 出来的连接继承 TCP_NODELAY，不必每个连接再 setsockopt
+    if (setNoDelay(_listenFd) < 0) {
+        LOG_W("Failed to set TCP_NODELAY on listen fd: {}", strerror(errno));
+    }
+    return initUpgrade() && initListenEvent();
+}
+
+///@intro 把监听 fd 注册到事件后端，并准备 EMFILE 预留 fd
+bool Server::initListenEvent() {
+    if (!_epoller->AddListener(_listenFd, _listenEvent | EPOLLIN)) {
         LOG_E("Add listen fd : {0} error! {1}", _listenFd, strerror(errno));
         close(_listenFd);
         return false;
     }
-    if (setFdNonBlock(_listenFd) < 0) {
-        LOG_E("Failed to set fd {}! {}", _listenFd, strerror(errno));
+    // 预留一个 fd，EMFILE 时腾出来接下并关闭排队的连接
+    _reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (_reserveFd < 0) {
+        LOG_W("Failed to open reserve fd: {}", strerror(errno));
+    }
+    return true;
+}
+
+///@intro 在 [upgrade] socket 上等待继任进程来取监听 fd，未配置时什么都不做
+bool Server::initUpgrade() {
+    if (_upgradePath.empty()) {
+        return true;
+    }
+    _upgradeFd = handoff::Listen(_upgradePath);
+    if (_upgradeFd < 0) {
+        LOG_W("Failed to listen on upgrade socket {}: {}", _upgradePath,
+              strerror(errno));
+        return true; // 只是不能热重启
+    }
+    if (!_epoller->AddFd(_upgradeFd, EPOLLIN)) {
+        LOG_W("Failed to add upgrade socket to epoll!");
+        close(_upgradeFd);
+        _upgradeFd = -1;
     }
     return true;
 }
@@ -883,6 +1626,184 @@ bool Server::checkFdAndMatchId(const http::Conn *client) const {
     return true;
 }
 
+void Server::logLevelsFromConfig(const int logLevel) {
+    if (logLevel >= 0) {
+        Logger::SetLevel(static_cast<spdlog::level::level_enum>(logLevel));
+    }
+    // 按模块覆盖日志级别，例如 [log] http = "warn"
+    for (const char *module : {"core", "http", "timer", "db", "other"}) {
+        const std::string key = std::string("log.") + module;
+        if (Config::Has(key) && !Logger::SetLevel(module, GET_CONFIG(key))) {
+            LOG_W("Invalid log level '{}' for {}!", GET_CONFIG(key), key);
+        }
+    }
+}
+
+void Server::loopFromConfig() {
+    if (Config::Has("cpu.pin") && GET_CONFIG("cpu.pin") == "true" &&
+        Config::Has("cpu.reactor")) {
+        _reactorCpus = cpu::ParseList(GET_CONFIG("cpu.reactor"));
+    }
+    readUnsigned("app.drainTimeout", _drainTimeoutMS);
+    readUnsigned("app.acceptBudget", _acceptBudget, 1);
+    readUnsigned("thread.normalDeadline", _normalDeadlineMS);
+    readUnsigned("thread.blockingDeadline", _blockingDeadlineMS);
+}
+
+void Server::httpFromConfig() {
+    if (Config::Has("http2.h2c")) {
+        http::Conn::enableH2c = GET_CONFIG("http2.h2c") == "true";
+    }
+    readUnsigned("http2.maxStreams", http::H2Session::maxStreams, 1);
+    readUnsigned("http.headerTimeout", http::Conn::headerTimeoutMS);
+    readUnsigned("http.minBodyRate", http::Conn::minBodyRate);
+    readUnsigned("http.minWriteRate", http::Conn::minWriteRate);
+    readUnsigned("http.rateGrace", http::Conn::rateGraceMS);
+    readUnsigned("http.maxHeaderBytes", http::Request::maxHeaderBytes, 256);
+    readUnsigned("http.maxHeaders", http::Request::maxHeaders, 1);
+    readUnsigned("http.maxBodyBytes", http::Request::maxBodyBytes);
+    if (Config::Has("cache.maxBytes")) {
+        size_t bytes = 0;
+        readUnsigned("cache.maxBytes", bytes);
+        http::ResponseCache::GetInstance().SetCapacity(bytes);
+    }
+}
+
+ThreadPoolLanes Server::lanesFromConfig() {
+    ThreadPoolLanes lanes;
+    readUnsigned("thread.normalQuota", lanes.normalQuota);
+    readUnsigned("thread.normalQueue", lanes.normalQueue);
+    readUnsigned("thread.blockingSize", lanes.blockingThreads);
+    readUnsigned("thread.blockingQueue", lanes.blockingQueue);
+    return lanes;
+}
+
+ThreadPoolSizing Server::sizingFromConfig() {
+    ThreadPoolSizing sizing;
+    if (Config::Has("thread.adaptive")) {
+        sizing.adaptive = GET_CONFIG("thread.adaptive") == "true";
+    }
+    readUnsigned("thread.minSize", sizing.minThreads);
+    readUnsigned("thread.maxSize", sizing.maxThreads);
+    readUnsigned("thread.growDelayUs", sizing.growDelayUs);
+    readUnsigned("thread.shrinkDelayUs", sizing.shrinkDelayUs);
+    return sizing;
+}
+
+ThreadPoolAffinity Server::affinityFromConfig() {
+    ThreadPoolAffinity affinity;
+    if (!Config::Has("cpu.pin") || GET_CONFIG("cpu.pin") != "true") {
+        return affinity;
+    }
+    const auto list = [](const char *key) {
+        return Config::Has(key) ? cpu::ParseList(GET_CONFIG(key))
+                                : std::vector<int>{};
+    };
+    affinity.workerCpus = list("cpu.workers");
+    if (affinity.workerCpus.empty()) {
+        // 默认使用除 reactor 外的所有可用 CPU
+        const auto reactor = list("cpu.reactor");
+        for (const int id : cpu::Available()) {
+            if (std::find(reactor.begin(), reactor.end(), id) == reactor.end()) {
+                affinity.workerCpus.push_back(id);
+            }
+        }
+        if (affinity.workerCpus.empty()) {
+            affinity.workerCpus = cpu::Available();
+        }
+    }
+    affinity.blockingCpus = list("cpu.blocking");
+    if (affinity.blockingCpus.empty()) {
+        affinity.blockingCpus = affinity.workerCpus;
+    }
+    affinity.nodeQueues =
+        Config::Has("cpu.steer") && GET_CONFIG("cpu.steer") == "true";
+    return affinity;
+}
+
+///@intro 读取 [tcp]，在 listen 之前设置监听 socket 的 TCP 选项
+void Server::applyListenOptions() {
+    int secs = 0;
+    int qlen = 0;
+    readUnsigned("tcp.deferAccept", secs);
+    readUnsigned("tcp.fastOpen", qlen);
+    // 三次握手完成后不立即唤醒 accept，直到首个数据包到达（或超时，单位秒）
+    if (secs > 0) {
+        if (setsockopt(_listenFd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &secs,
+                       sizeof(secs)) == 0) {
+            _readOnAccept = true;
+        } else {
+            LOG_W("Failed to set TCP_DEFER_ACCEPT: {}", strerror(errno));
+        }
+    }
+    // 允许客户端在 SYN 里携带请求，值为未完成 TFO 握手的队列长度
+    if (qlen > 0) {
+        // 只有用 TFO 的客户端才会随 SYN 带数据，其余连接 accept 时还没有请求，
+        // 不开 accept 后直接读，免得每个连接多一次读到 EAGAIN 的任务
+        if (setsockopt(_listenFd, IPPROTO_TCP, TCP_FASTOPEN, &qlen,
+                       sizeof(qlen)) == 0) {
+            // 服务端 TFO 还需要 net.ipv4.tcp_fastopen 打开第 2 位
+            if (std::ifstream sysctl("/proc/sys/net/ipv4/tcp_fastopen");
+                sysctl) {
+                int mode = 0;
+                sysctl >> mode;
+                if (!(mode & 2)) {
+                    LOG_W("TCP_FASTOPEN set but net.ipv4.tcp_fastopen={} has "
+                          "server support disabled.",
+                          mode);
+                }
+            }
+        } else {
+            LOG_W("Failed to set TCP_FASTOPEN: {}", strerror(errno));
+        }
+    }
+}
+
+EventBackendOptions Server::backendFromConfig() {
+    EventBackendOptions opts;
+    if (Config::Has("app.backend")) {
+        opts.kind = GET_CONFIG("app.backend");
+    }
+    readUnsigned("uring.entries", opts.uringEntries, 1);
+    if (Config::Has("uring.sqpoll")) {
+        opts.uringSqpoll = GET_CONFIG("uring.sqpoll") == "true";
+    }
+    if (Config::Has("uring.completion")) {
+        opts.uringCompletion = GET_CONFIG("uring.completion") == "true";
+    }
+    return opts;
+}
+
+OverloadOptions Server::overloadFromConfig() {
+    OverloadOptions opts;
+    readUnsigned("overload.loopLag", opts.loopLagMs);
+    readUnsigned("overload.queueDelay", opts.queueDelayMs);
+    readUnsigned("overload.shedStep", opts.shedStep);
+    if (Config::Has("overload.closeKeepAlive")) {
+        opts.closeKeepAlive = GET_CONFIG("overload.closeKeepAlive") == "true";
+    }
+    return opts;
+}
+
+LimiterOptions Server::limiterFromConfig() {
+    LimiterOptions opts;
+    readUnsigned("limit.maxConnsPerIp", opts.maxConnsPerIp);
+    readUnsigned("limit.rate", opts.rate);
+    readUnsigned("limit.burst", opts.burst);
+    readUnsigned("limit.tableSize", opts.tableSize);
+    return opts;
+}
+
+int Server::incomingNode(const int fd) {
+    int cpuId = -1;
+    socklen_t len = sizeof(cpuId);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpuId, &len) != 0 ||
+        cpuId < 0) {
+        return -1;
+    }
+    return cpu::NodeOf(cpuId);
+}
+
 } // namespace v0
 
 std::unique_ptr<v0::Server> NewServerFromConfig(const std::string &configPath) {
@@ -903,11 +1824,27 @@ std::unique_ptr<v0::Server> NewServerFromConfig(const std::string &configPath) {
     const auto sqlPoolSize = atoi(zener::GET_CONFIG("mysql.poolSize").c_str());
     const auto threadPoolSize =
         atoi(zener::GET_CONFIG("thread.poolSize").c_str());
+    int logLevel = -1;
+    if (spdlog::level::level_enum lvl;
+        Logger::ParseLevel(zener::GET_CONFIG("log.level"), lvl)) {
+        logLevel = static_cast<int>(lvl);
+    } else {
+        LOG_W("Invalid log.level '{}', keep all levels.",
+              zener::GET_CONFIG("log.level"));
+    }
+    // 未开启异步日志时队列大小为 -1
+    int logQueueSize = -1;
+    if (zener::GET_CONFIG("log.async") == "true") {
+        logQueueSize = atoi(zener::GET_CONFIG("log.queueSize").c_str());
+        if (logQueueSize <= 0) {
+            logQueueSize = DEFAULT_ASYNC_QUEUE_SIZE;
+        }
+    }
 
     auto server = std::make_unique<v0::Server>(
         appPort, trig, timeout, false, sqlHost, sqlPort, sqlUser.c_str(),
         sqlPassword.c_str(), database.c_str(), sqlPoolSize, threadPoolSize,
-        true);
+        true, logLevel, logQueueSize);
     assert(server);
     return server;
 }
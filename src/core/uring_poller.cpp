@@ -0,0 +1,678 @@
+#include "core/uring_poller.h"
+#include "utils/log/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <linux/time_types.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace zener {
+
+namespace {
+
+unsigned loadAcquire(unsigned *p) {
+    return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void storeRelease(unsigned *p, const unsigned value) {
+    std::atomic_ref<unsigned>(*p).store(value, std::memory_order_release);
+}
+
+// 交给内核的 poll 掩码只保留事件位，去掉 EPOLLET/EPOLLONESHOT 等控制位
+constexpr uint32_t POLL_MASK =
+    EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
+
+} // namespace
+
+UringPoller::UringPoller(const int maxEvent, const unsigned entries,
+                         const bool sqpoll, const bool completion)
+    : _sqpoll(sqpoll), _fds(MAX_FD + 1) {
+    _events.reserve(maxEvent);
+    if (!setup(entries)) {
+        if (_ringFd >= 0) {
+            close(_ringFd);
+            _ringFd = -1;
+        }
+        return;
+    }
+    if (completion && !setupBufRing()) {
+        LOG_W("io_uring completion IO unavailable, using poll readiness.");
+    }
+}
+
+UringPoller::~UringPoller() {
+    if (_sqes) {
+        munmap(_sqes, _sqesSize);
+    }
+    if (_cqRing && _cqRing != _sqRing) {
+        munmap(_cqRing, _cqRingSize);
+    }
+    if (_sqRing) {
+        munmap(_sqRing, _sqRingSize);
+    }
+    if (_ringFd >= 0) {
+        close(_ringFd); // 先关环，内核不再使用缓冲区环
+    }
+    if (_bufRing) {
+        munmap(_bufRing, RECV_BUFS * sizeof(io_uring_buf));
+    }
+    if (_bufs) {
+        munmap(_bufs, static_cast<size_t>(RECV_BUFS) * RECV_BUF_SIZE);
+    }
+}
+
+bool UringPoller::setup(const unsigned entries) {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2; // 完成事件可能多于提交项（多次触发的 poll）
+    if (_sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = 1000; // 毫秒，空闲后内核线程睡眠
+    }
+    _ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (_ringFd < 0) {
+        LOG_W("io_uring_setup failed: {}", strerror(errno));
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG) ||
+        !(params.features & IORING_FEAT_NODROP)) {
+        LOG_W("io_uring lacks EXT_ARG/NODROP (features={:#x}).",
+              params.features);
+        return false;
+    }
+
+    _sqEntries = params.sq_entries;
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+    }
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        LOG_W("io_uring mmap sq ring failed: {}", strerror(errno));
+        return false;
+    }
+    if (singleMmap) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            LOG_W("io_uring mmap cq ring failed: {}", strerror(errno));
+            return false;
+        }
+    }
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        LOG_W("io_uring mmap sqes failed: {}", strerror(errno));
+        return false;
+    }
+    _sqes = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<char *>(_sqRing);
+    auto *cq = static_cast<char *>(_cqRing);
+    _sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sqFlags = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+    _sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    // 提交项下标与数组位置一一对应，之后只需推进 tail
+    auto *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; ++i) {
+        array[i] = i;
+    }
+    _sqLocalTail = loadAcquire(_sqTail);
+    return true;
+}
+
+int UringPoller::enter(const unsigned toSubmit, const unsigned minComplete,
+                       const unsigned flags, const void *arg,
+                       const size_t argSize) const {
+    return static_cast<int>(syscall(__NR_io_uring_enter, _ringFd, toSubmit,
+                                    minComplete, flags, arg, argSize));
+}
+
+bool UringPoller::setupBufRing() {
+    // SEND_ZC 与多次触发的 recv 同在 Linux 6.0 加入，用它判断内核是否支持
+    constexpr unsigned PROBE_OPS = IORING_OP_LAST;
+    std::vector<char> probeMem(sizeof(io_uring_probe) +
+                               PROBE_OPS * sizeof(io_uring_probe_op));
+    auto *probe = reinterpret_cast<io_uring_probe *>(probeMem.data());
+    if (syscall(__NR_io_uring_register, _ringFd, IORING_REGISTER_PROBE, probe,
+                PROBE_OPS) < 0 ||
+        probe->last_op < IORING_OP_SEND_ZC ||
+        !(probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED)) {
+        LOG_W("io_uring lacks multishot recv (needs Linux 6.0+).");
+        return false;
+    }
+
+    const size_t ringSize = RECV_BUFS * sizeof(io_uring_buf);
+    void *ring = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        LOG_W("io_uring mmap buffer ring failed: {}", strerror(errno));
+        return false;
+    }
+    const size_t bufsSize = static_cast<size_t>(RECV_BUFS) * RECV_BUF_SIZE;
+    void *bufs = mmap(nullptr, bufsSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufs == MAP_FAILED) {
+        LOG_W("io_uring mmap receive buffers failed: {}", strerror(errno));
+        munmap(ring, ringSize);
+        return false;
+    }
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = RECV_BUFS;
+    reg.bgid = RECV_GROUP;
+    if (syscall(__NR_io_uring_register, _ringFd, IORING_REGISTER_PBUF_RING,
+                &reg, 1) < 0) {
+        LOG_W("io_uring register buffer ring failed: {}", strerror(errno));
+        munmap(bufs, bufsSize);
+        munmap(ring, ringSize);
+        return false;
+    }
+    _bufRing = static_cast<io_uring_buf_ring *>(ring);
+    _bufs = static_cast<char *>(bufs);
+    _recycle.reserve(RECV_BUFS);
+    for (unsigned bid = 0; bid < RECV_BUFS; ++bid) {
+        _recycle.push_back(static_cast<uint16_t>(bid));
+    }
+    recycle();
+    return true;
+}
+
+io_uring_sqe *UringPoller::getSqe(const unsigned need) {
+    // 提交队列满了先交给内核
+    while (_sqLocalTail - loadAcquire(_sqHead) + need > _sqEntries) {
+        if (_sqpoll) {
+            enter(0, 0, IORING_ENTER_SQ_WAKEUP, nullptr, 0);
+            std::this_thread::yield();
+        } else if (enter(_sqLocalTail - loadAcquire(_sqHead), 0, 0, nullptr,
+                         0) < 0 &&
+                   errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_E("io_uring_enter submit failed: {}", strerror(errno));
+            return nullptr;
+        }
+    }
+    io_uring_sqe *sqe = &_sqes[_sqLocalTail++ & _sqMask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+void UringPoller::publish() const { storeRelease(_sqTail, _sqLocalTail); }
+
+void UringPoller::prepArm(const int fd, FdState &st) {
+    io_uring_sqe *sqe = getSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->fd = fd;
+    sqe->user_data = pack(fd, st.gen, st.op);
+    switch (st.op) {
+    case OP_POLL:
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->poll32_events = st.events & POLL_MASK;
+        // 边缘触发且非 ONESHOT 时使用多次触发的 poll
+        if ((st.events & EPOLLET) && !(st.events & EPOLLONESHOT)) {
+            sqe->len = IORING_POLL_ADD_MULTI;
+        }
+        break;
+    case OP_ACCEPT:
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        break;
+    case OP_RECV:
+        sqe->opcode = IORING_OP_RECV;
+        // EPOLLONESHOT 的连接收一次就停，由 ModFd 重新激活
+        if (!(st.events & EPOLLONESHOT)) {
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+        }
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = RECV_GROUP;
+        break;
+    case OP_SEND:
+        assert(false);
+        break;
+    }
+    publish();
+    st.armed = true;
+}
+
+void UringPoller::prepCancel(const uint64_t userData) {
+    io_uring_sqe *sqe = getSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData;
+    sqe->user_data = IGNORE_TAG;
+    publish();
+}
+
+void UringPoller::prepSend(const uint64_t key, const SendOp &op) {
+    // 发送和它的超时必须在同一批提交里才能链接上，所以一次取两个空位
+    io_uring_sqe *sqe = getSqe(2);
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = op.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(op.data.data() + op.off);
+    sqe->len = static_cast<uint32_t>(op.data.size() - op.off);
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->user_data = static_cast<uint64_t>(OP_SEND) << 56 | key;
+    io_uring_sqe *timeout = getSqe();
+    timeout->opcode = IORING_OP_LINK_TIMEOUT;
+    timeout->fd = -1;
+    timeout->addr = reinterpret_cast<uint64_t>(&_sendTimeout);
+    timeout->len = 1;
+    timeout->user_data = IGNORE_TAG;
+    publish();
+}
+
+void UringPoller::recycle() {
+    if (_recycle.empty()) {
+        return;
+    }
+    // 环就是 io_uring_buf 数组，tail 与第 0 项的 resv 重叠。不用 bufs 成员：
+    // C++ 下内核头文件的柔性数组宏会多出一个空结构体，把它挪到偏移 8
+    auto *bufs = reinterpret_cast<io_uring_buf *>(_bufRing);
+    for (const uint16_t bid : _recycle) {
+        io_uring_buf &buf = bufs[_bufTail++ & (RECV_BUFS - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(
+            _bufs + static_cast<size_t>(bid) * RECV_BUF_SIZE);
+        buf.len = RECV_BUF_SIZE;
+        buf.bid = bid;
+    }
+    _recycle.clear();
+    std::atomic_ref(_bufRing->tail).store(_bufTail, std::memory_order_release);
+}
+
+void UringPoller::flush() {
+    if (_sqpoll) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (loadAcquire(_sqFlags) & IORING_SQ_NEED_WAKEUP) {
+            enter(0, 0, IORING_ENTER_SQ_WAKEUP, nullptr, 0);
+        }
+        return;
+    }
+    if (std::this_thread::get_id() == _reactor) {
+        return; // 下一次 Wait 一并提交
+    }
+    if (const unsigned pending = _sqLocalTail - loadAcquire(_sqHead);
+        pending > 0 && enter(pending, 0, 0, nullptr, 0) < 0) {
+        LOG_W("io_uring_enter submit failed: {}", strerror(errno));
+    }
+}
+
+bool UringPoller::arm(const int fd, const uint32_t events, const Op op) {
+    FdState &st = _fds[fd];
+    if (st.armed) {
+        prepCancel(pack(fd, st.gen, st.op));
+    }
+    ++st.gen;
+    st.events = events;
+    st.op = op;
+    st.armed = false;
+    st.sending = false;
+    st.blocked = false;
+    if (op != OP_POLL && !(events & EPOLLIN)) {
+        return true; // 暂停的监听 socket、连接只登记，不挂 accept/recv
+    }
+    prepArm(fd, st);
+    return st.armed;
+}
+
+bool UringPoller::AddFd(const int fd, const uint32_t events) {
+    if (fd < 0 || fd > MAX_FD) {
+        return false;
+    }
+    std::lock_guard lk(_sqMtx);
+    const bool ok = arm(fd, events, OP_POLL);
+    flush();
+    return ok;
+}
+
+bool UringPoller::AddListener(const int fd, const uint32_t events) {
+    if (!CompletionIo()) {
+        return AddFd(fd, events);
+    }
+    if (fd < 0 || fd > MAX_FD) {
+        return false;
+    }
+    std::lock_guard lk(_sqMtx);
+    const bool ok = arm(fd, events, OP_ACCEPT);
+    flush();
+    return ok;
+}
+
+bool UringPoller::AddConn(const int fd, const uint32_t events) {
+    if (!CompletionIo()) {
+        return AddFd(fd, events);
+    }
+    if (fd < 0 || fd > MAX_FD) {
+        return false;
+    }
+    std::lock_guard lk(_sqMtx);
+    const bool ok = arm(fd, events, OP_RECV);
+    flush();
+    return ok;
+}
+
+bool UringPoller::ModFd(const int fd, const uint32_t events) {
+    if (fd < 0 || fd > MAX_FD) {
+        return false;
+    }
+    std::lock_guard lk(_sqMtx);
+    FdState &st = _fds[fd];
+    if (st.events == 0 || st.op == OP_POLL) {
+        const bool ok = arm(fd, events, OP_POLL);
+        flush();
+        return ok;
+    }
+    /*
+        完成式的监听 socket、连接只用 EPOLLIN 暂停、恢复 accept/recv，代数不变：
+        取消之前已经 accept 的连接、收到的数据照常交付，请求结束后再按 EPOLLIN 决定是否重提
+    */
+    st.events = events;
+    if (!(events & EPOLLIN)) {
+        if (st.armed) {
+            prepCancel(pack(fd, st.gen, st.op));
+        }
+    } else if (!st.armed) {
+        prepArm(fd, st);
+    }
+    flush();
+    return true;
+}
+
+bool UringPoller::DelFd(const int fd) {
+    if (fd < 0 || fd > MAX_FD) {
+        LOG_W("Deleting invalid fd:{} from io_uring!", fd);
+        return false;
+    }
+    std::lock_guard lk(_sqMtx);
+    FdState &st = _fds[fd];
+    if (st.armed) {
+        prepCancel(pack(fd, st.gen, st.op));
+    }
+    // 在途的发送不取消：内核已持有 socket，关闭 fd 后这一次照常完成，但不再续发
+    ++st.gen;
+    st.events = 0;
+    st.armed = false;
+    st.sending = false;
+    st.blocked = false;
+    flush();
+    return true;
+}
+
+ssize_t UringPoller::Send(const int fd, const iovec *iov, const int iovCnt) {
+    if (!CompletionIo() || fd < 0 || fd > MAX_FD) {
+        errno = EBADF;
+        return -1;
+    }
+    uint32_t gen = 0;
+    {
+        std::lock_guard lk(_sqMtx);
+        FdState &st = _fds[fd];
+        if (st.events == 0 || st.op != OP_RECV) {
+            errno = EBADF;
+            return -1;
+        }
+        if (st.sending) {
+            st.blocked = true;
+            errno = EAGAIN;
+            return -1;
+        }
+        gen = st.gen;
+    }
+    // 只有持有连接的线程会发送，拷贝时不需要持锁
+    auto op = std::make_unique<SendOp>();
+    op->fd = fd;
+    op->gen = gen;
+    for (int i = 0; i < iovCnt && op->data.size() < SEND_CHUNK; ++i) {
+        const auto *base = static_cast<const char *>(iov[i].iov_base);
+        const size_t n =
+            std::min(iov[i].iov_len, SEND_CHUNK - op->data.size());
+        op->data.insert(op->data.end(), base, base + n);
+    }
+    if (op->data.empty()) {
+        return 0;
+    }
+    const auto accepted = static_cast<ssize_t>(op->data.size());
+    std::lock_guard lk(_sqMtx);
+    FdState &st = _fds[fd];
+    if (st.gen != gen || st.events == 0) {
+        errno = EBADF; // 拷贝期间连接被关闭
+        return -1;
+    }
+    const uint64_t key = _nextSend++ & ((1ULL << 56) - 1);
+    prepSend(key, *op);
+    _sends.emplace(key, std::move(op));
+    st.sending = true;
+    flush();
+    return accepted;
+}
+
+void UringPoller::onSent(const uint64_t key, const int res) {
+    const auto it = _sends.find(key);
+    if (it == _sends.end()) {
+        return;
+    }
+    SendOp &op = *it->second;
+    FdState &st = _fds[op.fd];
+    // fd 号在连接关闭后可能已被新连接复用，只有仍是同一个连接时才能续发
+    const bool current = st.gen == op.gen && st.events != 0;
+    if (res > 0) {
+        op.off += static_cast<size_t>(res);
+    }
+    const bool done = op.off >= op.data.size();
+    if (current && res > 0 && !done) {
+        prepSend(key, op); // 短写（被信号等打断）：接着发剩下的
+        return;
+    }
+    const int fd = op.fd;
+    _sends.erase(it);
+    if (!current) {
+        return; // 连接已关闭：剩下的数据丢弃
+    }
+    st.sending = false;
+    if (res < 0 || !done) {
+        // 出错或超时被取消，按出错关闭连接
+        _events.push_back({fd, static_cast<uint32_t>(EPOLLERR)});
+    } else if (st.blocked) {
+        st.blocked = false;
+        _events.push_back({fd, static_cast<uint32_t>(EPOLLOUT)});
+    }
+}
+
+int UringPoller::Wait(const int timeoutMs) {
+    _events.clear();
+    unsigned toSubmit = 0;
+    unsigned flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    {
+        std::lock_guard lk(_sqMtx);
+        _reactor = std::this_thread::get_id();
+        recycle(); // 上一轮事件的数据已被取走
+        for (const int fd : _relevel) {
+            if (FdState &st = _fds[fd]; st.events != 0 && !st.armed &&
+                                        (st.op == OP_POLL ||
+                                         (st.events & EPOLLIN))) {
+                prepArm(fd, st);
+            }
+        }
+        _relevel.clear();
+        if (_sqpoll) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (loadAcquire(_sqFlags) & IORING_SQ_NEED_WAKEUP) {
+                flags |= IORING_ENTER_SQ_WAKEUP;
+            }
+        } else {
+            toSubmit = _sqLocalTail - loadAcquire(_sqHead);
+        }
+    }
+
+    __kernel_timespec ts{};
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    if (timeoutMs >= 0) {
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+    // 已有未取的完成事件或不等待时不阻塞
+    const bool ready = loadAcquire(_cqTail) != *_cqHead;
+    const unsigned minComplete = ready || timeoutMs == 0 ? 0 : 1;
+    if (enter(toSubmit, minComplete, flags, &arg, sizeof(arg)) < 0 &&
+        errno != ETIME && errno != EINTR && errno != EBUSY &&
+        errno != EAGAIN) {
+        LOG_E("io_uring_enter wait failed: {}", strerror(errno));
+        return -1;
+    }
+
+    unsigned head = *_cqHead;
+    const unsigned tail = loadAcquire(_cqTail);
+    std::lock_guard lk(_sqMtx);
+    for (; head != tail && _events.size() < _events.capacity(); ++head) {
+        const io_uring_cqe &cqe = _cqes[head & _cqMask];
+        if (cqe.user_data == IGNORE_TAG) {
+            continue;
+        }
+        const auto op = static_cast<Op>(cqe.user_data >> 56);
+        if (op == OP_SEND) {
+            onSent(cqe.user_data & ((1ULL << 56) - 1), cqe.res);
+            continue;
+        }
+        // 带数据的 recv 完成事件占用一个缓冲区，无论是否过期都要归还
+        const char *data = nullptr;
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            const auto bid =
+                static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            _recycle.push_back(bid);
+            data = _bufs + static_cast<size_t>(bid) * RECV_BUF_SIZE;
+        }
+        const int fd = static_cast<int>(cqe.user_data & 0xffffffffU);
+        const auto gen = static_cast<uint32_t>(cqe.user_data >> 32) & GEN_MASK;
+        if (fd < 0 || fd > MAX_FD) {
+            continue;
+        }
+        FdState &st = _fds[fd];
+        if ((st.gen & GEN_MASK) != gen || st.events == 0 || st.op != op) {
+            // 已被 ModFd/DelFd 取代的旧请求；取消前接受的连接没人要了，直接关闭
+            if (op == OP_ACCEPT && cqe.res >= 0) {
+                close(cqe.res);
+            }
+            continue;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            st.armed = false;
+            switch (op) {
+            case OP_POLL:
+                // 非 ONESHOT 的 fd 需要重提：边缘触发马上重提，水平触发留到下一轮
+                if (!(st.events & EPOLLONESHOT)) {
+                    if (st.events & EPOLLET) {
+                        prepArm(fd, st);
+                    } else {
+                        _relevel.push_back(fd);
+                    }
+                }
+                break;
+            case OP_ACCEPT:
+                _relevel.push_back(fd); // 出错（如 EMFILE）或被暂停，下一轮按 EPOLLIN 重提
+                break;
+            case OP_RECV:
+                // 对端关闭或出错后不再重提；缓冲区用完（ENOBUFS）等归还后重提；
+                // ONESHOT 收到数据后等 ModFd
+                if ((cqe.res > 0 && !(st.events & EPOLLONESHOT)) ||
+                    cqe.res == -ENOBUFS || cqe.res == -ECANCELED) {
+                    _relevel.push_back(fd);
+                }
+                break;
+            case OP_SEND:
+                break;
+            }
+        }
+        if (cqe.res == -ECANCELED) {
+            continue;
+        }
+        switch (op) {
+        case OP_POLL:
+            _events.push_back(
+                {fd, cqe.res < 0 ? static_cast<uint32_t>(EPOLLERR)
+                                 : static_cast<uint32_t>(cqe.res)});
+            break;
+        case OP_ACCEPT:
+            _events.push_back(
+                {fd, static_cast<uint32_t>(EPOLLIN), cqe.res});
+            break;
+        case OP_RECV:
+            if (cqe.res > 0) {
+                _events.push_back({fd, static_cast<uint32_t>(EPOLLIN), -1,
+                                   data, static_cast<uint32_t>(cqe.res)});
+            } else if (cqe.res == 0) {
+                _events.push_back(
+                    {fd, static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP)});
+            } else if (cqe.res != -ENOBUFS) {
+                _events.push_back(
+                    {fd, static_cast<uint32_t>(EPOLLIN | EPOLLERR)});
+            }
+            break;
+        case OP_SEND:
+            break;
+        }
+    }
+    storeRelease(_cqHead, head);
+    return static_cast<int>(_events.size());
+}
+
+int UringPoller::GetEventFd(const int i) const {
+    assert(i >= 0 && static_cast<size_t>(i) < _events.size());
+    return _events[i].fd;
+}
+
+uint32_t UringPoller::GetEvents(const int i) const {
+    assert(i >= 0 && static_cast<size_t>(i) < _events.size());
+    return _events[i].events;
+}
+
+int UringPoller::GetAccepted(const int i) const {
+    assert(i >= 0 && static_cast<size_t>(i) < _events.size());
+    return _events[i].accepted;
+}
+
+std::string_view UringPoller::GetData(const int i) const {
+    assert(i >= 0 && static_cast<size_t>(i) < _events.size());
+    return {_events[i].data, _events[i].len};
+}
+
+const char *UringPoller::Name() const {
+    if (CompletionIo()) {
+        return _sqpoll ? "io_uring (completion, sqpoll)"
+                       : "io_uring (completion)";
+    }
+    return _sqpoll ? "io_uring (sqpoll)" : "io_uring";
+}
+
+} // namespace zener
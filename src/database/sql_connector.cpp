@@ -1,5 +1,6 @@
 #include "database/sql_connector.h"
 #include "utils/log/logger.h"
+#include "utils/metrics/metrics.h"
 
 #include <cassert>
 
@@ -39,12 +40,11 @@ void SqlConnector::Init(const char* host, const unsigned int port,
 MYSQL* SqlConnector::GetConn() {
     MYSQL* sql = nullptr;
     {
+        metrics::ScopedTimer waitTimer(metrics::Server().sqlWait);
         std::unique_lock locker(_mtx);
-        // 如果没连接 MYSQL，会触发 busy ，信号退出：
-        // Process finished with exit code 139 (interrupted by signal 11:SIGSEGV)
+        // 池空时等待归还，原实现判断写反了，会在空队列上 front()
         if (_connQue.empty()) {
             LOG_W("󱘿 SQL connect pool busy!");
-        } else {
             _condition.wait(locker,
                             [this]() { return !this->_connQue.empty(); });
         }
@@ -74,6 +74,38 @@ void SqlConnector::Close() {
     }
 }
 
+QueryResult SqlConnector::Query(const std::string& sql) {
+    QueryResult result;
+    MYSQL* conn = GetConn();
+    if (mysql_query(conn, sql.c_str())) {
+        result.error = mysql_error(conn);
+        FreeConn(conn);
+        return result;
+    }
+    if (MYSQL_RES* res = mysql_store_result(conn)) {
+        const unsigned n = mysql_num_fields(res);
+        const MYSQL_FIELD* fields = mysql_fetch_fields(res);
+        for (unsigned i = 0; i < n; ++i) {
+            result.fields.emplace_back(fields[i].name);
+        }
+        while (MYSQL_ROW row = mysql_fetch_row(res)) {
+            auto& out = result.rows.emplace_back();
+            out.reserve(n);
+            for (unsigned i = 0; i < n; ++i) {
+                out.emplace_back(row[i] ? row[i] : "");
+            }
+        }
+        mysql_free_result(res);
+        result.ok = true;
+    } else {
+        // 没有结果集：INSERT/UPDATE 等语句成功，或取结果失败
+        result.error = mysql_error(conn);
+        result.ok = result.error.empty();
+    }
+    FreeConn(conn);
+    return result;
+}
+
 size_t SqlConnector::GetFreeConnCount() const {
     std::lock_guard locker(_mtx);
     return _connQue.size();
@@ -0,0 +1,165 @@
+#include "http/async.h"
+#include "utils/log/logger.h"
+
+#include <exception>
+#include <memory>
+
+namespace zener::http {
+
+AsyncCall::Hooks AsyncCall::hooks;
+
+void AsyncCall::Start(const AsyncHandlerFunc &handler) {
+    try {
+        _task = handler(_ctx);
+    } catch (const std::exception &e) {
+        LOG_E("{}: async handler failed, {}", _ctx.Path(), e.what());
+        _failed = true;
+    }
+    if (_task.Done()) { // 抛出了异常，或者返回了空任务
+        std::lock_guard lk(_mtx);
+        _state = State::DONE;
+        return;
+    }
+    _task.GetHandle().promise().driver = this;
+    run(_task.GetHandle());
+}
+
+bool AsyncCall::Ready() const {
+    std::lock_guard lk(_mtx);
+    return _state == State::READY;
+}
+
+bool AsyncCall::Done() const {
+    std::lock_guard lk(_mtx);
+    return _state == State::DONE;
+}
+
+void AsyncCall::Resume() {
+    std::coroutine_handle<> handle;
+    {
+        std::lock_guard lk(_mtx);
+        if (_state != State::READY) {
+            return;
+        }
+        _state = State::RUNNING;
+        handle = std::exchange(_suspended, {});
+    }
+    run(handle);
+}
+
+void AsyncCall::run(const std::coroutine_handle<> handle) {
+    handle.resume(); // 嵌套的子任务通过对称转移在这里一路执行下去
+    if (!_task.Done()) {
+        return; // 挂起了（操作可能已经完成，状态为 READY）
+    }
+    if (const auto &error = _task.GetHandle().promise().error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception &e) {
+            LOG_E("{}: async handler failed, {}", _ctx.Path(), e.what());
+        } catch (...) {
+            LOG_E("{}: async handler failed.", _ctx.Path());
+        }
+        _failed = true;
+    }
+    std::lock_guard lk(_mtx);
+    _state = State::DONE;
+}
+
+void AsyncCall::Detach() {
+    bool destroy = false;
+    {
+        std::lock_guard lk(_mtx);
+        _detached = true;
+        // 挂起中的帧由完成的操作销毁，这里只处理已经不会再有人碰的
+        destroy = _state == State::READY || _state == State::DONE;
+        if (destroy) {
+            _state = State::DONE;
+        }
+    }
+    if (destroy) {
+        _task = Task<void>{};
+    }
+}
+
+void AsyncCall::Suspended(const std::coroutine_handle<> handle) {
+    std::lock_guard lk(_mtx);
+    _suspended = handle;
+    _state = State::SUSPENDED;
+}
+
+void AsyncCall::Complete() {
+    bool detached = false;
+    {
+        std::lock_guard lk(_mtx);
+        if (_state != State::SUSPENDED) {
+            return;
+        }
+        detached = _detached;
+        _state = detached ? State::DONE : State::READY;
+    }
+    if (detached) { // 连接已关闭，没有人会再恢复它
+        _task = Task<void>{};
+        return;
+    }
+    if (hooks.wake) {
+        hooks.wake(_fd, _connId);
+    }
+}
+
+void Sleep::start(coro::Driver *driver,
+                  const std::coroutine_handle<> handle) const {
+    driver->Suspended(handle);
+    auto self = driver->shared_from_this();
+    const auto &hooks = AsyncCall::GetHooks();
+    if (!hooks.after) {
+        self->Complete();
+        return;
+    }
+    hooks.after(_ms, [self] { self->Complete(); });
+}
+
+void Query::start(coro::Driver *driver, const std::coroutine_handle<> handle) {
+    driver->Suspended(handle);
+    auto self = driver->shared_from_this();
+    // 结果写进本对象（在协程帧里）之后才 Complete，之后不再访问 this
+    auto run = [this, self] {
+        _result = db::SqlConnector::GetInstance().Query(_sql);
+        self->Complete();
+    };
+    auto shed = [this, self] {
+        _result.error = "blocking lane overloaded";
+        self->Complete();
+    };
+    const auto &hooks = AsyncCall::GetHooks();
+    if (!hooks.offload || !hooks.offload(std::move(run), std::move(shed))) {
+        _result.error = "blocking lane full";
+        self->Complete();
+    }
+}
+
+namespace {
+
+// 回调被调用、被替换或随流一起释放时都会析构，保证协程总能被恢复
+struct CompleteOnRelease {
+    std::shared_ptr<coro::Driver> driver;
+    ~CompleteOnRelease() {
+        if (driver) {
+            driver->Complete();
+        }
+    }
+};
+
+} // namespace
+
+void Drained::start(coro::Driver *driver,
+                    const std::coroutine_handle<> handle) const {
+    driver->Suspended(handle);
+    auto guard =
+        std::make_shared<CompleteOnRelease>(driver->shared_from_this());
+    _stream.OnWritable([guard = std::move(guard)](ResponseStream &stream) {
+        stream.OnWritable(nullptr); // 只等一次，旧回调释放时恢复协程
+    });
+}
+
+} // namespace zener::http
@@ -1,14 +1,25 @@
 #include "http/conn.h"
+#include "http/async.h"
 #include "http/context.h"
+#include "http/h2_session.h"
+#include "http/response_cache.h"
+#include "http/response_stream.h"
 #include "http/router.h"
+#include "http/websocket.h"
+#include "utils/log/access_log.h"
 #include "utils/log/logger.h"
+#include "utils/metrics/metrics.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cerrno>
 #include <cstddef>
+#include <cstdio>
 #include <fcntl.h>
+#include <string_view>
 #include <netinet/in.h>
+#include <strings.h> // strcasecmp
 #include <sys/uio.h>
 #include <unistd.h>
 
@@ -16,8 +27,20 @@ namespace zener::http {
 
 const char *Conn::staticDir;
 std::atomic<int> Conn::userCount;
+std::atomic<bool> Conn::draining{false};
+std::atomic<bool> Conn::shedding{false};
 bool Conn::isET;
 const Router* Conn::router{nullptr};
+bool Conn::enableH2c{true};
+int Conn::headerTimeoutMS{10000};
+int Conn::minBodyRate{1024};
+int Conn::minWriteRate{1024};
+int Conn::rateGraceMS{10000};
+std::function<int(int)> Conn::admit;
+std::function<ssize_t(int, const iovec *, int)> Conn::sender;
+std::function<bool(Conn::Lane, int, uint64_t, std::function<void()>,
+                   std::function<void()>)>
+    Conn::offload;
 
 Conn::Conn()
     : _fd(-1), _addr({}), _connId(0), _isClose(true), _iovCnt(0), _iov{} {
@@ -40,10 +63,19 @@ Conn::~Conn() {
 
 Conn::Conn(Conn &&other) noexcept
     : _fd(other._fd), _addr(other._addr), _connId(other._connId),
+      _node(other._node), _limiterSlot(std::exchange(other._limiterSlot, -1)),
       _readBuff(std::move(other._readBuff)),
       _writeBuff(std::move(other._writeBuff)),
-      _request(std::move(other._request)),
-      _response(std::move(other._response)) {
+      _inbox(std::move(other._inbox)), _inboxClosed(other._inboxClosed),
+      _recvPaused(other._recvPaused), _request(std::move(other._request)),
+      _response(std::move(other._response)), _h2(std::move(other._h2)),
+      _ws(std::move(other._ws)),
+      _outbox(other._outbox.exchange(nullptr, std::memory_order_acq_rel)),
+      _stream(std::move(other._stream)), _async(std::move(other._async)),
+      _flight(std::move(other._flight)), _cached(std::move(other._cached)),
+      _deadline(other._deadline.load(std::memory_order_relaxed)),
+      _phase(other._phase), _phaseStart(other._phaseStart),
+      _phaseBytes(other._phaseBytes) {
 
     LOG_W("Move Conn. id: {}", _connId);
     // 实际上此处只在尝试做 Shutdown 的时候才对 Conn 进行
@@ -72,10 +104,28 @@ Conn &Conn::operator=(Conn &&other) noexcept {
         _fd = other._fd;
         _addr = other._addr;
         _connId = other._connId;
+        _node = other._node;
+        _limiterSlot = std::exchange(other._limiterSlot, -1);
         _readBuff = std::move(other._readBuff);
         _writeBuff = std::move(other._writeBuff);
+        _inbox = std::move(other._inbox);
+        _inboxClosed = other._inboxClosed;
+        _recvPaused = other._recvPaused;
         _request = std::move(other._request);
         _response = std::move(other._response);
+        _h2 = std::move(other._h2);
+        _ws = std::move(other._ws);
+        _outbox.store(other._outbox.exchange(nullptr, std::memory_order_acq_rel),
+                      std::memory_order_release);
+        _stream = std::move(other._stream);
+        _async = std::move(other._async);
+        _flight = std::move(other._flight);
+        _cached = std::move(other._cached);
+        _deadline.store(other._deadline.exchange(0, std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+        _phase = std::exchange(other._phase, PHASE_NONE);
+        _phaseStart = other._phaseStart;
+        _phaseBytes = other._phaseBytes;
         // 置空原对象
         other._fd = -1;
         other._connId = 0;
@@ -89,14 +139,66 @@ void Conn::Init(const int sockFd, const sockaddr_in &addr) {
     userCount.fetch_add(1, std::memory_order_acquire);
     _addr = addr;
     _fd = sockFd;
+    _node = -1; // 由 Server 按 SO_INCOMING_CPU 设置
+    _limiterSlot = -1;
+    _ioState.store(0, std::memory_order_relaxed);
+    _readDeferred = false;
+    _served = 0;
+    _h2.reset();
+    _outbox.store(nullptr, std::memory_order_release);
+    _ws.reset();
+    _stream.reset();
+    _async.reset();
+    _flight.reset();
+    _cached.reset();
+    _deadline.store(0, std::memory_order_relaxed);
+    _phase = PHASE_NONE;
+    _phaseBytes = 0;
     // connID由Server设置，此时为0（非法值）
     _writeBuff.RetrieveAll();
     _readBuff.RetrieveAll();
+    {
+        std::lock_guard lk(_inboxMtx);
+        _inbox.RetrieveAll();
+        _inboxClosed = false;
+        _recvPaused = false;
+    }
     _isClose = false;
     LOG_I(" (fd:{})[{}:{}] in, users count: {}.", _fd, GetIP(), GetPort(),
           static_cast<int>(userCount));
 }
 
+bool Conn::Notify(uint32_t ready) {
+    uint32_t cur = _ioState.load(std::memory_order_acquire);
+    uint32_t bits;
+    do {
+        bits = (cur & IO_WANT_WRITE) ? ready : ready & ~IO_WRITE;
+        if (bits == 0) {
+            return false;
+        }
+    } while (!_ioState.compare_exchange_weak(cur, cur | bits | IO_OWNED,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire));
+    return !(cur & IO_OWNED);
+}
+
+uint32_t Conn::TakeReady() {
+    constexpr uint32_t mask = IO_READ | IO_WRITE | IO_HUP;
+    return _ioState.fetch_and(~mask, std::memory_order_acq_rel) & mask;
+}
+
+bool Conn::Release() {
+    uint32_t cur = _ioState.load(std::memory_order_acquire);
+    do {
+        if (cur & (IO_READ | IO_WRITE | IO_HUP)) {
+            return false;
+        }
+    } while (!_ioState.compare_exchange_weak(cur, cur & ~IO_OWNED,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire));
+    return true;
+}
+
 /*
     并不负责调用 Epoller 的 DelFd (_epoller 是 Server 的成员变量)
     也不负责从 _users 里删除 fd
@@ -105,6 +207,19 @@ void Conn::Close() {
     // TODO 此处 debug 下会触发断言
     assert(_fd > 0);
     _response.UnmapFile();
+    _h2.reset();
+    _outbox.store(nullptr, std::memory_order_release);
+    _ws.reset();
+    if (_async) { // 挂起中的协程由等待的操作完成时销毁
+        _async->Detach();
+        _async.reset();
+    }
+    if (_stream) { // 生产者之后的写入直接失败
+        _stream->Detach();
+        _stream.reset();
+    }
+    _flight.reset(); // 填充完成时的唤醒按 connId 丢弃
+    _cached.reset();
     if (!_isClose) {
         _isClose = true;
         // 如果在closeConn里调用Close(即真正正确的实现):
@@ -123,6 +238,9 @@ void Conn::Close() {
 }
 
 ssize_t Conn::Read(int *saveErrno) {
+    if (sender) {
+        return readInbox(saveErrno);
+    }
     ssize_t len = -1;
     ssize_t totalLen = 0;
     constexpr int maxIterations =
@@ -155,9 +273,58 @@ ssize_t Conn::Read(int *saveErrno) {
     } while (isET &&
              (iterations <
               maxIterations)); // ET模式需要循环读取，但添加最大迭代次数限制
+    if (totalLen > 0) {
+        metrics::Server().bytesIn.Inc(totalLen);
+    }
     return totalLen > 0 ? totalLen : len;
 }
 
+bool Conn::Deliver(const std::string_view data, const bool closed) {
+    std::lock_guard lk(_inboxMtx);
+    if (!data.empty()) {
+        _inbox.Append(data.data(), data.size());
+    }
+    _inboxClosed = _inboxClosed || closed;
+    if (_recvPaused || _inboxClosed || _inbox.ReadableBytes() < INBOX_MAX) {
+        return false;
+    }
+    _recvPaused = true;
+    return true;
+}
+
+bool Conn::RecvPaused() {
+    std::lock_guard lk(_inboxMtx);
+    return _recvPaused;
+}
+
+bool Conn::ResumeRecv() {
+    std::lock_guard lk(_inboxMtx);
+    if (!_recvPaused || _inbox.ReadableBytes() >= INBOX_MAX) {
+        return false;
+    }
+    _recvPaused = false;
+    return true;
+}
+
+ssize_t Conn::readInbox(int *saveErrno) {
+    std::lock_guard lk(_inboxMtx);
+    const size_t len = _inbox.ReadableBytes();
+    if (len == 0) {
+        if (_inboxClosed) {
+            *saveErrno = ECONNRESET; // 连接关闭
+            return 0;
+        }
+        *saveErrno = EAGAIN;
+        return -1;
+    }
+    _readBuff.Append(_inbox);
+    _inbox.RetrieveAll();
+    metrics::Server().bytesIn.Inc(len);
+    // 收件箱已取空；对端已关闭时不报 EAGAIN，让调用方再读一次拿到 0
+    *saveErrno = _inboxClosed ? 0 : EAGAIN;
+    return static_cast<ssize_t>(len);
+}
+
 ssize_t Conn::Write(int *saveErrno) {
 
     ssize_t ret = 0;
@@ -168,7 +335,7 @@ ssize_t Conn::Write(int *saveErrno) {
     // 最多循环写两次
     constexpr int MAX_ATTEMPTS = 2;
     for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
-        ret = writev(_fd, _iov, _iovCnt);
+        ret = sender ? sender(_fd, _iov, _iovCnt) : writev(_fd, _iov, _iovCnt);
         if (ret < 0) {
             /*
              *非阻塞写
@@ -178,7 +345,7 @@ ssize_t Conn::Write(int *saveErrno) {
              */
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 *saveErrno = errno;
-                return totalWritten;
+                break;
             }
             // 其他错误则直接返回
             // 可以优化成 std::tuple 或者 std::pair
@@ -188,6 +355,7 @@ ssize_t Conn::Write(int *saveErrno) {
             return -1;
         }
         totalWritten += ret; // 累计已写入的数据量
+        metrics::Server().bytesOut.Inc(ret);
         // 更新iov结构以反映已写入的数据
         if (static_cast<size_t>(ret) > _iov[0].iov_len) {
             // 头部数据全部发送完毕，开始发送文件数据
@@ -208,6 +376,8 @@ ssize_t Conn::Write(int *saveErrno) {
         }
         // 如果没有数据需要发送了，退出循环
         if (_iov[0].iov_len + _iov[1].iov_len == 0) {
+            recordAccess();
+            ++_served;
             break;
         }
         // 在非ET模式下，或者当写入超过一定大小时，暂停写入，等待下次EPOLLOUT事件
@@ -217,90 +387,585 @@ ssize_t Conn::Write(int *saveErrno) {
             break;
         }
     }
+    // 不读响应的客户端会一直占着写缓冲区和文件映射：按写出速度设截止时间
+    if (ToWriteBytes() == 0) {
+        if (_phase == PHASE_WRITE) {
+            enterPhase(PHASE_NONE);
+            setDeadline(0);
+        }
+    } else if (minWriteRate > 0 && (totalWritten > 0 || _phase != PHASE_WRITE)) {
+        enterPhase(PHASE_WRITE);
+        _phaseBytes += static_cast<size_t>(totalWritten);
+        // 内核发送缓冲区一次就能吸收几 MB，按速度算的截止时间会被推得很远，
+        // 所以同时要求每 rateGraceMS 内至少有一次进展
+        setDeadline(std::min(
+            _phaseStart + rateGraceMS +
+                static_cast<int64_t>(_phaseBytes * 1000 / minWriteRate),
+            NowMs() + rateGraceMS));
+    }
     return totalWritten;
 }
 
+bool Conn::IsKeepAlive() const {
+    if (_h2) {
+        return !_h2->Closing();
+    }
+    if (_ws) {
+        return !_ws->Closing();
+    }
+    if (InFlight()) {
+        return true; // 处理函数结束后才按请求本身决定
+    }
+    return _request.IsKeepAlive() && !draining.load(std::memory_order_relaxed) &&
+           !shedding.load(std::memory_order_relaxed);
+}
+
 Conn::ProcessResult Conn::Process() {
+    // HTTP/2 可能只剩待发的 DATA（窗口或单批上限），读缓冲区为空也要继续
+    if (_h2) {
+        return processH2();
+    }
+    if (_ws) {
+        return processWs(); // 可能只有其他线程投递的帧
+    }
+    if (_async) {
+        return processAsync(); // 结束前不处理流水线上的下一个请求
+    }
+    if (_flight) {
+        return processCacheWait();
+    }
+    if (_stream) {
+        return processStream();
+    }
     // 1. 如果读缓冲区为空，不进行后续处理
     if (_readBuff.ReadableBytes() <= 0) {
         LOG_D("fd={}: buffer is empty.", _fd);
         return ProcessResult::NEED_MORE_DATA;
     }
+    // 连接以 HTTP/2 前言开头：prior knowledge
+    if (enableH2c && _served == 0) {
+        switch (H2Session::CheckPreface(_readBuff)) {
+        case H2Session::Preface::PARTIAL:
+            return ProcessResult::NEED_MORE_DATA;
+        case H2Session::Preface::MATCH:
+            _h2 = std::make_unique<H2Session>(_fd, _connId, _limiterSlot);
+            _h2->Start(_writeBuff);
+            return processH2();
+        case H2Session::Preface::MISMATCH:
+            break;
+        }
+    }
+    const Request::Framing framing = frame();
+    if (framing == Request::Framing::PARTIAL_HEAD ||
+        framing == Request::Framing::PARTIAL_BODY) {
+        return ProcessResult::NEED_MORE_DATA;
+    }
+    if (!AccessLog::GetInstance().Enabled()) {
+        return framing == Request::Framing::COMPLETE ? process()
+                                                     : rejectTooLarge(framing);
+    }
+    _reqStart = std::chrono::steady_clock::now();
+    const auto result = framing == Request::Framing::COMPLETE
+                            ? process()
+                            : rejectTooLarge(framing);
+    if (result == ProcessResult::OK && !_h2) {
+        noteResponse();
+    }
+    return result;
+}
+
+Conn::Lane Conn::PickLane() const {
+    // HTTP/2 的帧在当前工作线程里解析，流由 H2Session 按 LaneOf 分派；
+    // WebSocket 消息在当前工作线程里处理
+    if (!router || _h2 || _ws || InFlight()) {
+        return Lane::IO;
+    }
+    const std::string_view data(_readBuff.Peek(), _readBuff.ReadableBytes());
+    const size_t lineEnd = data.find("\r\n");
+    if (lineEnd == std::string_view::npos) {
+        return Lane::IO; // 请求行还没收全，交给 Process 等待更多数据
+    }
+    const std::string_view line = data.substr(0, lineEnd);
+    const size_t sp1 = line.find(' ');
+    if (sp1 == std::string_view::npos) {
+        return Lane::IO;
+    }
+    const size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos) {
+        return Lane::IO;
+    }
+    return LaneOf(std::string(line.substr(0, sp1)),
+                  Request::CanonicalPath(
+                      std::string(line.substr(sp1 + 1, sp2 - sp1 - 1))));
+}
+
+Conn::Lane Conn::LaneOf(const std::string &method, const std::string &path) {
+    if (!router) {
+        return Lane::IO;
+    }
+    if (router->IsBlocking(method, path)) {
+        return Lane::BLOCKING;
+    }
+    return router->HasHandler(method, path) ? Lane::NORMAL : Lane::IO;
+}
+
+void Conn::RejectBusy(const int code) {
+    _readBuff.RetrieveAll();
+    _writeBuff.RetrieveAll();
+    _response.UnmapFile();
+    _cached.reset();
+    _writeBuff.Append(code == 429 ? "HTTP/1.1 429 Too Many Requests\r\n"
+                                  : "HTTP/1.1 503 Service Unavailable\r\n");
+    _writeBuff.Append("Connection: close\r\nRetry-After: 1\r\n"
+                      "Content-length: 0\r\n\r\n");
+    setIov();
+    _status = 0;
+}
+
+int64_t Conn::NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Conn::enterPhase(const uint8_t phase) {
+    if (_phase != phase) {
+        _phase = phase;
+        _phaseStart = NowMs();
+        _phaseBytes = 0;
+    }
+}
+
+Request::Framing Conn::frame() {
+    // 请求之间多余的空行忽略（RFC 9112 2.2），如 POST 正文之后客户端多发的 CRLF
+    while (_readBuff.ReadableBytes() >= 2 && _readBuff.Peek()[0] == '\r' &&
+           _readBuff.Peek()[1] == '\n') {
+        _readBuff.Retrieve(2);
+    }
+    if (_readBuff.ReadableBytes() == 0) {
+        enterPhase(PHASE_NONE);
+        setDeadline(0);
+        return Request::Framing::PARTIAL_HEAD;
+    }
+    size_t bodyBytes = 0;
+    const auto framing =
+        Request::Frame(_readBuff.Peek(), _readBuff.ReadableBytes(), bodyBytes);
+    switch (framing) {
+    case Request::Framing::PARTIAL_HEAD:
+        // 截止时间从收到第一个字节算起，之后到来的数据不会推迟它
+        enterPhase(PHASE_HEAD);
+        setDeadline(headerTimeoutMS > 0 ? _phaseStart + headerTimeoutMS : 0);
+        break;
+    case Request::Framing::PARTIAL_BODY:
+        // 每收到 minBodyRate 字节，截止时间推迟一秒
+        enterPhase(PHASE_BODY);
+        setDeadline(minBodyRate > 0
+                        ? _phaseStart + rateGraceMS +
+                              static_cast<int64_t>(bodyBytes * 1000 /
+                                                   minBodyRate)
+                        : 0);
+        break;
+    default:
+        enterPhase(PHASE_NONE);
+        setDeadline(0);
+        break;
+    }
+    return framing;
+}
+
+Conn::ProcessResult Conn::rejectTooLarge(const Request::Framing framing) {
+    LOG_W("fd={}: request {} too large.", _fd,
+          framing == Request::Framing::HEAD_TOO_LARGE ? "header" : "body");
+    metrics::Server().requests.Inc();
+    _request.Init(); // 没有 Connection: keep-alive，写完即关闭
+    _readBuff.RetrieveAll();
+    _response.UnmapFile();
+    _cached.reset();
+    _writeBuff.Append(framing == Request::Framing::HEAD_TOO_LARGE
+                          ? "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+                          : "HTTP/1.1 413 Content Too Large\r\n");
+    _writeBuff.Append("Connection: close\r\nContent-length: 0\r\n\r\n");
+    setIov();
+    return ProcessResult::OK;
+}
+
+void Conn::setIov() {
+    _iov[0].iov_base = _writeBuff.Peek();
+    _iov[0].iov_len = _writeBuff.ReadableBytes();
+    _iov[1].iov_base = nullptr;
+    _iov[1].iov_len = 0;
+    _iovCnt = 1;
+    if (_cached) {
+        _iov[1].iov_base = const_cast<char *>(_cached->data.data());
+        _iov[1].iov_len = _cached->data.size();
+        _iovCnt = 2;
+    } else if (_response.File() && _response.FileLen() > 0) {
+        _iov[1].iov_base = _response.File();
+        _iov[1].iov_len = _response.FileLen();
+        _iovCnt = 2;
+    }
+}
+
+void Conn::noteResponse() {
+    if (!AccessLog::GetInstance().Enabled()) {
+        return;
+    }
+    // 所有分支都以 "HTTP/1.1 xxx" 开头写入 _writeBuff，缓存命中时整个响应在 _iov[1]
+    const iovec &head = _iov[0].iov_len > 0 ? _iov[0] : _iov[1];
+    const char *line = static_cast<const char *>(head.iov_base);
+    _status = head.iov_len >= 12 ? (line[9] - '0') * 100 +
+                                       (line[10] - '0') * 10 + (line[11] - '0')
+                                 : 0;
+    _respBytes = ToWriteBytes();
+}
+
+void Conn::recordAccess() {
+    if (_status == 0 || _stream) {
+        return; // 流式响应等结束块写完再记，字节数由 takeChunk 累加
+    }
+    AccessLog::GetInstance().Record(_connId, _request.Method(),
+                                    _request.Path(), _status, _respBytes,
+                                    _reqStart);
+    _status = 0;
+}
+
+Conn::ProcessResult Conn::process() {
     _request.Init();
+    auto &stats = metrics::Server();
+    stats.requests.Inc();
     // 2. 解析HTTP请求
-    const bool parseSuccess = _request.parse(_readBuff);
+    bool parseSuccess = false;
+    {
+        metrics::ScopedTimer timer(stats.parseTime);
+        parseSuccess = _request.parse(_readBuff);
+    }
     _response.UnmapFile();
+    _cached.reset();
 
     if (!parseSuccess) {
         LOG_W("fd={}: parse failed, request Path:{}", _fd, _request.Path().c_str());
         _writeBuff.Append("HTTP/1.1 400 Bad Request\r\nContent-length: 0\r\n\r\n");
         if (_writeBuff.ReadableBytes() == 0) return ProcessResult::ERROR;
-        _iovCnt = 1;
-        _iov[0].iov_base = _writeBuff.Peek();
-        _iov[0].iov_len  = _writeBuff.ReadableBytes();
+        setIov();
         return ProcessResult::OK;
     }
 
-    // 3. 路由分发
-    if (router) {
-        Context ctx(_request, _response, _writeBuff);
-        const auto result = router->Dispatch(ctx);
+    // WebSocket 握手
+    if (router && strcasecmp(_request.GetHeader("Upgrade").c_str(),
+                             "websocket") == 0) {
+        if (const ws::Handlers *handlers =
+                router->FindWebSocket(_request.Path())) {
+            return upgradeWebSocket(*handlers);
+        }
+    }
 
-        if (result.kind == DispatchResult::Kind::Handler) {
-            if (_writeBuff.ReadableBytes() == 0) {
-                LOG_W("fd={}: route handler produced empty response.", _fd);
-                return ProcessResult::ERROR;
-            }
-            _iovCnt = 1;
-            _iov[0].iov_base = _writeBuff.Peek();
-            _iov[0].iov_len  = _writeBuff.ReadableBytes();
+    // HTTP/1.1 升级到 h2c：回 101 后本请求作为流 1 响应
+    if (enableH2c && _request.GetHeader("Upgrade") == "h2c") {
+        auto session =
+            std::make_unique<H2Session>(_fd, _connId, _limiterSlot);
+        if (session->Upgrade(_request.GetHeader("HTTP2-Settings"), _request,
+                             _writeBuff)) {
+            _h2 = std::move(session);
+            setIov();
             return ProcessResult::OK;
         }
+    }
 
-        if (result.kind == DispatchResult::Kind::StaticFile) {
-            _response.Init(result.fsRoot, result.relativePath,
-                           _request.IsKeepAlive(), 200);
-        } else {
-            // None: no route and no static mount matched → plain 404
-            _writeBuff.Append("HTTP/1.1 404 Not Found\r\nContent-length: 0\r\n\r\n");
-            _iovCnt = 1;
-            _iov[0].iov_base = _writeBuff.Peek();
-            _iov[0].iov_len  = _writeBuff.ReadableBytes();
-            return ProcessResult::OK;
+    if (router) {
+        if (const AsyncHandlerFunc *handler =
+                router->FindAsync(_request.Method(), _request.Path())) {
+            return startAsync(*handler);
+        }
+        if (const CachePolicy *policy =
+                router->FindCache(_request.Method(), _request.Path())) {
+            return renderCached(*policy);
         }
-    } else {
-        // no router at all — should not happen in normal operation
-        LOG_W("fd={}: no router configured.", _fd);
-        _writeBuff.Append("HTTP/1.1 500 Internal Server Error\r\nContent-length: 0\r\n\r\n");
-        _iovCnt = 1;
-        _iov[0].iov_base = _writeBuff.Peek();
-        _iov[0].iov_len  = _writeBuff.ReadableBytes();
-        return ProcessResult::OK;
     }
 
-    // 4. 生成HTTP响应
-    try {
-        _response.MakeResponse(_writeBuff);
-    } catch (const std::exception &e) {
-        LOG_E("fd={}: make response failed, {}", _fd, e.what());
+    // 3. 路由分发并生成 HTTP 响应
+    if (!Render(_request, _response, _writeBuff, IsKeepAlive())) {
         return ProcessResult::ERROR;
     }
+    adoptStream();
+    if (_stream) {
+        takeChunk(); // 处理函数里已经写入的部分
+    }
+    setIov();
+    LOG_D("filesize:{}, {} to {}.", _response.FileLen(), _iovCnt, ToWriteBytes());
+    return ProcessResult::OK;
+}
+
+Conn::ProcessResult Conn::processH2() {
+    _h2->Feed(_readBuff, _writeBuff);
+    // 与 HTTP/1.1 的 Connection: close 对应：在途的流完成后关闭，客户端重新排队连接
+    if (draining.load(std::memory_order_relaxed) ||
+        shedding.load(std::memory_order_relaxed)) {
+        _h2->GoAway(_writeBuff);
+    }
+    _status = 0; // 访问日志由各个流自己记录
+    if (_writeBuff.ReadableBytes() == 0) {
+        return _h2->Closing() ? ProcessResult::ERROR
+                              : ProcessResult::NEED_MORE_DATA;
+    }
+    setIov();
+    return ProcessResult::OK;
+}
+
+Conn::ProcessResult Conn::upgradeWebSocket(const ws::Handlers &handlers) {
+    const std::string key = _request.GetHeader("Sec-WebSocket-Key");
+    if (_request.Method() != "GET" || key.empty() ||
+        _request.GetHeader("Sec-WebSocket-Version") != "13") {
+        LOG_W("fd={}: bad WebSocket handshake on {}.", _fd, _request.Path());
+        _writeBuff.Append("HTTP/1.1 400 Bad Request\r\nSec-WebSocket-Version: 13\r\n"
+                          "Connection: close\r\nContent-length: 0\r\n\r\n");
+        setIov();
+        return ProcessResult::OK;
+    }
+    _writeBuff.Append("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                      "Connection: Upgrade\r\nSec-WebSocket-Accept: " +
+                      ws::AcceptKey(key) + "\r\n\r\n");
+    auto outbox = std::make_shared<ws::Outbox>(_fd, _connId);
+    _outbox.store(outbox.get(), std::memory_order_release);
+    _ws = std::make_unique<ws::Session>(handlers, _request.Path(), _limiterSlot,
+                                        std::move(outbox), _writeBuff);
+    _ws->Open();
+    setIov();
+    return ProcessResult::OK;
+}
+
+Conn::ProcessResult Conn::processWs() {
+    const bool open = _ws->Feed(_readBuff);
+    _status = 0;
+    if (_writeBuff.ReadableBytes() == 0) {
+        return open ? ProcessResult::NEED_MORE_DATA : ProcessResult::ERROR;
+    }
+    setIov();
+    return ProcessResult::OK;
+}
 
+Conn::ProcessResult Conn::processStream() {
+    takeChunk();
     if (_writeBuff.ReadableBytes() == 0) {
-        LOG_W("fd={}: buffer is empty.", _fd);
+        return ProcessResult::NEED_MORE_DATA; // 等生产者 Flush 唤醒
+    }
+    setIov();
+    return ProcessResult::OK;
+}
+
+Conn::ProcessResult Conn::startAsync(const AsyncHandlerFunc &handler) {
+    _response.Init("", _request.Path(), IsKeepAlive(), 200);
+    _async = std::make_shared<AsyncCall>(_request, _response, _writeBuff, _fd,
+                                         _connId);
+    {
+        metrics::ScopedTimer timer(metrics::Server().handlerTime);
+        _async->Start(handler);
+    }
+    return processAsync();
+}
+
+Conn::ProcessResult Conn::processAsync() {
+    // 流已经接上时状态行早就写出了，之后的输出只有 chunk
+    const bool headWritten = _stream != nullptr;
+    // 等待 Drained 时，取走数据的同时就可能让协程就绪，接着恢复它
+    do {
+        _async->Resume();
+        adoptStream();
+        if (_stream) {
+            takeChunk();
+        }
+    } while (_async->Ready() && _writeBuff.ReadableBytes() == 0);
+    if (_async->Done()) {
+        const bool failed = _async->Failed();
+        _async.reset();
+        if (_writeBuff.ReadableBytes() == 0 && !_stream) {
+            if (!failed) {
+                LOG_W("{}: async handler produced empty response.",
+                      _request.Path());
+                return ProcessResult::ERROR;
+            }
+            _writeBuff.Append("HTTP/1.1 500 Internal Server Error\r\n"
+                              "Content-length: 0\r\n\r\n");
+        }
+    }
+    if (_writeBuff.ReadableBytes() == 0) {
+        return ProcessResult::NEED_MORE_DATA; // 等操作完成后唤醒
+    }
+    setIov();
+    if (!headWritten) {
+        noteResponse(); // 调用结束或开始流式响应：状态行在写缓冲区开头
+    }
+    return ProcessResult::OK;
+}
+
+Conn::ProcessResult Conn::renderCached(const CachePolicy &policy) {
+    auto &cache = ResponseCache::GetInstance();
+    const bool keepAlive = IsKeepAlive();
+    const std::string key = ResponseCache::Key(_request, policy, keepAlive);
+    std::shared_ptr<const CachedResponse> hit;
+    switch (cache.Find(key, _fd, _connId, hit, _flight)) {
+    case ResponseCache::Lookup::HIT:
+        _cached = std::move(hit);
+        setIov();
+        return ProcessResult::OK;
+    case ResponseCache::Lookup::WAIT:
+        _status = 0;
+        return ProcessResult::NEED_MORE_DATA; // 领头的请求填充完成后唤醒
+    case ResponseCache::Lookup::LEAD:
+        break;
+    }
+    // 处理函数抛出异常也要结束填充，否则等待者和之后的请求会一直挂着
+    struct FillGuard {
+        ResponseCache &cache;
+        const std::string &key;
+        std::shared_ptr<const CachedResponse> response;
+        ~FillGuard() { cache.Fill(key, std::move(response)); }
+    } guard{cache, key, nullptr};
+    if (!Render(_request, _response, _writeBuff, keepAlive)) {
         return ProcessResult::ERROR;
     }
-    _iovCnt = 0;
-    _iov[0].iov_base = _writeBuff.Peek();
-    _iov[0].iov_len  = _writeBuff.ReadableBytes();
-    _iovCnt = 1;
-    if (_response.File() && _response.FileLen() > 0) {
-        _iov[1].iov_base = _response.File();
-        _iov[1].iov_len  = _response.FileLen();
-        _iovCnt = 2;
+    adoptStream();
+    if (_stream) {
+        takeChunk();
+    } else if (_response.IsHandled() && _response.Code() == 200 &&
+               _writeBuff.ReadableBytes() <= policy.maxEntryBytes) {
+        guard.response = std::make_shared<CachedResponse>(CachedResponse{
+            std::string(_writeBuff.Peek(), _writeBuff.ReadableBytes()),
+            std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(policy.ttlMs)});
     }
-    LOG_D("filesize:{}, {} to {}.", _response.FileLen(), _iovCnt, ToWriteBytes());
+    setIov();
     return ProcessResult::OK;
 }
 
+Conn::ProcessResult Conn::processCacheWait() {
+    if (!_flight->done.load(std::memory_order_acquire)) {
+        return ProcessResult::NEED_MORE_DATA;
+    }
+    _cached = std::exchange(_flight, nullptr)->result;
+    if (!_cached) {
+        // 领头的请求没有产生可缓存的响应（非 200、流式或出错），自己执行处理函数
+        if (!Render(_request, _response, _writeBuff, IsKeepAlive())) {
+            return ProcessResult::ERROR;
+        }
+        adoptStream();
+        if (_stream) {
+            takeChunk();
+        }
+    }
+    setIov();
+    noteResponse();
+    return ProcessResult::OK;
+}
+
+void Conn::adoptStream() {
+    auto stream = _response.TakeStream();
+    if (!stream) {
+        return;
+    }
+    if (_request.Method() == "HEAD") {
+        stream->Detach(); // 只要首部
+        return;
+    }
+    stream->Attach(_fd, _connId);
+    _stream = std::move(stream);
+}
+
+void Conn::takeChunk() {
+    std::string data;
+    const bool ended = _stream->Take(data);
+    const size_t before = _writeBuff.ReadableBytes();
+    if (!data.empty()) {
+        char size[24];
+        const int n = snprintf(size, sizeof(size), "%zx\r\n", data.size());
+        _writeBuff.Append(size, n);
+        _writeBuff.Append(data);
+        _writeBuff.Append("\r\n", 2);
+    }
+    if (ended) {
+        _writeBuff.Append("0\r\n\r\n", 5);
+        _stream->Detach();
+        _stream.reset();
+    }
+    if (_status != 0) { // 首部已记下：后续 chunk 计入响应大小
+        _respBytes += _writeBuff.ReadableBytes() - before;
+    }
+}
+
+bool Conn::HasQueued() const {
+    if (_h2) {
+        return _h2->HasDone();
+    }
+    if (_async && _async->Ready()) {
+        return true;
+    }
+    if (_flight) {
+        return _flight->done.load(std::memory_order_acquire);
+    }
+    if (_stream) {
+        return _stream->Ready();
+    }
+    const ws::Outbox *outbox = _outbox.load(std::memory_order_acquire);
+    return outbox && !outbox->Empty();
+}
+
+bool Conn::ProbeIdle() {
+    ws::Outbox *outbox = _outbox.load(std::memory_order_acquire);
+    if (!outbox || !outbox->MarkProbed()) {
+        return false;
+    }
+    static const ws::Frame ping = ws::MakeFrame(ws::PING, {});
+    (void)outbox->Push(ping);
+    return true;
+}
+
+bool Conn::Render(Request &request, Response &response, Buffer &buff,
+                  const bool keepAlive) {
+    if (!router) {
+        // no router at all — should not happen in normal operation
+        LOG_W("No router configured.");
+        buff.Append("HTTP/1.1 500 Internal Server Error\r\nContent-length: 0\r\n\r\n");
+        return true;
+    }
+    // 处理函数默认 200，并沿用本次请求的 keep-alive，而不是上一个请求的状态
+    response.Init("", request.Path(), keepAlive, 200);
+    Context ctx(request, response, buff);
+    DispatchResult result;
+    {
+        metrics::ScopedTimer timer(metrics::Server().handlerTime);
+        result = router->Dispatch(ctx);
+    }
+
+    if (result.kind == DispatchResult::Kind::Handler) {
+        if (buff.ReadableBytes() == 0) {
+            LOG_W("{}: route handler produced empty response.", request.Path());
+            return false;
+        }
+        return true;
+    }
+    if (result.kind == DispatchResult::Kind::Async) {
+        // HTTP/2 的流在 H2Session 里同步处理，没有挂起后恢复的机制
+        LOG_W("{}: async handler is not available over HTTP/2.", request.Path());
+        buff.Append("HTTP/1.1 501 Not Implemented\r\nContent-length: 0\r\n\r\n");
+        return true;
+    }
+    if (result.kind == DispatchResult::Kind::None) {
+        // no route and no static mount matched → plain 404
+        buff.Append("HTTP/1.1 404 Not Found\r\nContent-length: 0\r\n\r\n");
+        return true;
+    }
+
+    response.Init(result.fsRoot, result.relativePath, keepAlive, 200);
+    try {
+        response.MakeResponse(buff);
+    } catch (const std::exception &e) {
+        LOG_E("{}: make response failed, {}", request.Path(), e.what());
+        return false;
+    }
+    if (buff.ReadableBytes() == 0) {
+        LOG_W("{}: buffer is empty.", request.Path());
+        return false;
+    }
+    return true;
+}
+
 } // namespace zener::http
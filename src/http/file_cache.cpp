@@ -1,5 +1,6 @@
 #include "http/file_cache.h"
 #include "utils/log/logger.h"
+#include "utils/metrics/metrics.h"
 
 #include <cerrno>
 #include <cstring>
@@ -29,6 +30,7 @@ CachedFile *FileCache::GetFileMapping(const std::string &filePath,
                 cache->lastModTime == fileStat.st_mtime) {
                 cache->lastAccess = std::chrono::steady_clock::now();
                 ++cache->refCount;
+                metrics::Server().fileCacheHits.Inc();
 
                 LOG_D("File cache hit: {}, current reference count: {}",
                       filePath, cache->refCount.load());
@@ -49,6 +51,7 @@ CachedFile *FileCache::GetFileMapping(const std::string &filePath,
             cache->lastModTime == fileStat.st_mtime) {
             cache->lastAccess = std::chrono::steady_clock::now();
             ++cache->refCount;
+            metrics::Server().fileCacheHits.Inc();
 
             LOG_D("File cache hit (second check): {}, current reference count: "
                   "{}",
@@ -62,6 +65,7 @@ CachedFile *FileCache::GetFileMapping(const std::string &filePath,
     }
 
     // 加载文件并创建新缓存
+    metrics::Server().fileCacheMisses.Inc();
     CachedFile *newCache = LoadFile(filePath, fileStat);
     if (newCache) {
         _fileCache[filePath] = newCache;
@@ -0,0 +1,889 @@
+#include "http/h2_session.h"
+#include "http/conn.h"
+#include "http/response.h"
+#include "http/response_stream.h"
+#include "utils/log/access_log.h"
+#include "utils/log/logger.h"
+#include "utils/metrics/metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+namespace zener::http {
+
+uint32_t H2Session::maxStreams = 128;
+
+namespace {
+
+enum FrameType : uint8_t {
+    DATA = 0x0,
+    HEADERS = 0x1,
+    PRIORITY = 0x2,
+    RST_STREAM = 0x3,
+    SETTINGS = 0x4,
+    PUSH_PROMISE = 0x5,
+    PING = 0x6,
+    GOAWAY = 0x7,
+    WINDOW_UPDATE = 0x8,
+    CONTINUATION = 0x9,
+};
+
+enum FrameFlag : uint8_t {
+    END_STREAM = 0x1,
+    ACK = 0x1,
+    END_HEADERS = 0x4,
+    PADDED = 0x8,
+    PRIORITY_FLAG = 0x20,
+};
+
+enum SettingId : uint16_t {
+    HEADER_TABLE_SIZE = 0x1,
+    ENABLE_PUSH = 0x2,
+    MAX_CONCURRENT_STREAMS = 0x3,
+    INITIAL_WINDOW_SIZE = 0x4,
+    MAX_FRAME_SIZE = 0x5,
+    MAX_HEADER_LIST_SIZE = 0x6,
+};
+
+constexpr size_t FRAME_HEADER_LEN = 9;
+constexpr size_t LOCAL_MAX_FRAME = 16384;   // 不通告，沿用默认值
+constexpr int64_t LOCAL_WINDOW = 1 << 20;   // 连接和流的接收窗口
+constexpr int64_t MAX_WINDOW = 0x7fffffff;
+// 一次 Feed 最多产生的 DATA 字节，写完后由下一次 Process 接着发
+constexpr size_t MAX_FLUSH_BYTES = 1 << 20;
+
+// 请求首部和正文的上限与 HTTP/1.1 相同（Request::maxHeaderBytes/maxHeaders/maxBodyBytes）。
+// 压缩后的首部块先整块缓存再解码；Huffman 最长 30 位一个字符，
+// 解码后不超限的首部块不会超过上限的 4 倍，更大的只能按连接错误处理
+size_t headerBlockLimit() { return Request::maxHeaderBytes * 4; }
+
+uint32_t get32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+void put32(uint8_t *p, const uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+void writeFrame(Buffer &out, const uint8_t type, const uint8_t flags,
+                const uint32_t streamId, const void *payload,
+                const size_t len) {
+    uint8_t header[FRAME_HEADER_LEN];
+    header[0] = static_cast<uint8_t>(len >> 16);
+    header[1] = static_cast<uint8_t>(len >> 8);
+    header[2] = static_cast<uint8_t>(len);
+    header[3] = type;
+    header[4] = flags;
+    put32(header + 5, streamId & 0x7fffffff);
+    out.Append(header, FRAME_HEADER_LEN);
+    if (len > 0) {
+        out.Append(payload, len);
+    }
+}
+
+void writeWindowUpdate(Buffer &out, const uint32_t streamId,
+                       const size_t increment) {
+    uint8_t payload[4];
+    put32(payload, static_cast<uint32_t>(increment));
+    writeFrame(out, WINDOW_UPDATE, 0, streamId, payload, sizeof(payload));
+}
+
+// content-type -> Content-Type，与 HTTP/1.1 解析出的首部名一致
+std::string canonicalName(const std::string &name) {
+    std::string result(name);
+    bool upper = true;
+    for (char &c : result) {
+        if (upper) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        upper = c == '-';
+    }
+    return result;
+}
+
+// HTTP/2 禁止的连接级首部
+bool connectionSpecific(const std::string &name) {
+    return name == "connection" || name == "keep-alive" ||
+           name == "transfer-encoding" || name == "upgrade" ||
+           name == "proxy-connection";
+}
+
+// "u=1, i" 中的 urgency，缺省 3
+uint8_t parseUrgency(const std::string &value) {
+    const size_t pos = value.find("u=");
+    if (pos == std::string::npos || pos + 2 >= value.size() ||
+        value[pos + 2] < '0' || value[pos + 2] > '7') {
+        return 3;
+    }
+    return static_cast<uint8_t>(value[pos + 2] - '0');
+}
+
+// HTTP2-Settings 是不带填充的 base64url
+bool base64UrlDecode(const std::string &in, std::string &out) {
+    uint32_t acc = 0;
+    int bits = 0;
+    out.clear();
+    for (const char c : in) {
+        int v;
+        if (c >= 'A' && c <= 'Z') {
+            v = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            v = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            v = c - '0' + 52;
+        } else if (c == '-') {
+            v = 62;
+        } else if (c == '_') {
+            v = 63;
+        } else if (c == '=') {
+            break;
+        } else {
+            return false;
+        }
+        acc = acc << 6 | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>(acc >> bits & 0xff));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+H2Session::Preface H2Session::CheckPreface(const Buffer &buff) {
+    const size_t n = std::min(buff.ReadableBytes(), PREFACE.size());
+    if (PREFACE.compare(0, n, std::string_view(buff.Peek(), n)) != 0) {
+        return Preface::MISMATCH;
+    }
+    return n == PREFACE.size() ? Preface::MATCH : Preface::PARTIAL;
+}
+
+struct H2Session::Job {
+    Request req;
+    Response response;
+    Buffer head;
+    std::chrono::steady_clock::time_point start; // 访问日志计时，含排队时间
+    bool ok{false};   // Render 成功
+    bool shed{false}; // 排队超过截止时间，处理函数没有执行
+    std::atomic<bool> done{false}; // 以上结果已写好，release/acquire 配对
+};
+
+H2Session::H2Session(const int fd, const uint64_t connId,
+                     const int limiterSlot)
+    : _fd(fd), _connId(connId), _limiterSlot(limiterSlot) {}
+
+void H2Session::Start(Buffer &out) {
+    uint8_t payload[18];
+    payload[0] = 0;
+    payload[1] = MAX_CONCURRENT_STREAMS;
+    put32(payload + 2, maxStreams);
+    payload[6] = 0;
+    payload[7] = INITIAL_WINDOW_SIZE;
+    put32(payload + 8, static_cast<uint32_t>(LOCAL_WINDOW));
+    // 只是提示，超过时仍由 onHeaderBlock 回 431
+    payload[12] = 0;
+    payload[13] = MAX_HEADER_LIST_SIZE;
+    put32(payload + 14, static_cast<uint32_t>(Request::maxHeaderBytes));
+    writeFrame(out, SETTINGS, 0, 0, payload, sizeof(payload));
+    // 连接级接收窗口不受 SETTINGS 影响，单独放大
+    writeWindowUpdate(out, 0, LOCAL_WINDOW - _connRecvWindow);
+    _connRecvWindow = LOCAL_WINDOW;
+}
+
+bool H2Session::Upgrade(const std::string &settings, Request &req,
+                        Buffer &out) {
+    std::string payload;
+    if (!base64UrlDecode(settings, payload) || payload.size() % 6 != 0 ||
+        applySettings(reinterpret_cast<const uint8_t *>(payload.data()),
+                      payload.size()) != NO_ERROR) {
+        return false;
+    }
+    out.Append("HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\n"
+               "Upgrade: h2c\r\n\r\n");
+    Start(out);
+    // 升级前的请求即流 1，对端已半关闭
+    _lastStreamId = 1;
+    Stream &stream = _streams[1];
+    stream.endRemote = true;
+    stream.sendWindow = _peerInitialWindow;
+    stream.recvWindow = LOCAL_WINDOW;
+    respond(1, stream, req, out);
+    flush(out);
+    return true;
+}
+
+void H2Session::Feed(Buffer &in, Buffer &out) {
+    if (!_closed && !_prefaceDone) {
+        switch (CheckPreface(in)) {
+        case Preface::PARTIAL:
+            return;
+        case Preface::MISMATCH:
+            connError(PROTOCOL_ERROR, out);
+            break;
+        case Preface::MATCH:
+            in.Retrieve(PREFACE.size());
+            _prefaceDone = true;
+            break;
+        }
+    }
+    while (!_closed && in.ReadableBytes() >= FRAME_HEADER_LEN) {
+        const auto *p = reinterpret_cast<const uint8_t *>(in.Peek());
+        const size_t len = static_cast<size_t>(p[0]) << 16 |
+                           static_cast<size_t>(p[1]) << 8 | p[2];
+        if (len > LOCAL_MAX_FRAME) {
+            connError(FRAME_SIZE_ERROR, out);
+            break;
+        }
+        if (in.ReadableBytes() < FRAME_HEADER_LEN + len) {
+            break; // 帧还没收全
+        }
+        onFrame(p[3], p[4], get32(p + 5) & 0x7fffffff, p + FRAME_HEADER_LEN,
+                len, out);
+        in.Retrieve(FRAME_HEADER_LEN + len);
+    }
+    if (_closed) {
+        in.RetrieveAll();
+        return;
+    }
+    if (_recvConsumed > 0) {
+        // 请求体已整块缓存，收到多少就归还多少
+        writeWindowUpdate(out, 0, _recvConsumed);
+        _connRecvWindow += static_cast<int64_t>(_recvConsumed);
+        _recvConsumed = 0;
+    }
+    collect(out);
+    flush(out);
+}
+
+bool H2Session::HasDone() const {
+    return std::any_of(_streams.begin(), _streams.end(), [](const auto &entry) {
+        return entry.second.job &&
+               entry.second.job->done.load(std::memory_order_acquire);
+    });
+}
+
+void H2Session::GoAway(Buffer &out, const uint32_t code) {
+    if (_goAwaySent) {
+        return;
+    }
+    _goAwaySent = true;
+    uint8_t payload[8];
+    put32(payload, _lastStreamId);
+    put32(payload + 4, code);
+    writeFrame(out, GOAWAY, 0, 0, payload, sizeof(payload));
+}
+
+void H2Session::onFrame(const uint8_t type, const uint8_t flags,
+                        const uint32_t streamId, const uint8_t *payload,
+                        const size_t len, Buffer &out) {
+    // 首部块必须连续，中间不能插入其他帧
+    if (_headerStream != 0 && type != CONTINUATION) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    // 前言之后的第一帧必须是 SETTINGS
+    if (!_settingsSeen && type != SETTINGS) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    switch (type) {
+    case DATA:
+        onData(flags, streamId, payload, len, out);
+        break;
+    case HEADERS:
+        onHeaders(flags, streamId, payload, len, out);
+        break;
+    case PRIORITY:
+        if (streamId == 0) {
+            connError(PROTOCOL_ERROR, out);
+        } else if (len != 5) {
+            streamError(streamId, FRAME_SIZE_ERROR, out);
+        } else if ((get32(payload) & 0x7fffffff) == streamId) {
+            streamError(streamId, PROTOCOL_ERROR, out);
+        } else if (const auto it = _streams.find(streamId);
+                   it != _streams.end()) {
+            it->second.weight = static_cast<uint16_t>(payload[4] + 1);
+        }
+        break;
+    case RST_STREAM:
+        if (streamId == 0 || streamId > _lastStreamId) {
+            connError(PROTOCOL_ERROR, out);
+        } else if (len != 4) {
+            connError(FRAME_SIZE_ERROR, out);
+        } else {
+            _streams.erase(streamId);
+        }
+        break;
+    case SETTINGS:
+        onSettings(flags, streamId, payload, len, out);
+        break;
+    case PUSH_PROMISE: // 客户端不能推送
+        connError(PROTOCOL_ERROR, out);
+        break;
+    case PING:
+        if (streamId != 0) {
+            connError(PROTOCOL_ERROR, out);
+        } else if (len != 8) {
+            connError(FRAME_SIZE_ERROR, out);
+        } else if (!(flags & ACK)) {
+            writeFrame(out, PING, ACK, 0, payload, len);
+        }
+        break;
+    case GOAWAY:
+        if (streamId != 0) {
+            connError(PROTOCOL_ERROR, out);
+            break;
+        }
+        LOG_D("conn {}: peer sent GOAWAY.", _connId);
+        _goAwayRecv = true;
+        break;
+    case WINDOW_UPDATE:
+        onWindowUpdate(streamId, payload, len, out);
+        break;
+    case CONTINUATION:
+        if (_headerStream == 0 || streamId != _headerStream) {
+            connError(PROTOCOL_ERROR, out);
+            break;
+        }
+        _headerBlock.append(reinterpret_cast<const char *>(payload), len);
+        if (_headerBlock.size() > headerBlockLimit()) {
+            connError(ENHANCE_YOUR_CALM, out);
+            break;
+        }
+        if (flags & END_HEADERS) {
+            onHeaderBlock(out);
+        }
+        break;
+    default: // 未知类型的帧必须忽略
+        break;
+    }
+}
+
+void H2Session::onHeaders(const uint8_t flags, const uint32_t streamId,
+                          const uint8_t *payload, size_t len, Buffer &out) {
+    if (streamId == 0 || streamId % 2 == 0) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    size_t pad = 0;
+    if (flags & PADDED) {
+        if (len < 1) {
+            connError(PROTOCOL_ERROR, out);
+            return;
+        }
+        pad = *payload++;
+        --len;
+    }
+    uint16_t weight = 0;
+    if (flags & PRIORITY_FLAG) {
+        // 依赖自己不合法；为保持 HPACK 状态一致，按连接错误处理
+        if (len < 5 || (get32(payload) & 0x7fffffff) == streamId) {
+            connError(PROTOCOL_ERROR, out);
+            return;
+        }
+        weight = static_cast<uint16_t>(payload[4] + 1);
+        payload += 5;
+        len -= 5;
+    }
+    if (pad > len) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    _headerStream = streamId;
+    _headerFlags = flags;
+    _headerWeight = weight;
+    _headerBlock.assign(reinterpret_cast<const char *>(payload), len - pad);
+    if (_headerBlock.size() > headerBlockLimit()) {
+        connError(ENHANCE_YOUR_CALM, out);
+        return;
+    }
+    if (flags & END_HEADERS) {
+        onHeaderBlock(out);
+    }
+}
+
+void H2Session::onHeaderBlock(Buffer &out) {
+    const uint32_t streamId = std::exchange(_headerStream, 0);
+    std::vector<hpack::HeaderField> fields;
+    // 即使随后拒绝该流也必须先解码，否则动态表会与对端不同步
+    const auto decoded =
+        _decoder.Decode(reinterpret_cast<const uint8_t *>(_headerBlock.data()),
+                        _headerBlock.size(), fields, Request::maxHeaderBytes);
+    if (decoded == hpack::Decoder::Result::ERROR) {
+        connError(COMPRESSION_ERROR, out);
+        return;
+    }
+    _headerBlock.clear();
+    const bool endStream = _headerFlags & END_STREAM;
+    // 与 HTTP/1.1 的首部行数同口径：不计伪首部
+    const bool tooLarge =
+        decoded == hpack::Decoder::Result::TOO_LARGE ||
+        std::count_if(fields.begin(), fields.end(), [](const auto &field) {
+            return field.name.empty() || field.name[0] != ':';
+        }) > static_cast<std::ptrdiff_t>(Request::maxHeaders);
+    if (const auto it = _streams.find(streamId); it != _streams.end()) {
+        // 已打开的流上再来首部块只能是带 END_STREAM 的 trailers
+        if (it->second.endRemote || !endStream) {
+            streamError(streamId,
+                        it->second.endRemote ? STREAM_CLOSED : PROTOCOL_ERROR,
+                        out);
+            return;
+        }
+        it->second.endRemote = true;
+        if (tooLarge) {
+            reject(streamId, 431, out);
+            return;
+        }
+        dispatch(streamId, out);
+        return;
+    }
+    if (streamId <= _lastStreamId) {
+        connError(STREAM_CLOSED, out);
+        return;
+    }
+    _lastStreamId = streamId;
+    if (_goAwaySent) {
+        return; // GOAWAY 之后的新流直接忽略
+    }
+    if (_streams.size() >= maxStreams) {
+        streamError(streamId, REFUSED_STREAM, out);
+        return;
+    }
+    if (tooLarge) {
+        LOG_W("conn {}: h2 stream {} headers too large.", _connId, streamId);
+        _streams[streamId].endRemote = endStream;
+        reject(streamId, 431, out);
+        return;
+    }
+    Stream &stream = _streams[streamId];
+    stream.sendWindow = _peerInitialWindow;
+    stream.recvWindow = LOCAL_WINDOW;
+    if (_headerWeight > 0) {
+        stream.weight = _headerWeight;
+    }
+    stream.headers = std::move(fields);
+    stream.endRemote = endStream;
+    if (endStream) {
+        dispatch(streamId, out);
+    }
+}
+
+void H2Session::onData(const uint8_t flags, const uint32_t streamId,
+                       const uint8_t *payload, const size_t len, Buffer &out) {
+    if (streamId == 0 || streamId > _lastStreamId) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    // 连接级流量控制按整帧（含填充）计算
+    _connRecvWindow -= static_cast<int64_t>(len);
+    if (_connRecvWindow < 0) {
+        connError(FLOW_CONTROL_ERROR, out);
+        return;
+    }
+    _recvConsumed += len;
+    const auto it = _streams.find(streamId);
+    if (it == _streams.end() || it->second.endRemote) {
+        streamError(streamId, STREAM_CLOSED, out);
+        return;
+    }
+    Stream &stream = it->second;
+    size_t pad = 0;
+    size_t n = len;
+    if (flags & PADDED) {
+        if (n < 1 || payload[0] >= n) {
+            connError(PROTOCOL_ERROR, out);
+            return;
+        }
+        pad = *payload++;
+        n -= 1 + pad;
+    }
+    stream.recvWindow -= static_cast<int64_t>(len);
+    if (stream.recvWindow < 0) {
+        streamError(streamId, FLOW_CONTROL_ERROR, out);
+        return;
+    }
+    if (stream.body.size() + n > Request::maxBodyBytes) {
+        LOG_W("conn {}: h2 stream {} body too large.", _connId, streamId);
+        reject(streamId, 413, out);
+        return;
+    }
+    stream.body.append(reinterpret_cast<const char *>(payload), n);
+    if (flags & END_STREAM) {
+        stream.endRemote = true;
+        dispatch(streamId, out);
+    } else if (len > 0) {
+        writeWindowUpdate(out, streamId, len);
+        stream.recvWindow += static_cast<int64_t>(len);
+    }
+}
+
+void H2Session::onSettings(const uint8_t flags, const uint32_t streamId,
+                           const uint8_t *payload, const size_t len,
+                           Buffer &out) {
+    if (streamId != 0) {
+        connError(PROTOCOL_ERROR, out);
+        return;
+    }
+    if (flags & ACK) {
+        if (len != 0) {
+            connError(FRAME_SIZE_ERROR, out);
+        }
+        return;
+    }
+    if (len % 6 != 0) {
+        connError(FRAME_SIZE_ERROR, out);
+        return;
+    }
+    if (const uint32_t code = applySettings(payload, len); code != NO_ERROR) {
+        connError(code, out);
+        return;
+    }
+    _settingsSeen = true;
+    writeFrame(out, SETTINGS, ACK, 0, nullptr, 0);
+}
+
+uint32_t H2Session::applySettings(const uint8_t *payload, const size_t len) {
+    for (size_t i = 0; i + 6 <= len; i += 6) {
+        const auto id = static_cast<uint16_t>(payload[i] << 8 | payload[i + 1]);
+        const uint32_t value = get32(payload + i + 2);
+        switch (id) {
+        case HEADER_TABLE_SIZE:
+            _encoder.SetMaxTableSize(value);
+            break;
+        case ENABLE_PUSH:
+            if (value > 1) {
+                return PROTOCOL_ERROR;
+            }
+            break;
+        case INITIAL_WINDOW_SIZE: {
+            if (value > MAX_WINDOW) {
+                return FLOW_CONTROL_ERROR;
+            }
+            // 已打开的流按差值调整发送窗口，可能变成负数
+            const int64_t delta = static_cast<int64_t>(value) - _peerInitialWindow;
+            for (auto &[id, stream] : _streams) {
+                stream.sendWindow += delta;
+                if (stream.sendWindow > MAX_WINDOW) {
+                    return FLOW_CONTROL_ERROR;
+                }
+            }
+            _peerInitialWindow = value;
+            break;
+        }
+        case MAX_FRAME_SIZE:
+            if (value < 16384 || value > 16777215) {
+                return PROTOCOL_ERROR;
+            }
+            _peerMaxFrame = value;
+            break;
+        default: // 未知设置必须忽略
+            break;
+        }
+    }
+    return NO_ERROR;
+}
+
+void H2Session::onWindowUpdate(const uint32_t streamId, const uint8_t *payload,
+                               const size_t len, Buffer &out) {
+    if (len != 4) {
+        connError(FRAME_SIZE_ERROR, out);
+        return;
+    }
+    const uint32_t increment = get32(payload) & 0x7fffffff;
+    if (streamId == 0) {
+        _connSendWindow += increment;
+        if (increment == 0) {
+            connError(PROTOCOL_ERROR, out);
+        } else if (_connSendWindow > MAX_WINDOW) {
+            connError(FLOW_CONTROL_ERROR, out);
+        }
+        return;
+    }
+    const auto it = _streams.find(streamId);
+    if (it == _streams.end()) {
+        return; // 已关闭的流上迟到的 WINDOW_UPDATE
+    }
+    it->second.sendWindow += increment;
+    if (increment == 0) {
+        streamError(streamId, PROTOCOL_ERROR, out);
+    } else if (it->second.sendWindow > MAX_WINDOW) {
+        streamError(streamId, FLOW_CONTROL_ERROR, out);
+    }
+}
+
+void H2Session::dispatch(const uint32_t streamId, Buffer &out) {
+    Stream &stream = _streams.find(streamId)->second;
+    std::string method, path;
+    std::unordered_map<std::string, std::string> header;
+    for (auto &[name, value] : stream.headers) {
+        if (name.empty()) {
+            continue;
+        }
+        if (name[0] == ':') {
+            if (name == ":method") {
+                method = std::move(value);
+            } else if (name == ":path") {
+                path = std::move(value);
+            } else if (name == ":authority") {
+                header["Host"] = std::move(value);
+            }
+            continue;
+        }
+        if (name == "priority") {
+            stream.urgency = parseUrgency(value);
+        }
+        // 同名首部合并，cookie 可能被拆成多个字段（RFC 9113 8.2.3）
+        auto &merged = header[canonicalName(name)];
+        if (!merged.empty()) {
+            merged += name == "cookie" ? "; " : ", ";
+        }
+        merged += value;
+    }
+    stream.headers.clear();
+    if (method.empty() || path.empty()) {
+        streamError(streamId, PROTOCOL_ERROR, out);
+        return;
+    }
+    if (Conn::admit) {
+        if (const int code = Conn::admit(_limiterSlot); code == 503) {
+            // 过载丢弃：流还没被处理，REFUSED_STREAM 告诉对端可以安全重试
+            streamError(streamId, REFUSED_STREAM, out);
+            return;
+        } else if (code != 0) {
+            reject(streamId, code, out);
+            return;
+        }
+    }
+    metrics::Server().requests.Inc();
+    Request req;
+    req.Assign(std::move(method), std::move(path), std::move(header),
+               std::move(stream.body));
+    const Conn::Lane lane = Conn::offload
+                                ? Conn::LaneOf(req.Method(), req.Path())
+                                : Conn::Lane::IO;
+    if (lane == Conn::Lane::IO) {
+        respond(streamId, stream, req, out);
+        return;
+    }
+    // 处理函数（可能要查数据库）不在 IO 工作线程上跑，否则连接上其他流都要等它
+    auto job = std::make_shared<Job>();
+    job->req = std::move(req);
+    if (AccessLog::GetInstance().Enabled()) {
+        job->start = std::chrono::steady_clock::now();
+    }
+    const bool queued = Conn::offload(
+        lane, _fd, _connId,
+        [job] {
+            job->ok = Conn::Render(job->req, job->response, job->head, false);
+            job->done.store(true, std::memory_order_release);
+        },
+        [job] {
+            job->shed = true;
+            job->done.store(true, std::memory_order_release);
+        });
+    if (!queued) {
+        LOG_W("conn {}: lane full, refuse h2 stream {}.", _connId, streamId);
+        streamError(streamId, REFUSED_STREAM, out);
+        return;
+    }
+    stream.job = std::move(job);
+}
+
+void H2Session::respond(const uint32_t streamId, Stream &stream, Request &req,
+                        Buffer &out) {
+    const auto start = AccessLog::GetInstance().Enabled()
+                           ? std::chrono::steady_clock::now()
+                           : std::chrono::steady_clock::time_point{};
+    Buffer head;
+    Response response;
+    if (!Conn::Render(req, response, head, false)) {
+        streamError(streamId, INTERNAL_ERROR, out);
+        return;
+    }
+    reply(streamId, stream, req, response, head, start, out);
+}
+
+void H2Session::collect(Buffer &out) {
+    for (auto it = _streams.begin(); it != _streams.end();) {
+        const uint32_t streamId = it->first;
+        Stream &stream = it->second;
+        ++it; // 下面可能删掉这个流
+        if (!stream.job || !stream.job->done.load(std::memory_order_acquire)) {
+            continue;
+        }
+        const std::shared_ptr<Job> job = std::move(stream.job);
+        if (job->shed) {
+            // 处理函数没有执行，对端可以安全重试
+            streamError(streamId, REFUSED_STREAM, out);
+        } else if (!job->ok) {
+            streamError(streamId, INTERNAL_ERROR, out);
+        } else {
+            reply(streamId, stream, job->req, job->response, job->head,
+                  job->start, out);
+        }
+    }
+}
+
+void H2Session::reply(const uint32_t streamId, Stream &stream,
+                      const Request &req, Response &response, Buffer &head,
+                      const std::chrono::steady_clock::time_point start,
+                      Buffer &out) {
+    if (auto body = response.TakeStream()) {
+        // 流式响应靠可写事件一块块拉取，这里是同步处理的，没有办法接着发：
+        // 与协程处理函数一样回 501，而不是发出被截断的响应体
+        body->Detach();
+        LOG_W("{}: streamed response is not available over HTTP/2.",
+              req.Path());
+        head.RetrieveAll();
+        head.Append("HTTP/1.1 501 Not Implemented\r\nContent-length: 0\r\n\r\n");
+    }
+    // 处理函数写的是 HTTP/1.1 格式：拆出状态码、首部和已写入的响应体
+    const std::string_view text(head.Peek(), head.ReadableBytes());
+    const size_t headerEnd = text.find("\r\n\r\n");
+    if (text.size() < 12 || headerEnd == std::string_view::npos) {
+        streamError(streamId, INTERNAL_ERROR, out);
+        return;
+    }
+    const std::string status(text.substr(9, 3));
+    std::vector<hpack::HeaderField> fields{{":status", status}};
+    for (size_t pos = text.find("\r\n") + 2; pos < headerEnd;) {
+        const size_t eol = text.find("\r\n", pos);
+        const std::string_view line = text.substr(pos, eol - pos);
+        pos = eol + 2;
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string name(line.substr(0, colon));
+        std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        });
+        if (connectionSpecific(name)) {
+            continue;
+        }
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+        fields.push_back({std::move(name), std::string(value)});
+    }
+    if (req.Method() != "HEAD") {
+        stream.out.assign(text.substr(headerEnd + 4));
+        if (response.File() && response.FileLen() > 0) {
+            stream.out.append(response.File(), response.FileLen());
+        }
+    }
+    response.UnmapFile();
+
+    std::string block;
+    _encoder.Encode(fields, block);
+    const bool endStream = stream.out.empty();
+    size_t offset = 0;
+    do { // 超过对端帧大小上限的首部块拆成 HEADERS + CONTINUATION
+        const size_t n = std::min<size_t>(block.size() - offset, _peerMaxFrame);
+        uint8_t flags = offset + n == block.size() ? END_HEADERS : 0;
+        if (offset == 0 && endStream) {
+            flags |= END_STREAM;
+        }
+        writeFrame(out, offset == 0 ? HEADERS : CONTINUATION, flags, streamId,
+                   block.data() + offset, n);
+        offset += n;
+    } while (offset < block.size());
+    stream.responding = true;
+
+    if (AccessLog::GetInstance().Enabled()) {
+        AccessLog::GetInstance().Record(_connId, req.Method(), req.Path(),
+                                        atoi(status.c_str()), stream.out.size(),
+                                        start);
+    }
+    if (endStream) {
+        _streams.erase(streamId);
+    }
+}
+
+void H2Session::flush(Buffer &out) {
+    size_t budget = MAX_FLUSH_BYTES;
+    while (budget > 0 && _connSendWindow > 0) {
+        // urgency 小的优先，其次权重大的，map 有序保证同级时流 ID 小的优先
+        uint32_t bestId = 0;
+        Stream *best = nullptr;
+        for (auto &[id, stream] : _streams) {
+            if (!stream.responding || stream.sent >= stream.out.size() ||
+                stream.sendWindow <= 0) {
+                continue;
+            }
+            if (!best || stream.urgency < best->urgency ||
+                (stream.urgency == best->urgency &&
+                 stream.weight > best->weight)) {
+                best = &stream;
+                bestId = id;
+            }
+        }
+        if (!best) {
+            break; // 没有可发的数据，或都在等 WINDOW_UPDATE
+        }
+        const size_t n = std::min({best->out.size() - best->sent,
+                                   static_cast<size_t>(_peerMaxFrame),
+                                   static_cast<size_t>(_connSendWindow),
+                                   static_cast<size_t>(best->sendWindow),
+                                   budget});
+        const bool last = best->sent + n == best->out.size();
+        writeFrame(out, DATA, last ? END_STREAM : 0, bestId,
+                   best->out.data() + best->sent, n);
+        best->sent += n;
+        best->sendWindow -= static_cast<int64_t>(n);
+        _connSendWindow -= static_cast<int64_t>(n);
+        budget -= n;
+        if (last) {
+            _streams.erase(bestId);
+        }
+    }
+}
+
+void H2Session::reject(const uint32_t streamId, const int status, Buffer &out) {
+    std::vector<hpack::HeaderField> fields{{":status", std::to_string(status)},
+                                           {"content-length", "0"}};
+    if (status == 429) {
+        fields.push_back({"retry-after", "1"});
+    }
+    std::string block;
+    _encoder.Encode(fields, block);
+    writeFrame(out, HEADERS, END_HEADERS | END_STREAM, streamId, block.data(),
+               block.size());
+    if (const auto it = _streams.find(streamId);
+        it != _streams.end() && !it->second.endRemote) {
+        // 请求还没发完：NO_ERROR 让对端停止发送而不必重试（RFC 9113 8.1）
+        uint8_t payload[4];
+        put32(payload, NO_ERROR);
+        writeFrame(out, RST_STREAM, 0, streamId, payload, sizeof(payload));
+    }
+    _streams.erase(streamId);
+}
+
+void H2Session::connError(const uint32_t code, Buffer &out) {
+    LOG_W("conn {}: h2 connection error {}.", _connId, code);
+    GoAway(out, code);
+    _closed = true;
+}
+
+void H2Session::streamError(const uint32_t streamId, const uint32_t code,
+                            Buffer &out) {
+    LOG_D("conn {}: h2 stream {} reset, error {}.", _connId, streamId, code);
+    uint8_t payload[4];
+    put32(payload, code);
+    writeFrame(out, RST_STREAM, 0, streamId, payload, sizeof(payload));
+    _streams.erase(streamId);
+}
+
+} // namespace zener::http
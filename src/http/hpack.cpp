@@ -0,0 +1,438 @@
+#include "http/hpack.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace zener::http::hpack {
+
+namespace {
+
+// RFC 7541 附录 A
+const HeaderField STATIC_TABLE[61] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+constexpr size_t STATIC_SIZE = std::size(STATIC_TABLE);
+constexpr size_t ENTRY_OVERHEAD = 32;
+// 首部列表大小按 "name: value\r\n" 计算，与 HTTP/1.1 的 Request::maxHeaderBytes 口径一致
+constexpr size_t LINE_OVERHEAD = 4;
+
+// RFC 7541 附录 B，下标 256 为 EOS
+constexpr uint32_t HUFFMAN_CODES[257] = {
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5,
+    0xfffffe6, 0xfffffe7, 0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9,
+    0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec, 0xfffffed, 0xfffffee,
+    0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9,
+    0xffffffa, 0xffffffb, 0x14, 0x3f8, 0x3f9, 0xffa,
+    0x1ff9, 0x15, 0xf8, 0x7fa, 0x3fa, 0x3fb,
+    0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b,
+    0x1c, 0x1d, 0x1e, 0x1f, 0x5c, 0xfb,
+    0x7ffc, 0x20, 0xffb, 0x3fc, 0x1ffa, 0x21,
+    0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e,
+    0x6f, 0x70, 0x71, 0x72, 0xfc, 0x73,
+    0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5,
+    0x25, 0x26, 0x27, 0x6, 0x74, 0x75,
+    0x28, 0x29, 0x2a, 0x7, 0x2b, 0x76,
+    0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd,
+    0x1ffd, 0xffffffc, 0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8,
+    0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9, 0x3fffd6, 0x7fffda,
+    0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1,
+    0x7fffe2, 0x7fffe3, 0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5,
+    0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef, 0x3fffda, 0x1fffdd,
+    0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf,
+    0x7fffeb, 0x7fffec, 0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2,
+    0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef, 0xfffea, 0x3fffe2,
+    0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2,
+    0x3fffe8, 0x1ffffec, 0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde,
+    0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed, 0x7fff2, 0x1fffe3,
+    0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3,
+    0x7ffffe4, 0x7ffffe5, 0xfffec, 0xfffff3, 0xfffed, 0x1fffe6,
+    0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3, 0x3fffea, 0x3fffeb,
+    0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8,
+    0x7ffffe9, 0x7ffffea, 0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed,
+    0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee, 0x3fffffff,
+};
+constexpr uint8_t HUFFMAN_LENS[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+// 按码字逐位走的二叉树，启动时由码表建一次
+struct HuffmanNode {
+    int16_t child[2]{-1, -1};
+    int16_t sym{-1};
+};
+
+const std::vector<HuffmanNode> &huffmanTree() {
+    static const std::vector<HuffmanNode> tree = [] {
+        std::vector<HuffmanNode> nodes(1);
+        for (int sym = 0; sym < 257; ++sym) {
+            size_t node = 0;
+            for (int bit = HUFFMAN_LENS[sym] - 1; bit >= 0; --bit) {
+                const int b = static_cast<int>(HUFFMAN_CODES[sym] >> bit & 1U);
+                if (nodes[node].child[b] < 0) {
+                    nodes[node].child[b] = static_cast<int16_t>(nodes.size());
+                    nodes.emplace_back();
+                }
+                node = static_cast<size_t>(nodes[node].child[b]);
+            }
+            nodes[node].sym = static_cast<int16_t>(sym);
+        }
+        return nodes;
+    }();
+    return tree;
+}
+
+bool decodeString(const uint8_t *&p, const uint8_t *end, std::string &out) {
+    if (p >= end) {
+        return false;
+    }
+    const bool huffman = *p & 0x80;
+    uint64_t len = 0;
+    if (!DecodeInt(p, end, 7, len) || len > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+    out.clear();
+    if (huffman) {
+        if (!HuffmanDecode(p, len, out)) {
+            return false;
+        }
+    } else {
+        out.assign(reinterpret_cast<const char *>(p), len);
+    }
+    p += len;
+    return true;
+}
+
+void encodeString(const std::string &str, std::string &out) {
+    EncodeInt(str.size(), 7, 0x00, out);
+    out += str;
+}
+
+// 每次都变或者较长的值放进动态表只会把有用的条目挤出去
+bool worthIndexing(const HeaderField &field, const size_t maxSize) {
+    return field.name != "content-length" && field.value.size() <= 128 &&
+           field.name.size() + field.value.size() + ENTRY_OVERHEAD <=
+               maxSize / 4;
+}
+
+} // namespace
+
+void EncodeInt(uint64_t value, const int prefixBits, const uint8_t firstByte,
+               std::string &out) {
+    const uint64_t mask = (1U << prefixBits) - 1;
+    if (value < mask) {
+        out.push_back(static_cast<char>(firstByte | value));
+        return;
+    }
+    out.push_back(static_cast<char>(firstByte | mask));
+    value -= mask;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool DecodeInt(const uint8_t *&p, const uint8_t *end, const int prefixBits,
+               uint64_t &value) {
+    if (p >= end) {
+        return false;
+    }
+    const uint64_t mask = (1U << prefixBits) - 1;
+    value = *p++ & mask;
+    if (value < mask) {
+        return true;
+    }
+    for (int shift = 0; p < end; shift += 7) {
+        if (shift > 56) {
+            return false; // 溢出
+        }
+        const uint8_t b = *p++;
+        value += static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HuffmanDecode(const uint8_t *data, const size_t len, std::string &out) {
+    const auto &tree = huffmanTree();
+    size_t node = 0;
+    int depth = 0;      // 当前未完成码字的位数
+    bool allOnes = true; // 填充必须是 EOS 的前缀（全 1）
+    for (size_t i = 0; i < len; ++i) {
+        for (int bit = 7; bit >= 0; --bit) {
+            const int b = data[i] >> bit & 1;
+            const int16_t next = tree[node].child[b];
+            if (next < 0) {
+                return false;
+            }
+            node = static_cast<size_t>(next);
+            ++depth;
+            allOnes = allOnes && b;
+            if (const int16_t sym = tree[node].sym; sym >= 0) {
+                if (sym == 256) {
+                    return false; // 首部中出现 EOS 是错误
+                }
+                out.push_back(static_cast<char>(sym));
+                node = 0;
+                depth = 0;
+                allOnes = true;
+            }
+        }
+    }
+    return depth <= 7 && allOnes;
+}
+
+void DynamicTable::Add(HeaderField field) {
+    const size_t size = field.name.size() + field.value.size() + ENTRY_OVERHEAD;
+    if (size > _maxSize) {
+        // 比整张表还大：清空，不插入
+        _entries.clear();
+        _size = 0;
+        return;
+    }
+    evict(size);
+    _size += size;
+    _entries.push_front(std::move(field));
+}
+
+void DynamicTable::SetMaxSize(const size_t maxSize) {
+    _maxSize = maxSize;
+    evict(0);
+}
+
+void DynamicTable::evict(const size_t need) {
+    while (!_entries.empty() && _size + need > _maxSize) {
+        const auto &last = _entries.back();
+        _size -= last.name.size() + last.value.size() + ENTRY_OVERHEAD;
+        _entries.pop_back();
+    }
+}
+
+const HeaderField *DynamicTable::Get(const size_t index) const {
+    if (index == 0) {
+        return nullptr;
+    }
+    if (index <= STATIC_SIZE) {
+        return &STATIC_TABLE[index - 1];
+    }
+    const size_t pos = index - STATIC_SIZE - 1;
+    return pos < _entries.size() ? &_entries[pos] : nullptr;
+}
+
+size_t DynamicTable::Find(const std::string &name, const std::string &value,
+                          size_t *nameIndex) const {
+    *nameIndex = 0;
+    for (size_t i = 0; i < STATIC_SIZE; ++i) {
+        if (STATIC_TABLE[i].name != name) {
+            continue;
+        }
+        if (STATIC_TABLE[i].value == value) {
+            return i + 1;
+        }
+        if (*nameIndex == 0) {
+            *nameIndex = i + 1;
+        }
+    }
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        if (_entries[i].name != name) {
+            continue;
+        }
+        if (_entries[i].value == value) {
+            return STATIC_SIZE + i + 1;
+        }
+        if (*nameIndex == 0) {
+            *nameIndex = STATIC_SIZE + i + 1;
+        }
+    }
+    return 0;
+}
+
+Decoder::Result Decoder::Decode(const uint8_t *data, const size_t len,
+                                std::vector<HeaderField> &out,
+                                const size_t maxListSize) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    size_t listSize = 0;
+    // 超限后继续解码以更新动态表，但不再保存首部：
+    // 反复引用动态表里的大条目时，解码结果可以比首部块本身大几千倍
+    bool tooLarge = false;
+    while (p < end) {
+        const uint8_t b = *p;
+        uint64_t index = 0;
+        HeaderField field;
+        if (b & 0x80) { // 索引
+            if (!DecodeInt(p, end, 7, index)) {
+                return Result::ERROR;
+            }
+            const HeaderField *indexed = _table.Get(index);
+            if (!indexed) {
+                return Result::ERROR;
+            }
+            listSize += indexed->name.size() + indexed->value.size() +
+                        LINE_OVERHEAD;
+            if (!tooLarge && listSize <= maxListSize) {
+                out.push_back(*indexed);
+            }
+        } else if ((b & 0xe0) == 0x20) { // 动态表大小更新
+            if (!DecodeInt(p, end, 5, index) || index > _limit) {
+                return Result::ERROR;
+            }
+            _table.SetMaxSize(index);
+            continue;
+        } else { // 字面量：01 带索引，0000 不索引，0001 永不索引
+            const bool incremental = (b & 0xc0) == 0x40;
+            if (!DecodeInt(p, end, incremental ? 6 : 4, index)) {
+                return Result::ERROR;
+            }
+            if (index > 0) {
+                const HeaderField *named = _table.Get(index);
+                if (!named) {
+                    return Result::ERROR;
+                }
+                field.name = named->name;
+            } else if (!decodeString(p, end, field.name)) {
+                return Result::ERROR;
+            }
+            if (!decodeString(p, end, field.value)) {
+                return Result::ERROR;
+            }
+            listSize += field.name.size() + field.value.size() + LINE_OVERHEAD;
+            if (incremental) {
+                _table.Add(field);
+            }
+            if (!tooLarge && listSize <= maxListSize) {
+                out.push_back(std::move(field));
+            }
+        }
+        if (!tooLarge && listSize > maxListSize) {
+            tooLarge = true;
+            out.clear();
+        }
+    }
+    return tooLarge ? Result::TOO_LARGE : Result::OK;
+}
+
+void Encoder::SetMaxTableSize(size_t size) {
+    // 不超过默认值：编码端只会用到这么多
+    size = std::min(size, DynamicTable::DEFAULT_TABLE_SIZE);
+    if (size != _table.MaxSize()) {
+        _table.SetMaxSize(size);
+        _sizeUpdate = true;
+    }
+}
+
+void Encoder::Encode(const std::vector<HeaderField> &fields, std::string &out) {
+    if (std::exchange(_sizeUpdate, false)) {
+        EncodeInt(_table.MaxSize(), 5, 0x20, out);
+    }
+    for (const auto &field : fields) {
+        size_t nameIndex = 0;
+        if (const size_t index = _table.Find(field.name, field.value, &nameIndex);
+            index > 0) {
+            EncodeInt(index, 7, 0x80, out);
+            continue;
+        }
+        const bool indexing = worthIndexing(field, _table.MaxSize());
+        EncodeInt(nameIndex, indexing ? 6 : 4, indexing ? 0x40 : 0x00, out);
+        if (nameIndex == 0) {
+            encodeString(field.name, out);
+        }
+        encodeString(field.value, out);
+        if (indexing) {
+            _table.Add(field);
+        }
+    }
+}
+
+} // namespace zener::http::hpack
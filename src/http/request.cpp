@@ -3,7 +3,11 @@
 #include "database/sqlconnRAII.hpp"
 #include "utils/log/logger.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <mysql/mysql.h>
+#include <string_view>
+#include <strings.h> // strncasecmp
 // TODO: 替换为boost::regex
 #include <boost/regex.hpp>
 // #include <regex>
@@ -19,9 +23,14 @@ const std::unordered_map<std::string, int> Request::DEFAULT_HTML_TAG{
     {"/login.html", 1},
 };
 
+size_t Request::maxHeaderBytes = 8192;
+size_t Request::maxHeaders = 100;
+size_t Request::maxBodyBytes = 1 << 20;
+
 void Request::Init() {
     _method = _path = _version = _body = "";
     _state = REQUEST_LINE;
+    _contentLength = 0;
     _header.clear();
     _post.clear();
 }
@@ -34,12 +43,37 @@ bool Request::IsKeepAlive() const {
     return false;
 }
 
+std::string Request::GetHeader(const std::string &key) const {
+    const auto it = _header.find(key);
+    return it == _header.end() ? std::string{} : it->second;
+}
+
+void Request::Assign(std::string method, std::string path,
+                     std::unordered_map<std::string, std::string> header,
+                     std::string body) {
+    _method = std::move(method);
+    _path = std::move(path);
+    _version = "2";
+    _header = std::move(header);
+    _body = std::move(body);
+    _post.clear();
+    parsePath();
+    parsePost();
+    _state = FINISH;
+}
+
 bool Request::parse(Buffer &buff) {
     constexpr char CRLF[] = "\r\n";
     if (buff.ReadableBytes() <= 0) {
         return false;
     }
     while (buff.ReadableBytes() && _state != FINISH) {
+        if (_state == BODY) {
+            const size_t len = std::min(buff.ReadableBytes(), _contentLength);
+            parseBody(std::string(buff.Peek(), len));
+            buff.Retrieve(len);
+            break;
+        }
         const char *lineEnd =
             std::search(buff.Peek(), buff.BeginWrite(), CRLF, CRLF + 2);
         const char *peek = buff.Peek();
@@ -52,14 +86,12 @@ bool Request::parse(Buffer &buff) {
             parsePath();
             break;
         case HEADERS:
-            parseHeader(line);
-            if (buff.ReadableBytes() <= 2) {
-                _state = FINISH;
+            if (line.empty()) { // 空行：首部结束
+                _state = _contentLength > 0 ? BODY : FINISH;
+            } else if (!parseHeader(line)) {
+                return false;
             }
             break;
-        case BODY:
-            parseBody(line);
-            break;
         default:
             break;
         }
@@ -72,17 +104,51 @@ bool Request::parse(Buffer &buff) {
     return true;
 }
 
-void Request::parsePath() {
-    if (_path == "/") {
-        _path = "/index.html";
-    } else {
-        for (auto &item : DEFAULT_HTML) {
-            if (item == _path) {
-                _path += ".html";
-                break;
-            }
+Request::Framing Request::Frame(const char *data, const size_t len,
+                                size_t &bodyBytes) {
+    const std::string_view buf(data, std::min(len, maxHeaderBytes));
+    const size_t headEnd = buf.find("\r\n\r\n");
+    if (headEnd == std::string_view::npos) {
+        return len >= maxHeaderBytes ? Framing::HEAD_TOO_LARGE
+                                     : Framing::PARTIAL_HEAD;
+    }
+    // 逐行数首部，顺带找 Content-Length（首部名大小写不敏感）
+    constexpr std::string_view CONTENT_LENGTH = "Content-Length:";
+    size_t headers = 0;
+    size_t contentLength = 0;
+    for (size_t pos = buf.find("\r\n") + 2; pos < headEnd + 2;) {
+        const size_t eol = buf.find("\r\n", pos);
+        if (++headers > maxHeaders) {
+            return Framing::HEAD_TOO_LARGE;
+        }
+        if (eol - pos > CONTENT_LENGTH.size() &&
+            strncasecmp(data + pos, CONTENT_LENGTH.data(),
+                        CONTENT_LENGTH.size()) == 0) {
+            contentLength = strtoull(data + pos + CONTENT_LENGTH.size(),
+                                     nullptr, 10);
         }
+        pos = eol + 2;
+    }
+    if (contentLength > maxBodyBytes) {
+        return Framing::BODY_TOO_LARGE;
+    }
+    bodyBytes = len - (headEnd + 4);
+    if (bodyBytes < contentLength) {
+        return Framing::PARTIAL_BODY;
+    }
+    return Framing::COMPLETE;
+}
+
+void Request::parsePath() { _path = CanonicalPath(std::move(_path)); }
+
+std::string Request::CanonicalPath(std::string path) {
+    if (path == "/") {
+        return "/index.html";
+    }
+    if (DEFAULT_HTML.count(path) > 0) {
+        path += ".html";
     }
+    return path;
 }
 
 bool Request::parseRequestLine(const std::string &line) {
@@ -99,13 +165,17 @@ bool Request::parseRequestLine(const std::string &line) {
     return false;
 }
 
-void Request::parseHeader(const std::string &line) {
+bool Request::parseHeader(const std::string &line) {
     const boost::regex patten("^([^:]*): ?(.*)$");
     if (boost::smatch subMatch; boost::regex_match(line, subMatch, patten)) {
+        if (strcasecmp(subMatch[1].str().c_str(), "Content-Length") == 0) {
+            _contentLength = strtoull(subMatch[2].str().c_str(), nullptr, 10);
+        }
         _header[subMatch[1]] = subMatch[2];
-    } else {
-        _state = BODY;
+        return true;
     }
+    LOG_W("Header Error! line: {}", line);
+    return false;
 }
 
 void Request::parseBody(const std::string &line) {
@@ -1,5 +1,6 @@
 #include "http/response.h"
 #include "http/file_cache.h"
+#include "http/response_stream.h"
 #include "utils/log/logger.h"
 
 #include <cstring>
@@ -34,6 +35,8 @@ const std::unordered_map<int, std::string> Response::CODE_STATUS = {
     {400, "Bad Request"},
     {403, "Forbidden"},
     {404, "Not Found"},
+    {500, "Internal Server Error"},
+    {503, "Service Unavailable"},
 };
 
 const std::unordered_map<int, std::string> Response::CODE_PATH = {
@@ -61,6 +64,10 @@ void Response::Init(const std::string &staticDir, const std::string &path,
     _fileStat = {0};
     _cachedFilePath = "";
     _handled = false;
+    if (_stream) { // 处理函数开了流但没有被连接取走
+        _stream->Detach();
+        _stream.reset();
+    }
 }
 
 void Response::MakeResponse(Buffer &buff) {
@@ -214,6 +221,27 @@ void Response::Json(Buffer &buff, const std::string &json) {
     buff.Append(json);
 }
 
+std::shared_ptr<ResponseStream>
+Response::BeginStream(Buffer &buff, const std::string &contentType,
+                      const bool eventStream) {
+    _handled = true;
+    addStateLine(buff);
+    buff.Append("Connection: ");
+    if (_isKeepAlive) {
+        buff.Append("keep-alive\r\n");
+        buff.Append("keep-alive: max=6, timeout=120\r\n");
+    } else {
+        buff.Append("close\r\n");
+    }
+    buff.Append("Content-type: " + contentType + "\r\n");
+    if (eventStream) {
+        buff.Append("Cache-Control: no-cache\r\n");
+    }
+    buff.Append("Transfer-Encoding: chunked\r\n\r\n");
+    _stream = std::make_shared<ResponseStream>();
+    return _stream;
+}
+
 void Response::ErrorContent(Buffer &buff, const std::string &message) const {
     std::string body;
     std::string status;
@@ -0,0 +1,106 @@
+#include "http/response_cache.h"
+#include "utils/metrics/metrics.h"
+
+namespace zener::http {
+
+void ResponseCache::SetCapacity(const size_t bytes) {
+    std::lock_guard lk(_mtx);
+    _capacity = bytes;
+    evictLocked();
+}
+
+std::string ResponseCache::Key(const Request &request,
+                               const CachePolicy &policy,
+                               const bool keepAlive) {
+    std::string key = request.Method();
+    key.append(" ").append(request.Path());
+    for (const std::string &name : policy.vary) {
+        key.append("\n").append(name).append(": ").append(
+            request.GetHeader(name));
+    }
+    key.append(keepAlive ? "\nK" : "\nC");
+    return key;
+}
+
+ResponseCache::Lookup
+ResponseCache::Find(const std::string &key, const int fd, const uint64_t connId,
+                    std::shared_ptr<const CachedResponse> &entry,
+                    std::shared_ptr<CacheFlight> &flight) {
+    auto &stats = metrics::Server();
+    std::lock_guard lk(_mtx);
+    if (const auto it = _entries.find(key); it != _entries.end()) {
+        if (it->second.response->expires > std::chrono::steady_clock::now()) {
+            _lru.splice(_lru.begin(), _lru, it->second.lru);
+            entry = it->second.response;
+            stats.responseCacheHits.Inc();
+            return Lookup::HIT;
+        }
+        eraseLocked(it);
+    }
+    if (const auto it = _flights.find(key); it != _flights.end()) {
+        it->second->waiters.emplace_back(fd, connId);
+        flight = it->second;
+        stats.responseCacheCoalesced.Inc();
+        return Lookup::WAIT;
+    }
+    _flights.emplace(key, std::make_shared<CacheFlight>());
+    stats.responseCacheMisses.Inc();
+    return Lookup::LEAD;
+}
+
+void ResponseCache::Fill(const std::string &key,
+                         std::shared_ptr<const CachedResponse> response) {
+    std::shared_ptr<CacheFlight> flight;
+    {
+        std::lock_guard lk(_mtx);
+        if (const auto it = _flights.find(key); it != _flights.end()) {
+            flight = std::move(it->second);
+            _flights.erase(it);
+        }
+        if (response && response->data.size() <= _capacity) {
+            if (const auto it = _entries.find(key); it != _entries.end()) {
+                eraseLocked(it);
+            }
+            _lru.push_front(key);
+            _bytes += response->data.size();
+            _entries.emplace(key, Slot{response, _lru.begin()});
+            evictLocked();
+        }
+        if (!flight) {
+            return;
+        }
+        flight->result = std::move(response);
+        flight->done.store(true, std::memory_order_release);
+    }
+    // 登记在锁内完成，done 之后不会再有新的等待者
+    if (_waker) {
+        for (const auto &[fd, connId] : flight->waiters) {
+            _waker(fd, connId);
+        }
+    }
+}
+
+size_t ResponseCache::Bytes() const {
+    std::lock_guard lk(_mtx);
+    return _bytes;
+}
+
+size_t ResponseCache::Size() const {
+    std::lock_guard lk(_mtx);
+    return _entries.size();
+}
+
+void ResponseCache::evictLocked() {
+    while (_bytes > _capacity && !_lru.empty()) {
+        eraseLocked(_entries.find(_lru.back()));
+    }
+}
+
+void ResponseCache::eraseLocked(
+    const std::unordered_map<std::string, Slot>::iterator it) {
+    _bytes -= it->second.response->data.size();
+    _lru.erase(it->second.lru);
+    _entries.erase(it);
+}
+
+} // namespace zener::http
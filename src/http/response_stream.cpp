@@ -0,0 +1,145 @@
+#include "http/response_stream.h"
+
+#include <utility>
+
+namespace zener::http {
+
+ResponseStream::Waker ResponseStream::waker;
+
+bool ResponseStream::Write(const std::string_view data) {
+    std::lock_guard lk(_mtx);
+    if (_closed || _ended) {
+        return false;
+    }
+    _pending.append(data);
+    if (_pending.size() >= FLUSH_BYTES) {
+        wakeLocked();
+    }
+    return _pending.size() < HIGH_WATER;
+}
+
+bool ResponseStream::Event(std::string_view data, const std::string_view event,
+                           const std::string_view id) {
+    std::string msg;
+    msg.reserve(data.size() + event.size() + id.size() + 32);
+    if (!event.empty()) {
+        msg.append("event: ").append(event).append("\n");
+    }
+    if (!id.empty()) {
+        msg.append("id: ").append(id).append("\n");
+    }
+    // 每行一个 data: 字段，客户端收到后再用 \n 拼回去
+    while (true) {
+        const size_t eol = data.find('\n');
+        std::string_view line = data.substr(0, eol);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        msg.append("data: ").append(line).append("\n");
+        if (eol == std::string_view::npos) {
+            break;
+        }
+        data.remove_prefix(eol + 1);
+    }
+    msg.append("\n");
+    const bool ok = Write(msg);
+    Flush();
+    return ok;
+}
+
+bool ResponseStream::Comment(const std::string_view text) {
+    std::string msg(":");
+    msg.append(text).append("\n\n");
+    const bool ok = Write(msg);
+    Flush();
+    return ok;
+}
+
+void ResponseStream::Flush() {
+    std::lock_guard lk(_mtx);
+    if (!_pending.empty()) {
+        wakeLocked();
+    }
+}
+
+void ResponseStream::End() {
+    std::lock_guard lk(_mtx);
+    if (_closed || _ended) {
+        return;
+    }
+    _ended = true;
+    wakeLocked();
+}
+
+void ResponseStream::OnWritable(std::function<void(ResponseStream &)> fn) {
+    std::lock_guard lk(_mtx);
+    if (!_closed) {
+        _onWritable = std::move(fn);
+        ++_writableGen;
+    }
+}
+
+bool ResponseStream::Closed() const {
+    std::lock_guard lk(_mtx);
+    return _closed;
+}
+
+size_t ResponseStream::Buffered() const {
+    std::lock_guard lk(_mtx);
+    return _pending.size();
+}
+
+void ResponseStream::Attach(const int fd, const uint64_t connId) {
+    std::lock_guard lk(_mtx);
+    _fd = fd;
+    _connId = connId;
+    _attached = true;
+}
+
+bool ResponseStream::Take(std::string &out) {
+    std::unique_lock lk(_mtx);
+    if (_pending.empty() && !_ended && !_closed && _onWritable) {
+        // 回调返回后这里紧接着取走数据，期间的写入不必唤醒连接；
+        // 回调可能带状态（mutable lambda），移出来调用再放回，除非回调里换了（或清掉）
+        _wakePending = true;
+        auto fn = std::move(_onWritable);
+        _onWritable = nullptr;
+        const uint64_t gen = _writableGen;
+        lk.unlock();
+        fn(*this);
+        lk.lock();
+        if (gen == _writableGen && !_closed) {
+            _onWritable = std::move(fn);
+        }
+    }
+    out.swap(_pending);
+    _pending.clear();
+    _wakePending = false;
+    return _ended;
+}
+
+bool ResponseStream::Ready() const {
+    std::lock_guard lk(_mtx);
+    return !_pending.empty() || _ended || (_onWritable && !_closed);
+}
+
+void ResponseStream::Detach() {
+    std::function<void(ResponseStream &)> fn;
+    std::lock_guard lk(_mtx);
+    _closed = true;
+    _attached = false;
+    _pending.clear();
+    fn.swap(_onWritable); // 在锁外析构
+}
+
+void ResponseStream::wakeLocked() {
+    if (!_attached || _wakePending) {
+        return;
+    }
+    _wakePending = true;
+    if (waker) {
+        waker(_fd, _connId);
+    }
+}
+
+} // namespace zener::http
@@ -0,0 +1,494 @@
+#include "http/websocket.h"
+#include "http/conn.h"
+#include "utils/log/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace zener::http::ws {
+
+std::atomic<int> Hub::sessionCount{0};
+
+namespace {
+
+constexpr char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+uint32_t rotl(const uint32_t x, const int n) { return x << n | x >> (32 - n); }
+
+// 握手只需要对几十字节做一次 SHA-1，不值得为此引入加密库
+std::string sha1(std::string_view data) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+                     0xc3d2e1f0};
+    std::string msg(data);
+    const uint64_t bitLen = static_cast<uint64_t>(data.size()) * 8;
+    msg.push_back(static_cast<char>(0x80));
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    for (int i = 7; i >= 0; --i) {
+        msg.push_back(static_cast<char>(bitLen >> (i * 8)));
+    }
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto *p =
+                reinterpret_cast<const uint8_t *>(msg.data() + chunk + i * 4);
+            w[i] = static_cast<uint32_t>(p[0]) << 24 |
+                   static_cast<uint32_t>(p[1]) << 16 |
+                   static_cast<uint32_t>(p[2]) << 8 | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            const uint32_t tmp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = tmp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    std::string digest(20, '\0');
+    for (int i = 0; i < 20; ++i) {
+        digest[i] = static_cast<char>(h[i / 4] >> (24 - (i % 4) * 8));
+    }
+    return digest;
+}
+
+std::string base64(std::string_view data) {
+    static constexpr char TABLE[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        const uint32_t v = static_cast<uint8_t>(data[i]) << 16 |
+                           static_cast<uint8_t>(data[i + 1]) << 8 |
+                           static_cast<uint8_t>(data[i + 2]);
+        out.push_back(TABLE[v >> 18 & 63]);
+        out.push_back(TABLE[v >> 12 & 63]);
+        out.push_back(TABLE[v >> 6 & 63]);
+        out.push_back(TABLE[v & 63]);
+    }
+    if (const size_t rest = data.size() - i; rest > 0) {
+        uint32_t v = static_cast<uint8_t>(data[i]) << 16;
+        if (rest == 2) {
+            v |= static_cast<uint8_t>(data[i + 1]) << 8;
+        }
+        out.push_back(TABLE[v >> 18 & 63]);
+        out.push_back(TABLE[v >> 12 & 63]);
+        out.push_back(rest == 2 ? TABLE[v >> 6 & 63] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+bool validUtf8(std::string_view s) {
+    size_t i = 0;
+    while (i < s.size()) {
+        const auto c = static_cast<uint8_t>(s[i]);
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t n;
+        uint32_t cp;
+        if ((c & 0xe0) == 0xc0) {
+            n = 1;
+            cp = c & 0x1f;
+        } else if ((c & 0xf0) == 0xe0) {
+            n = 2;
+            cp = c & 0x0f;
+        } else if ((c & 0xf8) == 0xf0) {
+            n = 3;
+            cp = c & 0x07;
+        } else {
+            return false;
+        }
+        if (i + n >= s.size()) {
+            return false; // 多字节序列被截断
+        }
+        for (size_t j = 1; j <= n; ++j) {
+            const auto cc = static_cast<uint8_t>(s[i + j]);
+            if ((cc & 0xc0) != 0x80) {
+                return false;
+            }
+            cp = cp << 6 | (cc & 0x3f);
+        }
+        // 过长编码、代理区和超出 Unicode 范围的码点都不合法
+        if ((n == 1 && cp < 0x80) || (n == 2 && cp < 0x800) ||
+            (n == 3 && cp < 0x10000) || cp > 0x10ffff ||
+            (cp >= 0xd800 && cp <= 0xdfff)) {
+            return false;
+        }
+        i += n + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+Frame MakeFrame(const Opcode op, const std::string_view payload) {
+    auto frame = std::make_shared<std::string>();
+    const size_t len = payload.size();
+    frame->reserve(len + 10);
+    frame->push_back(static_cast<char>(0x80 | op)); // FIN
+    if (len < 126) {
+        frame->push_back(static_cast<char>(len));
+    } else if (len <= 0xffff) {
+        frame->push_back(126);
+        frame->push_back(static_cast<char>(len >> 8));
+        frame->push_back(static_cast<char>(len));
+    } else {
+        frame->push_back(127);
+        for (int i = 7; i >= 0; --i) {
+            frame->push_back(static_cast<char>(static_cast<uint64_t>(len) >>
+                                               (i * 8)));
+        }
+    }
+    frame->append(payload);
+    return frame;
+}
+
+std::string AcceptKey(const std::string_view key) {
+    std::string input(key);
+    input += GUID;
+    return base64(sha1(input));
+}
+
+void Unmask(char *data, const size_t len, const uint8_t mask[4],
+            const size_t offset) {
+    // 按 offset 旋转掩码，之后每个 4 字节对齐的位置都从 key[0] 开始
+    uint8_t key[4];
+    for (size_t i = 0; i < 4; ++i) {
+        key[i] = mask[(offset + i) & 3];
+    }
+    uint32_t key32;
+    std::memcpy(&key32, key, sizeof(key32));
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i key256 = _mm256_set1_epi32(static_cast<int>(key32));
+    for (; i + 32 <= len; i += 32) {
+        auto *p = reinterpret_cast<__m256i *>(data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), key256));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i key128 = _mm_set1_epi32(static_cast<int>(key32));
+    for (; i + 16 <= len; i += 16) {
+        auto *p = reinterpret_cast<__m128i *>(data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), key128));
+    }
+#endif
+    const uint64_t key64 = static_cast<uint64_t>(key32) << 32 | key32;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, data + i, sizeof(v));
+        v ^= key64;
+        std::memcpy(data + i, &v, sizeof(v));
+    }
+    for (; i < len; ++i) {
+        data[i] = static_cast<char>(data[i] ^ key[i & 3]);
+    }
+}
+
+Session::Session(const Handlers &handlers, std::string path,
+                 const int limiterSlot, std::shared_ptr<Outbox> outbox,
+                 Buffer &out)
+    : _handlers(handlers), _path(std::move(path)), _limiterSlot(limiterSlot),
+      _outbox(std::move(outbox)), _out(out) {
+    Hub::sessionCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+Session::~Session() {
+    // 连接异常断开（对端复位、超时）时 onClose 在关闭连接的线程中调用
+    notifyClose();
+    _outbox->Close();
+    for (const auto &topic : _topics) {
+        Hub::GetInstance().Leave(topic, _outbox.get());
+    }
+    Hub::sessionCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Session::Open() {
+    if (_handlers.onOpen) {
+        _handlers.onOpen(*this);
+    }
+}
+
+bool Session::Feed(Buffer &in) {
+    bool received = false;
+    while (!_closeSent && in.ReadableBytes() >= 2) {
+        const auto *p = reinterpret_cast<const uint8_t *>(in.Peek());
+        const size_t avail = in.ReadableBytes();
+        const bool fin = p[0] & 0x80;
+        const uint8_t opcode = p[0] & 0x0f;
+        uint64_t len = p[1] & 0x7f;
+        size_t header = 2;
+        if (len == 126) {
+            if (avail < 4) {
+                break;
+            }
+            len = static_cast<uint64_t>(p[2]) << 8 | p[3];
+            header = 4;
+        } else if (len == 127) {
+            if (avail < 10) {
+                break;
+            }
+            len = 0;
+            for (int i = 2; i < 10; ++i) {
+                len = len << 8 | p[i];
+            }
+            header = 10;
+        }
+        // 没有协商扩展，RSV 必须为 0；客户端帧必须带掩码
+        if ((p[0] & 0x70) || !(p[1] & 0x80)) {
+            Close(PROTOCOL_ERROR);
+            break;
+        }
+        if (len > MAX_MESSAGE) {
+            Close(TOO_BIG);
+            break;
+        }
+        if (avail < header + 4 + len) {
+            break; // 帧还没收全
+        }
+        char *payload = in.Peek() + header + 4;
+        Unmask(payload, len, p + header);
+        received = true;
+        const bool ok = onFrame(opcode, fin, payload, len);
+        in.Retrieve(header + 4 + len);
+        if (!ok) {
+            break;
+        }
+    }
+    if (received) {
+        _outbox->ClearProbed();
+    }
+    if (_closeSent) {
+        in.RetrieveAll();
+        _outbox->Drain([](Frame &) {});
+        return false;
+    }
+    _outbox->Drain([this](const Frame &frame) { _out.Append(*frame); });
+    return true;
+}
+
+bool Session::onFrame(const uint8_t opcode, const bool fin, char *payload,
+                      const size_t len) {
+    const std::string_view data(payload, len);
+    if (opcode & 0x8) { // 控制帧：不能分片，负载不超过 125 字节
+        if (!fin || len > 125) {
+            Close(PROTOCOL_ERROR);
+            return false;
+        }
+        switch (opcode) {
+        case PING:
+            _out.Append(*MakeFrame(PONG, data));
+            return true;
+        case PONG:
+            return true;
+        case CLOSE: {
+            if (len == 1) {
+                Close(PROTOCOL_ERROR);
+                return false;
+            }
+            // 回显对端的关闭码，随后关闭连接
+            const uint16_t code =
+                len >= 2 ? static_cast<uint16_t>(
+                               static_cast<uint8_t>(payload[0]) << 8 |
+                               static_cast<uint8_t>(payload[1]))
+                         : static_cast<uint16_t>(NORMAL);
+            Close(code);
+            return false;
+        }
+        default:
+            Close(PROTOCOL_ERROR);
+            return false;
+        }
+    }
+
+    if (opcode == CONTINUATION) {
+        if (_messageOp == 0) {
+            Close(PROTOCOL_ERROR);
+            return false;
+        }
+        _message.append(data);
+    } else if (opcode == TEXT || opcode == BINARY) {
+        if (_messageOp != 0) {
+            Close(PROTOCOL_ERROR); // 上一条分片消息还没结束
+            return false;
+        }
+        if (fin) {
+            // 未分片的消息直接在读缓冲区上回调，不拷贝
+            if (opcode == TEXT && !validUtf8(data)) {
+                Close(INVALID_DATA);
+                return false;
+            }
+            if (!admit()) {
+                return false;
+            }
+            if (_handlers.onMessage) {
+                _handlers.onMessage(*this, data, opcode == BINARY);
+            }
+            return !_closeSent;
+        }
+        _messageOp = opcode;
+        _message.assign(data);
+    } else {
+        Close(PROTOCOL_ERROR);
+        return false;
+    }
+
+    if (_message.size() > MAX_MESSAGE) {
+        Close(TOO_BIG);
+        return false;
+    }
+    if (!fin) {
+        return true;
+    }
+    const bool binary = _messageOp == BINARY;
+    _messageOp = 0;
+    if (!binary && !validUtf8(_message)) {
+        Close(INVALID_DATA);
+        return false;
+    }
+    if (!admit()) {
+        return false;
+    }
+    if (_handlers.onMessage) {
+        _handlers.onMessage(*this, _message, binary);
+    }
+    _message.clear();
+    return !_closeSent;
+}
+
+bool Session::admit() {
+    const int code = Conn::admit ? Conn::admit(_limiterSlot) : 0;
+    if (code == 0) {
+        return true;
+    }
+    LOG_D("conn {}: WebSocket message rejected ({}).", ConnId(), code);
+    Close(code == 503 ? TRY_AGAIN_LATER : POLICY_VIOLATION);
+    return false;
+}
+
+void Session::Send(const std::string_view message, const bool binary) {
+    if (_closeSent) {
+        return;
+    }
+    _out.Append(*MakeFrame(binary ? BINARY : TEXT, message));
+}
+
+void Session::Close(const uint16_t code, const std::string_view reason) {
+    if (_closeSent) {
+        return;
+    }
+    _closeSent = true;
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code));
+    payload.append(reason.substr(0, 123));
+    _out.Append(*MakeFrame(CLOSE, payload));
+    notifyClose();
+}
+
+void Session::Subscribe(const std::string &topic) {
+    if (std::find(_topics.begin(), _topics.end(), topic) != _topics.end()) {
+        return;
+    }
+    _topics.push_back(topic);
+    Hub::GetInstance().Join(topic, _outbox);
+}
+
+void Session::notifyClose() {
+    if (_closeNotified) {
+        return;
+    }
+    _closeNotified = true;
+    if (_handlers.onClose) {
+        _handlers.onClose(*this);
+    }
+}
+
+void Hub::Join(const std::string &topic, const std::shared_ptr<Outbox> &box) {
+    std::unique_lock lock(_mtx);
+    _topics[topic].push_back(box);
+}
+
+void Hub::Leave(const std::string &topic, const Outbox *box) {
+    std::unique_lock lock(_mtx);
+    const auto it = _topics.find(topic);
+    if (it == _topics.end()) {
+        return;
+    }
+    auto &boxes = it->second;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes[i].get() == box) {
+            boxes[i] = std::move(boxes.back());
+            boxes.pop_back();
+            break;
+        }
+    }
+    if (boxes.empty()) {
+        _topics.erase(it);
+    }
+}
+
+size_t Hub::Broadcast(const std::string &topic, const std::string_view message,
+                      const bool binary) {
+    return Broadcast(topic, MakeFrame(binary ? BINARY : TEXT, message));
+}
+
+size_t Hub::Broadcast(const std::string &topic, const Frame &frame) {
+    std::shared_lock lock(_mtx);
+    const auto it = _topics.find(topic);
+    if (it == _topics.end()) {
+        return 0;
+    }
+    for (const auto &box : it->second) {
+        Deliver(*box, frame);
+    }
+    return it->second.size();
+}
+
+void Hub::Deliver(Outbox &box, Frame frame) const {
+    // 发件箱由空变非空时才需要唤醒，之后的帧会被同一次派发一并取走
+    if (box.Push(std::move(frame)) && _waker) {
+        _waker(box.Fd(), box.ConnId());
+    }
+}
+
+size_t Hub::Subscribers(const std::string &topic) const {
+    std::shared_lock lock(_mtx);
+    const auto it = _topics.find(topic);
+    return it == _topics.end() ? 0 : it->second.size();
+}
+
+} // namespace zener::http::ws
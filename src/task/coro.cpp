@@ -0,0 +1,69 @@
+#include "task/coro.h"
+
+#include <cstdint>
+#include <new>
+
+namespace zener {
+
+namespace {
+
+constexpr size_t CLASSES = FramePool::MAX_POOLED / FramePool::GRANULE;
+
+struct FreeNode {
+    FreeNode *next;
+};
+
+// 线程退出时把缓存的帧还给全局分配器
+struct FrameCache {
+    FreeNode *heads[CLASSES]{};
+    uint32_t counts[CLASSES]{};
+
+    ~FrameCache() {
+        for (FreeNode *&head : heads) {
+            while (head) {
+                FreeNode *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+};
+
+thread_local FrameCache cache;
+
+size_t classOf(const size_t size) {
+    return (size + FramePool::GRANULE - 1) / FramePool::GRANULE - 1;
+}
+
+} // namespace
+
+void *FramePool::Allocate(const size_t size) {
+    if (size > MAX_POOLED) {
+        return ::operator new(size);
+    }
+    const size_t c = classOf(size);
+    if (FreeNode *node = cache.heads[c]) {
+        cache.heads[c] = node->next;
+        --cache.counts[c];
+        return node;
+    }
+    return ::operator new((c + 1) * GRANULE);
+}
+
+void FramePool::Deallocate(void *p, const size_t size) noexcept {
+    if (size > MAX_POOLED) {
+        ::operator delete(p);
+        return;
+    }
+    const size_t c = classOf(size);
+    if (cache.counts[c] >= MAX_CACHED) {
+        ::operator delete(p);
+        return;
+    }
+    auto *node = static_cast<FreeNode *>(p);
+    node->next = cache.heads[c];
+    cache.heads[c] = node;
+    ++cache.counts[c];
+}
+
+} // namespace zener
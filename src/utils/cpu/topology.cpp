@@ -0,0 +1,126 @@
+#include "utils/cpu/topology.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+
+namespace zener::cpu {
+
+namespace {
+
+bool parseInt(std::string_view text, int &value) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+                             text.back() == '\n')) {
+        text.remove_suffix(1);
+    }
+    const auto [ptr, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size() && value >= 0;
+}
+
+// 下标为 CPU 编号，值为节点编号；进程内只读一次
+struct Topology {
+    std::vector<int> nodeOfCpu;
+    int nodes{1};
+
+    Topology() {
+        for (int node = 0;; ++node) {
+            std::ifstream in("/sys/devices/system/node/node" +
+                             std::to_string(node) + "/cpulist");
+            if (!in) {
+                break;
+            }
+            std::string list;
+            std::getline(in, list);
+            for (const int cpu : ParseList(list)) {
+                if (static_cast<size_t>(cpu) >= nodeOfCpu.size()) {
+                    nodeOfCpu.resize(cpu + 1, 0);
+                }
+                nodeOfCpu[cpu] = node;
+            }
+            nodes = node + 1;
+        }
+    }
+};
+
+const Topology &topology() {
+    static const Topology topo;
+    return topo;
+}
+
+} // namespace
+
+std::vector<int> ParseList(std::string_view list) {
+    std::vector<int> cpus;
+    while (!list.empty()) {
+        const size_t comma = list.find(',');
+        const std::string_view part = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{}
+                                               : list.substr(comma + 1);
+        int first = 0;
+        int last = 0;
+        if (const size_t dash = part.find('-');
+            dash == std::string_view::npos) {
+            if (!parseInt(part, first)) {
+                continue;
+            }
+            last = first;
+        } else if (!parseInt(part.substr(0, dash), first) ||
+                   !parseInt(part.substr(dash + 1), last) || last < first) {
+            continue;
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::vector<int> Available() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+int NodeOf(const int cpu) {
+    const auto &topo = topology();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= topo.nodeOfCpu.size()) {
+        return 0;
+    }
+    return topo.nodeOfCpu[cpu];
+}
+
+int NodeCount() { return topology().nodes; }
+
+bool PinCurrentThread(const std::vector<int> &cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+} // namespace zener::cpu
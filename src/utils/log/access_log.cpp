@@ -0,0 +1,245 @@
+#include "utils/log/access_log.h"
+#include "utils/log/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace zener {
+
+namespace {
+
+// 线程退出时把缓冲区标记为 retired，后台线程读空后回收
+struct AccessQueueHolder {
+    std::shared_ptr<detail::LogThreadQueue> queue;
+    uint64_t generation{0};
+
+    ~AccessQueueHolder() {
+        if (queue) {
+            queue->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local AccessQueueHolder tAccessQueue;
+
+bool writeAll(const int fd, const char *data, size_t len) {
+    while (len > 0) {
+        const ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+bool AccessLog::Start(const std::string &logDir, const uint32_t sampleEvery,
+                      const size_t queueSize) {
+    if (_running.load(std::memory_order_acquire)) {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(logDir, ec);
+    if (ec) {
+        LOG_E("Failed to create access log directory {}: {}", logDir,
+              ec.message());
+        return false;
+    }
+    char date[16];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&now));
+    _fileName = (std::filesystem::path(logDir) /
+                 (std::string("access_") + date + ".bin"))
+                    .string();
+
+    _fd = open(_fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+               0644);
+    if (_fd < 0) {
+        LOG_E("Failed to open access log {}: {}", _fileName, strerror(errno));
+        return false;
+    }
+    // 新文件写入文件头，已有文件直接追加
+    struct stat st{};
+    if (fstat(_fd, &st) == 0 && st.st_size == 0) {
+        AccessLogFileHeader header{};
+        std::memcpy(header.magic, ACCESS_LOG_MAGIC, sizeof(header.magic));
+        header.version = ACCESS_LOG_VERSION;
+        header.recordSize = sizeof(AccessRecord);
+        if (!writeAll(_fd, reinterpret_cast<const char *>(&header),
+                      sizeof(header))) {
+            LOG_E("Failed to write access log header: {}", strerror(errno));
+            close(_fd);
+            _fd = -1;
+            return false;
+        }
+    }
+    _sampleEvery = std::max<uint32_t>(sampleEvery, 1);
+    _queueSize = queueSize > 0 ? queueSize : DEFAULT_ACCESS_LOG_QUEUE_SIZE;
+    _dropped.store(0, std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+    _running.store(true, std::memory_order_release);
+    _backend = std::thread([this] { backendLoop(); });
+    LOG_I("Access log: {}, sample 1/{}", _fileName, _sampleEvery);
+    return true;
+}
+
+void AccessLog::Stop() {
+    if (!_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    _wakeCond.notify_all();
+    if (_backend.joinable()) {
+        _backend.join();
+    }
+    drainOnce();
+    {
+        std::lock_guard lk(_registryMtx);
+        _queues.clear();
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+}
+
+bool AccessLog::sampled(const int status) const {
+    if (_sampleEvery <= 1 || status >= 400) {
+        return true;
+    }
+    static thread_local uint32_t counter = 0;
+    return ++counter % _sampleEvery == 0;
+}
+
+detail::LogThreadQueue *AccessLog::localQueue() {
+    const uint64_t generation = _generation.load(std::memory_order_acquire);
+    if (tAccessQueue.queue && tAccessQueue.generation == generation) {
+        return tAccessQueue.queue.get();
+    }
+    auto queue = std::make_shared<detail::LogThreadQueue>(_queueSize);
+    {
+        std::lock_guard lk(_registryMtx);
+        _queues.push_back(queue);
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    tAccessQueue.queue = std::move(queue);
+    tAccessQueue.generation = generation;
+    return tAccessQueue.queue.get();
+}
+
+void AccessLog::Record(const uint64_t connId, const std::string_view method,
+                       const std::string_view path, const int status,
+                       const size_t bytes,
+                       const std::chrono::steady_clock::time_point start) {
+    if (!_running.load(std::memory_order_relaxed) || !sampled(status)) {
+        return;
+    }
+    using namespace std::chrono;
+    const auto latency = duration_cast<nanoseconds>(steady_clock::now() - start);
+    const auto startNs =
+        duration_cast<nanoseconds>(system_clock::now().time_since_epoch()) -
+        latency;
+
+    const auto pathLen = static_cast<uint16_t>(
+        std::min<size_t>(path.size(), ACCESS_LOG_MAX_PATH));
+    constexpr size_t HEAD = sizeof(detail::RingRecordPrefix);
+    char *buf = localQueue()->ring.Reserve(HEAD + sizeof(AccessRecord) + pathLen);
+    if (!buf) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    AccessRecord record{};
+    record.timeNs = startNs.count();
+    record.connId = connId;
+    record.latencyUs = static_cast<uint32_t>(
+        std::min<int64_t>(duration_cast<microseconds>(latency).count(),
+                          UINT32_MAX));
+    record.bytes = static_cast<uint32_t>(std::min<size_t>(bytes, UINT32_MAX));
+    record.status = static_cast<uint16_t>(status);
+    record.pathLen = pathLen;
+    record.method = AccessMethodOf(method);
+    std::memcpy(buf + HEAD, &record, sizeof(record));
+    std::memcpy(buf + HEAD + sizeof(record), path.data(), pathLen);
+    tAccessQueue.queue->ring.Commit();
+}
+
+size_t AccessLog::drainOnce() {
+    static thread_local std::vector<std::shared_ptr<detail::LogThreadQueue>>
+        snapshot;
+    static thread_local uint64_t snapshotVersion = UINT64_MAX;
+    static thread_local std::vector<char> out;
+
+    if (const uint64_t version =
+            _registryVersion.load(std::memory_order_acquire);
+        version != snapshotVersion) {
+        std::lock_guard lk(_registryMtx);
+        std::erase_if(_queues, [](const auto &q) {
+            return q->retired.load(std::memory_order_acquire) &&
+                   q->ring.Head() == q->ring.Tail();
+        });
+        snapshot = _queues;
+        snapshotVersion = _registryVersion.load(std::memory_order_acquire);
+    }
+
+    size_t records = 0;
+    bool retiredEmpty = false;
+    out.clear();
+    for (const auto &queue : snapshot) {
+        auto &ring = queue->ring;
+        size_t head = ring.Head();
+        const size_t tail = ring.Tail();
+        if (head == tail) {
+            retiredEmpty |= queue->retired.load(std::memory_order_acquire);
+            continue;
+        }
+        while (head != tail) {
+            const auto *prefix =
+                reinterpret_cast<const detail::RingRecordPrefix *>(
+                    ring.At(head));
+            if (!prefix->padding) {
+                // 环形缓冲区内单条记录是连续的，去掉前缀后原样写出
+                const char *data = reinterpret_cast<const char *>(prefix + 1);
+                AccessRecord record;
+                std::memcpy(&record, data, sizeof(record));
+                out.insert(out.end(), data,
+                           data + sizeof(record) + record.pathLen);
+                ++records;
+            }
+            head += prefix->size;
+        }
+        ring.Release(head);
+    }
+    if (retiredEmpty) {
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    if (!out.empty() && _fd >= 0 && !writeAll(_fd, out.data(), out.size())) {
+        std::cerr << "Access log write failed: " << strerror(errno)
+                  << std::endl;
+    }
+    return records;
+}
+
+void AccessLog::backendLoop() {
+    while (_running.load(std::memory_order_acquire)) {
+        drainOnce();
+        std::unique_lock lk(_wakeMtx);
+        _wakeCond.wait_for(lk, std::chrono::milliseconds(100), [this] {
+            return !_running.load(std::memory_order_acquire);
+        });
+    }
+}
+
+} // namespace zener
@@ -0,0 +1,342 @@
+#include "utils/log/async_logger.h"
+#include "utils/log/use_spd_log.h"
+
+#include "spdlog/details/log_msg.h"
+#include "spdlog/details/os.h"
+#include "spdlog/pattern_formatter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace zener {
+
+namespace detail {
+
+static constexpr size_t alignRecord(const size_t len) {
+    return (len + 7) & ~static_cast<size_t>(7);
+}
+
+static size_t roundUpPow2(size_t n) {
+    size_t cap = 4096;
+    while (cap < n) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+LogRingBuffer::LogRingBuffer(const size_t capacity)
+    : _data(new char[roundUpPow2(capacity)]),
+      _mask(roundUpPow2(capacity) - 1) {}
+
+char *LogRingBuffer::Reserve(size_t len) {
+    len = alignRecord(len);
+    const size_t cap = Capacity();
+    if (len > cap / 2) { // 单条过大，直接拒绝
+        return nullptr;
+    }
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t head = _head.load(std::memory_order_acquire);
+    const size_t index = tail & _mask;
+    const size_t contiguous = cap - index;
+    // 尾部剩余空间放不下整条记录时，写一个填充记录回绕到开头
+    const size_t padding = contiguous < len ? contiguous : 0;
+    if (cap - (tail - head) < padding + len) {
+        return nullptr;
+    }
+    if (padding > 0) {
+        auto *pad = reinterpret_cast<RingRecordPrefix *>(_data.get() + index);
+        pad->size = static_cast<uint32_t>(padding);
+        pad->padding = 1;
+    }
+    char *buf = _data.get() + ((tail + padding) & _mask);
+    auto *prefix = reinterpret_cast<RingRecordPrefix *>(buf);
+    prefix->size = static_cast<uint32_t>(len);
+    prefix->padding = 0;
+    _pendingTail = tail + padding + len;
+    return buf;
+}
+
+void LogRingBuffer::Commit() {
+    _tail.store(_pendingTail, std::memory_order_release);
+}
+
+} // namespace detail
+
+namespace {
+
+// 线程退出时把缓冲区标记为 retired，后台线程读空后回收
+struct LocalQueueHolder {
+    std::shared_ptr<detail::LogThreadQueue> queue;
+    uint64_t generation{0};
+
+    ~LocalQueueHolder() {
+        if (queue) {
+            queue->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local LocalQueueHolder tLocalQueue;
+
+} // namespace
+
+bool AsyncLogger::Start(const std::string &filePath, const size_t queueSize,
+                        const AsyncOverflowPolicy policy) {
+    if (_running.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (filePath.empty()) {
+        _fd = STDOUT_FILENO;
+        _ownFd = false;
+    } else {
+        _fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                   0644);
+        if (_fd < 0) {
+            std::cerr << "Async logger failed to open " << filePath << ": "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        _ownFd = true;
+    }
+    _queueSize = queueSize > 0 ? queueSize : DEFAULT_ASYNC_QUEUE_SIZE;
+    _policy = policy;
+    _dropped.store(0, std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+    _running.store(true, std::memory_order_release);
+    _backend = std::thread([this] { backendLoop(); });
+    return true;
+}
+
+void AsyncLogger::Stop() {
+    if (!_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    _wakeCond.notify_all();
+    if (_backend.joinable()) {
+        _backend.join();
+    }
+    drainOnce(); // 后台线程退出后残留的日志
+    {
+        std::lock_guard lk(_registryMtx);
+        _queues.clear();
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    if (_ownFd && _fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+    _ownFd = false;
+}
+
+void AsyncLogger::Flush() {
+    if (!_running.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::unique_lock lk(_wakeMtx);
+    const uint64_t ticket = ++_flushRequested;
+    _wakeCond.notify_all();
+    _wakeCond.wait_for(lk, std::chrono::seconds(1), [this, ticket] {
+        return _flushDone >= ticket ||
+               !_running.load(std::memory_order_acquire);
+    });
+}
+
+detail::LogThreadQueue *AsyncLogger::localQueue() {
+    const uint64_t generation = _generation.load(std::memory_order_acquire);
+    if (tLocalQueue.queue && tLocalQueue.generation == generation) {
+        return tLocalQueue.queue.get();
+    }
+    auto queue = std::make_shared<detail::LogThreadQueue>(_queueSize);
+    {
+        std::lock_guard lk(_registryMtx);
+        _queues.push_back(queue);
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    tLocalQueue.queue = std::move(queue);
+    tLocalQueue.generation = generation;
+    return tLocalQueue.queue.get();
+}
+
+char *AsyncLogger::reserve(const size_t len) {
+    detail::LogThreadQueue *queue = localQueue();
+    while (true) {
+        if (char *buf = queue->ring.Reserve(len)) {
+            return buf;
+        }
+        if (_policy == AsyncOverflowPolicy::DROP ||
+            len > queue->ring.Capacity() / 2 ||
+            !_running.load(std::memory_order_acquire)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        _wakeCond.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+void AsyncLogger::commit() { tLocalQueue.queue->ring.Commit(); }
+
+size_t AsyncLogger::threadId() {
+    static thread_local const size_t tid = spdlog::details::os::thread_id();
+    return tid;
+}
+
+int64_t AsyncLogger::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+size_t AsyncLogger::drainOnce() {
+    static thread_local std::vector<std::shared_ptr<detail::LogThreadQueue>>
+        snapshot;
+    static thread_local uint64_t snapshotVersion = UINT64_MAX;
+    static thread_local std::vector<spdlog::memory_buf_t> batches;
+    static thread_local spdlog::pattern_formatter formatter(LOG_PATTERN);
+
+    if (const uint64_t version =
+            _registryVersion.load(std::memory_order_acquire);
+        version != snapshotVersion) {
+        std::lock_guard lk(_registryMtx);
+        // 回收已退出且读空的线程缓冲区
+        std::erase_if(_queues, [](const auto &q) {
+            return q->retired.load(std::memory_order_acquire) &&
+                   q->ring.Head() == q->ring.Tail();
+        });
+        snapshot = _queues;
+        snapshotVersion = _registryVersion.load(std::memory_order_acquire);
+    }
+    if (batches.size() < snapshot.size()) {
+        batches.resize(snapshot.size());
+    }
+
+    size_t records = 0;
+    size_t used = 0;
+    bool retiredEmpty = false;
+    spdlog::memory_buf_t payload;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        auto &ring = snapshot[i]->ring;
+        auto &out = batches[i];
+        out.clear();
+        size_t head = ring.Head();
+        const size_t tail = ring.Tail();
+        if (head == tail) {
+            retiredEmpty |=
+                snapshot[i]->retired.load(std::memory_order_acquire);
+            continue;
+        }
+        while (head != tail) {
+            const auto *hdr =
+                reinterpret_cast<const detail::LogRecordHeader *>(ring.At(head));
+            if (!hdr->prefix.padding) {
+                payload.clear();
+                try {
+                    hdr->format(reinterpret_cast<const char *>(hdr + 1),
+                                std::string_view(hdr->fmt, hdr->fmtLen),
+                                payload);
+                } catch (const std::exception &ex) {
+                    payload.clear();
+                    fmt::format_to(std::back_inserter(payload),
+                                   "[async log format error: {}] {}",
+                                   ex.what(),
+                                   std::string_view(hdr->fmt, hdr->fmtLen));
+                }
+                spdlog::details::log_msg msg(
+                    spdlog::log_clock::time_point(
+                        std::chrono::duration_cast<
+                            spdlog::log_clock::duration>(
+                            std::chrono::nanoseconds(hdr->timeNs))),
+                    hdr->loc, "main", hdr->level,
+                    spdlog::string_view_t(payload.data(), payload.size()));
+                msg.thread_id = hdr->threadId;
+                formatter.format(msg, out);
+                ++records;
+            }
+            head += hdr->prefix.size;
+        }
+        ring.Release(head);
+        if (out.size() > 0) {
+            ++used;
+        }
+    }
+    if (retiredEmpty) {
+        _registryVersion.fetch_add(1, std::memory_order_release);
+    }
+    if (used == 0 || _fd < 0) {
+        return records;
+    }
+
+    // 一次 writev 写出本轮所有线程的日志
+    std::vector<struct iovec> iov;
+    iov.reserve(used);
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        if (batches[i].size() > 0) {
+            iov.push_back({batches[i].data(), batches[i].size()});
+        }
+    }
+    size_t first = 0;
+    while (first < iov.size()) {
+        const int cnt =
+            static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+        const ssize_t n = writev(_fd, &iov[first], cnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        // 处理部分写
+        size_t left = static_cast<size_t>(n);
+        while (first < iov.size() && left >= iov[first].iov_len) {
+            left -= iov[first].iov_len;
+            ++first;
+        }
+        if (first < iov.size() && left > 0) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+    return records;
+}
+
+void AsyncLogger::backendLoop() {
+    uint64_t reportedDropped = 0;
+    while (_running.load(std::memory_order_acquire)) {
+        uint64_t flushTicket = 0;
+        {
+            std::lock_guard lk(_wakeMtx);
+            flushTicket = _flushRequested;
+        }
+        const size_t written = drainOnce();
+
+        if (const uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+            dropped != reportedDropped && _fd >= 0) {
+            const std::string note = fmt::format(
+                "[async logger] dropped {} messages (queue full)\n",
+                dropped - reportedDropped);
+            [[maybe_unused]] auto n = write(_fd, note.data(), note.size());
+            reportedDropped = dropped;
+        }
+
+        std::unique_lock lk(_wakeMtx);
+        if (flushTicket > _flushDone) {
+            _flushDone = flushTicket;
+            _wakeCond.notify_all();
+        }
+        if (written == 0 && _flushRequested == _flushDone) {
+            // 空闲时短暂休眠；写日志的线程不做通知，保持无锁
+            _wakeCond.wait_for(lk, std::chrono::milliseconds(5));
+        }
+    }
+    std::lock_guard lk(_wakeMtx);
+    _flushDone = _flushRequested;
+    _wakeCond.notify_all();
+}
+
+} // namespace zener
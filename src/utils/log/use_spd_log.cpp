@@ -4,7 +4,9 @@
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
 #include <filesystem>
 #include <iomanip>
@@ -18,6 +20,9 @@ namespace zener {
 Logger Logger::_instance{};
 static std::shared_ptr<spdlog::logger> sSpdLogger{};
 std::atomic<bool> Logger::_sInitialized{false};
+std::atomic<bool> Logger::_sAsync{false};
+std::array<std::atomic<int>, static_cast<size_t>(LogModule::COUNT)>
+    Logger::_sModuleLevels{}; // 默认全为 trace(0)，即不过滤
 std::string Logger::_logFileName{};
 std::string Logger::_logDirectory{};
 std::string Logger::_filePrefix{"zener"};
@@ -161,7 +166,102 @@ bool Logger::WriteToFile(const std::string_view logDir,
     }
 }
 
+bool Logger::StartAsync(const size_t queueSize,
+                        const AsyncOverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(sLoggerMutex);
+    if (_sAsync.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (!_sInitialized.load(std::memory_order_acquire) || !sSpdLogger) {
+        return false;
+    }
+    if (_usingRotation) {
+        sSpdLogger->warn("Async logging does not rotate files: {}",
+                         _logFileName);
+    }
+    sSpdLogger->flush();
+    if (!AsyncLogger::GetInstance().Start(_logFileName, queueSize, policy)) {
+        return false;
+    }
+    _sAsync.store(true, std::memory_order_release);
+    sSpdLogger->info("Async logging enabled: queue={}KB/thread, overflow={}",
+                     queueSize / 1024,
+                     policy == AsyncOverflowPolicy::DROP ? "drop" : "block");
+    return true;
+}
+
+void Logger::StopAsync() {
+    if (!_sAsync.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    AsyncLogger::GetInstance().Stop();
+}
+
+void Logger::SetLevel(const LogModule module,
+                      const spdlog::level::level_enum lvl) {
+    _sModuleLevels[static_cast<size_t>(module)].store(
+        static_cast<int>(lvl), std::memory_order_relaxed);
+}
+
+void Logger::SetLevel(const spdlog::level::level_enum lvl) {
+    for (auto &level : _sModuleLevels) {
+        level.store(static_cast<int>(lvl), std::memory_order_relaxed);
+    }
+}
+
+bool Logger::SetLevel(const std::string_view module,
+                      const std::string_view level) {
+    spdlog::level::level_enum lvl;
+    if (!ParseLevel(level, lvl)) {
+        return false;
+    }
+    static constexpr std::pair<std::string_view, LogModule> modules[] = {
+        {"core", LogModule::CORE},   {"http", LogModule::HTTP},
+        {"timer", LogModule::TIMER}, {"db", LogModule::DB},
+        {"other", LogModule::OTHER},
+    };
+    if (module == "all") {
+        SetLevel(lvl);
+        return true;
+    }
+    for (const auto &[name, value] : modules) {
+        if (name == module) {
+            SetLevel(value, lvl);
+            return true;
+        }
+    }
+    return false;
+}
+
+spdlog::level::level_enum Logger::GetLevel(const LogModule module) {
+    return static_cast<spdlog::level::level_enum>(
+        _sModuleLevels[static_cast<size_t>(module)].load(
+            std::memory_order_relaxed));
+}
+
+bool Logger::ParseLevel(const std::string_view name,
+                        spdlog::level::level_enum &lvl) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](const unsigned char c) { return std::tolower(c); });
+    // 兼容旧配置里的 DEBUG / RELEASE
+    if (lower == "release") {
+        lvl = spdlog::level::info;
+        return true;
+    }
+    if (lower == "error") {
+        lvl = spdlog::level::err;
+        return true;
+    }
+    // spdlog 对未知名字返回 off，这里单独区分
+    lvl = spdlog::level::from_str(lower);
+    return lvl != spdlog::level::off || lower == "off";
+}
+
 void Logger::Flush() {
+    if (_sAsync.load(std::memory_order_acquire)) {
+        AsyncLogger::GetInstance().Flush();
+    }
     std::lock_guard<std::mutex> lock(sLoggerMutex);
     if (sSpdLogger) {
         try {
@@ -173,9 +273,11 @@ void Logger::Flush() {
 }
 
 void Logger::Shutdown() {
+    // 先停异步后端，保证排队中的日志写出；Flush 自己加锁，不能在锁内调用
+    StopAsync();
+    Flush();
     std::lock_guard<std::mutex> lock(sLoggerMutex);
     try {
-        Flush();
         spdlog::shutdown();
         sSpdLogger.reset();
         _sInitialized.store(false, std::memory_order_release);
@@ -0,0 +1,258 @@
+#include "utils/metrics/metrics.h"
+
+#include <bit>
+#include <fmt/format.h>
+
+namespace zener::metrics {
+
+size_t ShardIndex() {
+    static std::atomic<size_t> next{0};
+    static thread_local const size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return index;
+}
+
+uint64_t Counter::Value() const {
+    uint64_t total = 0;
+    for (const auto &shard : _shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t Histogram::BucketOf(uint64_t us) {
+    if (us < SUB_BUCKETS) {
+        return us;
+    }
+    static const uint64_t maxValue = BucketUpper(BUCKETS - 1);
+    if (us > maxValue) {
+        us = maxValue;
+    }
+    // 组号 g >= 1，组内宽度 2^(g-1)
+    const auto group = static_cast<size_t>(std::bit_width(us)) - SUB_BITS;
+    return group * SUB_BUCKETS + ((us >> (group - 1)) - SUB_BUCKETS);
+}
+
+uint64_t Histogram::BucketUpper(const size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const size_t group = index / SUB_BUCKETS;
+    const uint64_t sub = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (group - 1)) - 1;
+}
+
+void Histogram::Record(const uint64_t us) {
+    auto &shard = _shards[ShardIndex()];
+    shard.buckets[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(us, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+    Snapshot snap;
+    for (const auto &shard : _shards) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snap.count += shard.count.load(std::memory_order_relaxed);
+        snap.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+uint64_t Histogram::Snapshot::Quantile(const double q) const {
+    uint64_t total = 0;
+    for (const auto n : buckets) {
+        total += n;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return BucketUpper(i);
+        }
+    }
+    return BucketUpper(BUCKETS - 1);
+}
+
+Registry::Entry *Registry::find(const std::string &name) {
+    for (const auto &entry : _entries) {
+        if (entry->name == name) {
+            return entry.get();
+        }
+    }
+    return nullptr;
+}
+
+Counter &Registry::NewCounter(const std::string &name,
+                              const std::string &help) {
+    std::lock_guard lk(_mtx);
+    if (const auto *entry = find(name); entry && entry->counter) {
+        return *entry->counter;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->kind = Kind::COUNTER;
+    entry->counter = std::make_unique<Counter>();
+    auto &counter = *entry->counter;
+    _entries.push_back(std::move(entry));
+    return counter;
+}
+
+Gauge &Registry::NewGauge(const std::string &name, const std::string &help) {
+    std::lock_guard lk(_mtx);
+    if (const auto *entry = find(name); entry && entry->gauge) {
+        return *entry->gauge;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->kind = Kind::GAUGE;
+    entry->gauge = std::make_unique<Gauge>();
+    auto &gauge = *entry->gauge;
+    _entries.push_back(std::move(entry));
+    return gauge;
+}
+
+Histogram &Registry::NewHistogram(const std::string &name,
+                                  const std::string &help) {
+    std::lock_guard lk(_mtx);
+    if (const auto *entry = find(name); entry && entry->histogram) {
+        return *entry->histogram;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->kind = Kind::HISTOGRAM;
+    entry->histogram = std::make_unique<Histogram>();
+    auto &histogram = *entry->histogram;
+    _entries.push_back(std::move(entry));
+    return histogram;
+}
+
+void Registry::NewCallbackGauge(const std::string &name,
+                                const std::string &help,
+                                std::function<double()> fn) {
+    std::lock_guard lk(_mtx);
+    if (auto *entry = find(name); entry && entry->kind == Kind::CALLBACK) {
+        entry->callback = std::move(fn);
+        return;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->kind = Kind::CALLBACK;
+    entry->callback = std::move(fn);
+    _entries.push_back(std::move(entry));
+}
+
+void Registry::RemoveCallbackGauge(const std::string &name) {
+    std::lock_guard lk(_mtx);
+    std::erase_if(_entries, [&name](const auto &entry) {
+        return entry->kind == Kind::CALLBACK && entry->name == name;
+    });
+}
+
+std::string Registry::Render() const {
+    std::lock_guard lk(_mtx);
+    fmt::memory_buffer out;
+    auto append = std::back_inserter(out);
+    for (const auto &entry : _entries) {
+        const char *type = entry->kind == Kind::COUNTER     ? "counter"
+                           : entry->kind == Kind::HISTOGRAM ? "histogram"
+                                                            : "gauge";
+        fmt::format_to(append, "# HELP {} {}\n# TYPE {} {}\n", entry->name,
+                       entry->help, entry->name, type);
+        switch (entry->kind) {
+        case Kind::COUNTER:
+            fmt::format_to(append, "{} {}\n", entry->name,
+                           entry->counter->Value());
+            break;
+        case Kind::GAUGE:
+            fmt::format_to(append, "{} {}\n", entry->name,
+                           entry->gauge->Value());
+            break;
+        case Kind::CALLBACK:
+            fmt::format_to(append, "{} {}\n", entry->name, entry->callback());
+            break;
+        case Kind::HISTOGRAM: {
+            // 单位为秒；只在每组末尾（2 的幂边界）输出累计桶
+            const auto snap = entry->histogram->Collect();
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+                cumulative += snap.buckets[i];
+                if ((i + 1) % Histogram::SUB_BUCKETS == 0) {
+                    fmt::format_to(
+                        append, "{}_bucket{{le=\"{}\"}} {}\n", entry->name,
+                        static_cast<double>(Histogram::BucketUpper(i) + 1) /
+                            1e6,
+                        cumulative);
+                }
+            }
+            fmt::format_to(append,
+                           "{0}_bucket{{le=\"+Inf\"}} {1}\n{0}_sum {2}\n"
+                           "{0}_count {1}\n",
+                           entry->name, snap.count,
+                           static_cast<double>(snap.sum) / 1e6);
+            break;
+        }
+        }
+    }
+    return fmt::to_string(out);
+}
+
+ServerMetrics &Server() {
+    static ServerMetrics metrics{
+        Registry::GetInstance().NewCounter("zener_accepted_connections_total",
+                                           "Accepted TCP connections."),
+        Registry::GetInstance().NewCounter(
+            "zener_accept_dropped_connections_total",
+            "Connections closed at accept (fd limit or server full)."),
+        Registry::GetInstance().NewCounter(
+            "zener_limit_rejected_connections_total",
+            "Connections reset at accept: per-IP connection limit reached."),
+        Registry::GetInstance().NewCounter(
+            "zener_limit_rejected_requests_total",
+            "Requests answered 429: per-IP request rate exceeded."),
+        Registry::GetInstance().NewCounter(
+            "zener_overload_shed_requests_total",
+            "Requests answered 503: server overloaded."),
+        Registry::GetInstance().NewCounter("zener_http_requests_total",
+                                           "HTTP requests processed."),
+        Registry::GetInstance().NewCounter("zener_bytes_received_total",
+                                           "Bytes read from client sockets."),
+        Registry::GetInstance().NewCounter("zener_bytes_sent_total",
+                                           "Bytes written to client sockets."),
+        Registry::GetInstance().NewCounter("zener_file_cache_hits_total",
+                                           "Static file mmap cache hits."),
+        Registry::GetInstance().NewCounter("zener_file_cache_misses_total",
+                                           "Static file mmap cache misses."),
+        Registry::GetInstance().NewCounter("zener_response_cache_hits_total",
+                                           "Route response cache hits."),
+        Registry::GetInstance().NewCounter(
+            "zener_response_cache_misses_total",
+            "Route response cache misses that ran the handler."),
+        Registry::GetInstance().NewCounter(
+            "zener_response_cache_coalesced_total",
+            "Requests that waited for a concurrent miss instead of running "
+            "the handler."),
+        Registry::GetInstance().NewHistogram(
+            "zener_http_parse_duration_seconds",
+            "Time spent parsing HTTP requests."),
+        Registry::GetInstance().NewHistogram(
+            "zener_http_handler_duration_seconds",
+            "Time spent in routing and request handlers."),
+        Registry::GetInstance().NewHistogram(
+            "zener_sql_pool_wait_seconds",
+            "Time spent waiting for a SQL connection."),
+    };
+    return metrics;
+}
+
+} // namespace zener::metrics